@@ -2,6 +2,7 @@
 
 #include "m_pd.h"
 #include "g_canvas.h"
+#include "s_libpd_inter.h"
 
 #define BLACK_ON    "#FF0000"
 #define BLACK_OFF   "#000000"
@@ -58,7 +59,8 @@ static void keyboard_note_on(t_keyboard* x, int note){
     int i = note - x->x_first_c;
     t_canvas *cv =  glist_getcanvas(x->x_glist);
     short key = note % 12, black = (key == 1 || key == 3 || key == 6 || key == 8 || key == 10);
-    sys_vgui(".x%lx.c itemconfigure %xrrk%d -fill %s\n", cv, x, i, black ? BLACK_ON : WHITE_ON);
+    if(!sys_headless())
+        sys_vgui(".x%lx.c itemconfigure %xrrk%d -fill %s\n", cv, x, i, black ? BLACK_ON : WHITE_ON);
     t_atom at[2];
     SETFLOAT(at, note);
     SETFLOAT(at+1, x->x_velocity);
@@ -69,7 +71,7 @@ static void keyboard_note_on(t_keyboard* x, int note){
 
 static void keyboard_note_off(t_keyboard* x, int note){
     int i = note - x->x_first_c;
-    if(x->x_tgl_notes[note] == 0){
+    if(x->x_tgl_notes[note] == 0 && !sys_headless()){
         t_canvas *cv =  glist_getcanvas(x->x_glist);
         short key = note % 12, c4 = (note == 60), black = (key == 1 || key == 3 || key == 6 || key == 8 || key == 10);
         sys_vgui(".x%lx.c itemconfigure %xrrk%d -fill %s\n", cv, x, i, black ? BLACK_OFF : c4 ? MIDDLE_C : WHITE_OFF);
@@ -146,10 +148,12 @@ static void keyboard_play_tgl(t_keyboard* x, int note){
     t_canvas *cv =  glist_getcanvas(x->x_glist);
     int on = x->x_tgl_notes[note] = x->x_tgl_notes[note] ? 0 : 1;
     short key = i % 12;
-    if(key == 1 || key == 3 || key == 6 || key == 8 || key == 10) // black
-        sys_vgui(".x%lx.c itemconfigure %xrrk%d -fill %s\n", cv, x, i, on ? BLACK_ON : BLACK_OFF);
-     else // white
-        sys_vgui(".x%lx.c itemconfigure %xrrk%d -fill %s\n", cv, x, i, on ? WHITE_ON : note == 60 ? MIDDLE_C : WHITE_OFF);
+    if(!sys_headless()){
+        if(key == 1 || key == 3 || key == 6 || key == 8 || key == 10) // black
+            sys_vgui(".x%lx.c itemconfigure %xrrk%d -fill %s\n", cv, x, i, on ? BLACK_ON : BLACK_OFF);
+        else // white
+            sys_vgui(".x%lx.c itemconfigure %xrrk%d -fill %s\n", cv, x, i, on ? WHITE_ON : note == 60 ? MIDDLE_C : WHITE_OFF);
+    }
     t_atom at[2];
     SETFLOAT(at, note);
     SETFLOAT(at+1, on ? x->x_velocity : 0);
@@ -356,7 +360,7 @@ void keyboard_float(t_keyboard *x, t_floatarg f){
     outlet_list(x->x_out, &s_list, 2, at);
     if(x->x_send != &s_ && x->x_send->s_thing)
         pd_list(x->x_send->s_thing, &s_list, 2, at);
-    if(x->x_glist->gl_havewindow){
+    if(x->x_glist->gl_havewindow && !sys_headless()){
         t_canvas *cv =  glist_getcanvas(x->x_glist);
         if(note >= x->x_first_c && note < x->x_first_c + (x->x_octaves * 12)){
             int i = note - x->x_first_c, key = i % 12;
@@ -381,7 +385,7 @@ static void keyboard_set(t_keyboard *x, t_floatarg f1, t_floatarg f2){
     int note = (int)f1;
     x->x_vel_in = f2 < 0 ? 0 : f2 > 127 ? 127 : (int)f2;
     int on = x->x_tgl_notes[note] = x->x_vel_in > 0;
-    if(x->x_glist->gl_havewindow){
+    if(x->x_glist->gl_havewindow && !sys_headless()){
         t_canvas *cv =  glist_getcanvas(x->x_glist);
         if(note >= x->x_first_c && note < x->x_first_c + (x->x_octaves * 12)){
             int i = note - x->x_first_c, key = i % 12;
@@ -512,7 +516,7 @@ static void keyboard_flush(t_keyboard* x){
     for(int note = 0; note < 256; note++){
         if(x->x_tgl_notes[note] > 0){
             int i = note - x->x_first_c;
-            if(i >= 0 && x->x_glist->gl_havewindow){
+            if(i >= 0 && x->x_glist->gl_havewindow && !sys_headless()){
                 short key = i % 12, c4 = (note == 60), black = (key == 1 || key == 3 || key == 6 || key == 8 || key == 10);
                 sys_vgui(".x%lx.c itemconfigure %xrrk%d -fill %s\n", cv, x, i, black ? BLACK_OFF : c4 ? MIDDLE_C : WHITE_OFF);
             }
@@ -2,6 +2,7 @@
 
 #include <m_pd.h>
 #include <g_canvas.h>
+#include "s_libpd_inter.h"
 #include <string.h>
 
 #ifdef _MSC_VER
@@ -272,6 +273,8 @@ static void messbox_append(t_messbox* x,  t_symbol *s, int ac, t_atom *av){
     s = NULL;
     char buf[40];
     size_t length;
+    if(sys_headless()) // the text only lives in the GUI
+        return;
     sys_vgui("%s configure -state normal\n", x->text_id);
     if(ac){
         int i;
@@ -312,6 +315,8 @@ static void messbox_set(t_messbox *x, t_symbol *s, int ac, t_atom *av){
     s = NULL;
     char buf[40];
     size_t length;
+    if(sys_headless()) // the text only lives in the GUI
+        return;
     sys_vgui("%s configure -state normal\n", x->text_id);
     sys_vgui("%s delete 0.0 end \n", x->text_id);
     if(ac){
@@ -5,6 +5,7 @@
  #include "s_utf8.h"
  #include "m_pd.h"
  #include "g_canvas.h"
+ #include "s_libpd_inter.h"
 
 #define COMMNENT_MINSIZE    8
 #define HANDLE_WIDTH        8
@@ -263,7 +264,7 @@ static void comment_erase(t_comment *x){
 }
 
 static void comment_redraw(t_comment *x){ // <= improve, not necessary for all cases
-     if(glist_isvisible(x->x_glist) && gobj_shouldvis((t_gobj *)x, x->x_glist)){
+     if(!sys_headless() && glist_isvisible(x->x_glist) && gobj_shouldvis((t_gobj *)x, x->x_glist)){
          comment_erase(x);
          comment_draw(x);
          comment_update(x); // ???????
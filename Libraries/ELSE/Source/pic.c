@@ -2,6 +2,7 @@
 
 #include <m_pd.h>
 #include <g_canvas.h>
+#include "s_libpd_inter.h"
 
 #ifdef _WIN32
 #include <io.h>
@@ -309,7 +310,7 @@ void pic_open(t_pic* x, t_symbol *filename){
                 x->x_fullname = gensym(file_name_open);
                 if(x->x_def_img)
                     x->x_def_img = 0;
-                if(glist_isvisible(x->x_glist) && gobj_shouldvis((t_gobj *)x, x->x_glist)){
+                if(!sys_headless() && glist_isvisible(x->x_glist) && gobj_shouldvis((t_gobj *)x, x->x_glist)){
                     pic_erase(x, x->x_glist);
                     sys_vgui("if {[info exists %lx_picname] == 0} {image create photo %lx_picname -file \"%s\"\n set %lx_picname 1\n}\n",
                         x->x_fullname, x->x_fullname, file_name_open, x->x_fullname);
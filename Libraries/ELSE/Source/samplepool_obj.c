@@ -0,0 +1,212 @@
+// named sample storage for [tabplayer~], [play~], [wave~], [buffir~], [poke~] and [record~]
+// 32-bit floats in one block, so half the memory of an [array] per channel on 64-bit builds
+
+#include "m_pd.h"
+#include "samplepool.h"
+#include <string.h>
+#include <stdio.h>
+
+static t_class *samplepool_class;
+
+typedef struct _samplepool_obj{
+    t_object      x_obj;
+    t_samplepool *x_pool;
+    int           x_interleaved;
+}t_samplepool_obj;
+
+static t_word *samplepool_getarray(t_samplepool_obj *x, t_symbol *name, int *npts, int complain){
+    t_garray *ap = (t_garray *)pd_findbyclass(name, garray_class);
+    t_word *vec;
+    if(!ap){
+        if(complain)
+            pd_error(x, "[samplepool]: no such array '%s'", name->s_name);
+        return(0);
+    }
+    if(!garray_getfloatwords(ap, npts, &vec)){
+        pd_error(x, "[samplepool]: bad template of array '%s'", name->s_name);
+        return(0);
+    }
+    return(vec);
+}
+
+static int samplepool_resize_obj(t_samplepool_obj *x, int nchans, int nframes){
+    if(!samplepool_resize(x->x_pool, nchans, nframes, x->x_interleaved)){
+        pd_error(x, "[samplepool]: out of memory for %d frames of %d channels", nframes, nchans);
+        return(0);
+    }
+    return(1);
+}
+
+// checks that frames [onset, onset + n) of channel ch fit, the pool isn't grown here:
+// growing it chunk by chunk would copy everything loaded so far for every chunk
+static int samplepool_fits(t_samplepool_obj *x, int ch, int onset, int n){
+    t_samplepool *p = x->x_pool;
+    if(ch >= p->p_nchans || onset > p->p_nframes - n){
+        pd_error(x, "[samplepool]: %d frames at %d don't fit in channel %d of %d frames and %d channels, set the 'size' first",
+            n, onset, ch, p->p_nframes, p->p_nchans);
+        return(0);
+    }
+    return(1);
+}
+
+static void samplepool_copyin(t_samplepool *p, int ch, int onset, t_word *vec, int n){
+    int stride, i;
+    float *fp = samplepool_channel(p, ch, &stride);
+    if(!fp)
+        return;
+    fp += (size_t)onset * stride;
+    for(i = 0; i < n; i++)
+        fp[(size_t)i * stride] = vec[i].w_float;
+}
+
+static void samplepool_size(t_samplepool_obj *x, t_floatarg f, t_floatarg chans){
+    t_samplepool *p = x->x_pool;
+    if(!p)
+        return;
+    samplepool_resize_obj(x, chans >= 1 ? (int)chans : (p->p_nchans ? p->p_nchans : 1), (int)f);
+}
+
+static void samplepool_interleave(t_samplepool_obj *x, t_floatarg f){
+    x->x_interleaved = (f != 0);
+    if(x->x_pool && x->x_pool->p_data)
+        samplepool_resize_obj(x, x->x_pool->p_nchans, x->x_pool->p_nframes);
+}
+
+static void samplepool_clear(t_samplepool_obj *x){
+    t_samplepool *p = x->x_pool;
+    if(p && p->p_data)
+        memset(p->p_data, 0, (size_t)p->p_nchans * p->p_nframes * sizeof(float));
+}
+
+// load <array> [channel onset]: copies one array into a channel (0-based) of a pool that
+// already has its size, to fill a large pool in chunks
+// load <array>: copies 'array' or '0-array', '1-array', ... into channels 0, 1, ...
+static void samplepool_load(t_samplepool_obj *x, t_symbol *s, int ac, t_atom *av){
+    t_samplepool *p = x->x_pool;
+    t_symbol *name = atom_getsymbolarg(0, ac, av);
+    t_word *vecs[SAMPLEPOOL_MAXCHANS];
+    int npts[SAMPLEPOOL_MAXCHANS];
+    int ch, nchans = 0, maxpts = 0;
+    if(!p || name == &s_)
+        return;
+    if(ac >= 2){
+        int onset = (int)atom_getfloatarg(2, ac, av);
+        ch = (int)atom_getfloatarg(1, ac, av);
+        if(ch < 0 || ch >= SAMPLEPOOL_MAXCHANS || onset < 0){
+            pd_error(x, "[samplepool]: channel or onset out of range");
+            return;
+        }
+        if(!(vecs[0] = samplepool_getarray(x, name, &npts[0], 1)))
+            return;
+        if(samplepool_fits(x, ch, onset, npts[0]))
+            samplepool_copyin(p, ch, onset, vecs[0], npts[0]);
+        return;
+    }
+    // look all channels up first, so the pool is resized once
+    if((vecs[0] = samplepool_getarray(x, name, &npts[0], 0)))
+        nchans = 1;
+    else for(ch = 0; ch < SAMPLEPOOL_MAXCHANS; ch++){
+        char buf[MAXPDSTRING];
+        snprintf(buf, MAXPDSTRING, "%d-%s", ch, name->s_name);
+        if(!(vecs[ch] = samplepool_getarray(x, gensym(buf), &npts[ch], 0)))
+            break;
+        nchans = ch + 1;
+    }
+    if(!nchans){
+        pd_error(x, "[samplepool]: no such array '%s' (or '0-%s')", name->s_name, name->s_name);
+        return;
+    }
+    for(ch = 0; ch < nchans; ch++)
+        if(npts[ch] > maxpts)
+            maxpts = npts[ch];
+    if(!samplepool_resize_obj(x, nchans, maxpts))
+        return;
+    samplepool_clear(x);
+    for(ch = 0; ch < nchans; ch++)
+        samplepool_copyin(p, ch, 0, vecs[ch], npts[ch]);
+}
+
+// store <array> [channel onset]: copies a channel into an array, as much as fits
+static void samplepool_store(t_samplepool_obj *x, t_symbol *name, t_floatarg chan, t_floatarg onset){
+    t_samplepool *p = x->x_pool;
+    t_garray *ap;
+    t_word *vec;
+    float *fp;
+    int n, stride, i, start = onset < 0 ? 0 : (int)onset;
+    if(!p)
+        return;
+    if(!(vec = samplepool_getarray(x, name, &n, 1)))
+        return;
+    if(!(fp = samplepool_channel(p, (int)chan, &stride))){
+        pd_error(x, "[samplepool]: no channel %d", (int)chan);
+        return;
+    }
+    fp += (size_t)start * stride;
+    for(i = 0; i < n; i++)
+        vec[i].w_float = start + i < p->p_nframes ? fp[(size_t)i * stride] : 0;
+    if((ap = (t_garray *)pd_findbyclass(name, garray_class)))
+        garray_redraw(ap);
+}
+
+static void samplepool_bang(t_samplepool_obj *x){
+    t_atom at[2];
+    SETFLOAT(at, x->x_pool ? x->x_pool->p_nframes : 0);
+    SETFLOAT(at + 1, x->x_pool ? x->x_pool->p_nchans : 0);
+    outlet_list(x->x_obj.ob_outlet, &s_list, 2, at);
+}
+
+static void samplepool_free(t_samplepool_obj *x){
+    if(x->x_pool)
+        samplepool_unget(x->x_pool);
+}
+
+static void *samplepool_new(t_symbol *s, int ac, t_atom *av){
+    t_samplepool_obj *x = (t_samplepool_obj *)pd_new(samplepool_class);
+    t_symbol *name = &s_;
+    int nframes = 0, nchans = 1, argn = 0;
+    x->x_interleaved = 0;
+    while(ac){
+        if(av->a_type == A_SYMBOL){
+            s = atom_getsymbolarg(0, ac, av);
+            if(s == gensym("-interleaved") && !argn)
+                x->x_interleaved = 1;
+            else if(!argn)
+                name = s, argn = 1;
+            else
+                goto errstate;
+        }
+        else{
+            if(argn == 1)
+                nframes = (int)atom_getfloatarg(0, ac, av);
+            else if(argn == 2)
+                nchans = (int)atom_getfloatarg(0, ac, av);
+            else
+                goto errstate;
+            argn++;
+        }
+        ac--, av++;
+    }
+    if(!(x->x_pool = samplepool_get(name)))
+        pd_error(x, "[samplepool]: no name given");
+        // the first object of a name sets its size
+    else if(!x->x_pool->p_data && nframes > 0)
+        samplepool_resize_obj(x, nchans, nframes);
+    outlet_new(&x->x_obj, &s_list);
+    return(x);
+errstate:
+    pd_error(x, "[samplepool]: improper args");
+    pd_free((t_pd *)x);
+    return(NULL);
+}
+
+void samplepool_setup(void){
+    samplepool_initclass();
+    samplepool_class = class_new(gensym("samplepool"), (t_newmethod)samplepool_new,
+        (t_method)samplepool_free, sizeof(t_samplepool_obj), 0, A_GIMME, 0);
+    class_addbang(samplepool_class, samplepool_bang);
+    class_addmethod(samplepool_class, (t_method)samplepool_size, gensym("size"), A_FLOAT, A_DEFFLOAT, 0);
+    class_addmethod(samplepool_class, (t_method)samplepool_interleave, gensym("interleave"), A_FLOAT, 0);
+    class_addmethod(samplepool_class, (t_method)samplepool_clear, gensym("clear"), 0);
+    class_addmethod(samplepool_class, (t_method)samplepool_load, gensym("load"), A_GIMME, 0);
+    class_addmethod(samplepool_class, (t_method)samplepool_store, gensym("store"), A_SYMBOL, A_DEFFLOAT, A_DEFFLOAT, 0);
+}
@@ -0,0 +1,669 @@
+// tabplayer~ for sound files that are streamed from disk instead of loaded in an array
+
+#include "m_pd.h"
+#include "magic.h"
+#include "sfstream.h"
+#include "sampleplay.h"
+#include <stdio.h>
+#include <math.h>
+
+#define HALF_PI (3.14159265358979323846 * 0.5)
+
+#define ONE_SIXTH 0.16666666666666666666667f
+#define SHARED_FLT_MAX  1E+36
+
+#define POLL_MS 10 // picks up an opened file while dsp is off
+
+typedef struct _sfplayer{
+    t_object    x_obj;
+    t_sfstream *x_stream;
+    t_glist    *x_glist;
+    t_symbol   *x_filename;         // last file asked for
+    int         x_usemap;
+    int         x_hasfeeders;       // if there's a signal coming in the main inlet
+    int         x_trig_mode;
+    float       x_lastin;
+    float       x_sr_khz;           // pd's sample rate
+    float       x_file_sr_khz;      // file's sample rate
+    int         x_fixed_sr;         // set with -sr or "sr", a new file doesn't change it
+    float       x_range_start;
+    float       x_range_end;
+    double      x_sr_ratio;         // sample rate ratio (file/pd)
+    unsigned long long x_npts;      // file size in frames
+    unsigned long long x_start;     // start position in samp
+    unsigned long long x_end;       // end pos in samp
+    unsigned long long x_rangesamp; // length of loop in samples
+    unsigned long long x_fadesamp;  // length of fade in samples
+    int         x_isneg;
+    int         x_first;
+    float       x_fadems;           // fade time (fade-in starts at stms, fade-out at endms in xfade mode)
+    double      x_rate;             // rate of playback
+    double      x_phase;
+    double      x_fade_point;
+    int         x_xfade;            // flag to set to xfade mode
+    int         x_fading_in;        // flag to see if we're fading
+    int         x_fading_out;       // flag to see if we're fading
+    int         x_position;         // phase/play position
+    int         x_loop;             // if loop or not
+    int         x_playing;          // if playing
+    int         x_playnew;          // if started playing this particular block
+    int         x_n_ch;
+    int         x_waiting;          // a file was asked for and not picked up yet
+    int         x_opened;           // to report from the clock
+    int         x_failed;
+    unsigned long x_underruns;      // samples that weren't loaded in time
+    unsigned long x_reported;
+    float      *x_frame;            // interpolated frame of all channels
+    float      *x_xframe;
+    t_float    *x_ivec;             // input vector
+    t_float   **x_ovecs;            // output vectors
+    t_sampleplay x_play;
+    t_clock    *x_clock;
+    t_clock    *x_pollclock;
+    t_outlet   *x_donelet;
+    t_outlet   *x_infolet;
+}t_sfplayer;
+
+static t_class *sfplayer_class;
+
+static void sfplayer_fade_check(t_sfplayer *x, t_floatarg f){
+    x->x_fadesamp  = (unsigned long long)(f * x->x_file_sr_khz);
+    if(x->x_fadesamp > (x->x_rangesamp / 2))
+        x->x_fadesamp = (x->x_rangesamp / 2);
+}
+
+static void sfplayer_fade(t_sfplayer *x, t_floatarg f){
+    x->x_fadems = f < 0 ? 0 : f;
+    sfplayer_fade_check(x, x->x_fadems);
+}
+
+static void sfplayer_xfade(t_sfplayer *x, t_floatarg f){
+    x->x_xfade = f != 0;
+}
+
+static void sfplayer_range_check(t_sfplayer *x){
+    if(x->x_start > x->x_end){
+        unsigned long long temp = x->x_start;
+        x->x_start = x->x_end;
+        x->x_end = temp;
+    }
+    x->x_rangesamp = x->x_end - x->x_start;
+    sfplayer_fade_check(x, x->x_fadems);
+}
+
+static void sfplayer_range(t_sfplayer *x, t_floatarg f1, t_floatarg f2){
+    x->x_range_start = f1 < 0 ? 0 : f1 > 1 ? 1 : f1;
+    x->x_range_end = f2 < 0 ? 0 : f2 > 1 ? 1 : f2;
+    x->x_start = (unsigned long long)(x->x_range_start * x->x_npts);
+    x->x_end = (unsigned long long)(x->x_range_end * x->x_npts);
+    sfplayer_range_check(x);
+}
+
+static unsigned long long sfplayer_ms2samp(t_sfplayer *x, t_floatarg f){
+    if(f <= 0)
+        return(0);
+    unsigned long long samp = (unsigned long long)(f * x->x_file_sr_khz);
+    return(samp > x->x_npts ? x->x_npts : samp);
+}
+
+static void sfplayer_start(t_sfplayer *x, t_floatarg f){
+    x->x_start = sfplayer_ms2samp(x, f);
+    sfplayer_range_check(x);
+}
+
+static void sfplayer_end(t_sfplayer *x, t_floatarg f){
+    x->x_end = sfplayer_ms2samp(x, f);
+    sfplayer_range_check(x);
+}
+
+static void sfplayer_reset(t_sfplayer *x){
+    x->x_start = 0;
+    x->x_end = x->x_rangesamp = x->x_npts;
+    sfplayer_fade_check(x, x->x_fadems);
+}
+
+static void sfplayer_speed(t_sfplayer *x, t_floatarg f){
+    x->x_rate = f / 100;
+    x->x_isneg = x->x_rate < 0;
+}
+
+static void sfplayer_filesr(t_sfplayer *x, t_floatarg f){
+    x->x_file_sr_khz = f * 0.001;
+    if(x->x_file_sr_khz < 8)
+        x->x_file_sr_khz = 8;
+    x->x_fixed_sr = 1;
+    x->x_sr_ratio = x->x_file_sr_khz/x->x_sr_khz;
+    sfplayer_fade_check(x, x->x_fadems);
+}
+
+// takes what the reader did, from the perform routine or the poll clock
+static void sfplayer_update(t_sfplayer *x){
+    int changed = sfstream_update(x->x_stream);
+    if(changed & SFSTREAM_OPENED){
+        const t_sfinfo *info = sfstream_info(x->x_stream);
+        x->x_npts = info->i_nframes;
+        if(!x->x_fixed_sr && info->i_sr > 0){
+            x->x_file_sr_khz = info->i_sr * 0.001;
+            x->x_sr_ratio = x->x_file_sr_khz/x->x_sr_khz;
+        }
+        sfplayer_range(x, x->x_range_start, x->x_range_end);
+        x->x_opened = 1;
+    }
+    if(changed & SFSTREAM_FAILED)
+        x->x_failed = 1;
+    if(changed){
+        x->x_waiting = 0;
+        clock_delay(x->x_clock, 0);
+    }
+}
+
+static void sfplayer_tick(t_sfplayer *x){
+    if(x->x_failed){
+        x->x_failed = 0;
+        pd_error(x, "[sfplayer~]: can't open '%s'", x->x_filename->s_name);
+    }
+    if(x->x_opened){
+        const t_sfinfo *info = sfstream_info(x->x_stream);
+        t_atom at[3];
+        x->x_opened = 0;
+        SETFLOAT(at, (t_float)info->i_nframes);
+        SETFLOAT(at+1, info->i_nchans);
+        SETFLOAT(at+2, info->i_sr);
+        outlet_anything(x->x_infolet, gensym("open"), 3, at);
+    }
+    if(x->x_underruns != x->x_reported){
+        t_atom at[1];
+        x->x_reported = x->x_underruns;
+        SETFLOAT(at, (t_float)x->x_underruns);
+        outlet_anything(x->x_infolet, gensym("underrun"), 1, at);
+    }
+}
+
+static void sfplayer_poll(t_sfplayer *x){
+    sfplayer_update(x);
+    if(x->x_waiting)
+        clock_delay(x->x_pollclock, POLL_MS);
+}
+
+static void sfplayer_open(t_sfplayer *x, t_symbol *s){
+    char dir[MAXPDSTRING], path[MAXPDSTRING], *name;
+    int fd = canvas_open(x->x_glist, s->s_name, "", dir, &name, MAXPDSTRING, 1);
+    x->x_filename = s;
+    if(fd < 0){
+        pd_error(x, "[sfplayer~]: can't find '%s'", s->s_name);
+        return;
+    }
+    sys_close(fd);
+    snprintf(path, MAXPDSTRING, "%s/%s", dir, name);
+    sfstream_open(x->x_stream, path, x->x_usemap);
+    x->x_waiting = 1;
+    clock_delay(x->x_pollclock, POLL_MS);
+}
+
+static void sfplayer_pos(t_sfplayer *x, t_floatarg f){
+    x->x_position = 1;
+    double position = f < 0 ? 0 : f > 1 ? 1 : (double)f;
+    x->x_phase = position * x->x_rangesamp + x->x_start;
+    x->x_playing = x->x_playnew = 1; // start playing
+}
+
+static void sfplayer_bang(t_sfplayer *x){
+    x->x_position = 0;
+    x->x_playing = x->x_playnew = 1; // start playing
+}
+
+static void sfplayer_play(t_sfplayer *x, t_symbol *s, int ac, t_atom *av){
+    s = NULL;
+    if(ac){ // args: start (ms) / end (ms), rate
+        float stms = 0;
+        float endms = SHARED_FLT_MAX;
+        int argnum = 0;
+        while(ac){
+            if(av->a_type == A_FLOAT){
+                switch(argnum){
+                    case 0:
+                        stms = atom_getfloatarg(0, ac, av);
+                        break;
+                    case 1:
+                        endms = atom_getfloatarg(0, ac, av);
+                        break;
+                    case 2:
+                        x->x_rate = (double)atom_getfloatarg(0, ac, av) * 0.01;
+                        x->x_isneg = (int)(x->x_rate < 0);
+                        break;
+                    default:
+                        break;
+                };
+                argnum++;
+            };
+            ac--, av++;
+        };
+        x->x_start = sfplayer_ms2samp(x, stms);
+        x->x_end = sfplayer_ms2samp(x, endms);
+        sfplayer_range_check(x);
+    }
+    sfplayer_bang(x);
+}
+
+static void sfplayer_stop(t_sfplayer *x){
+    if(x->x_playing){
+        x->x_playing = x->x_playnew = 0;
+        outlet_bang(x->x_donelet);
+    };
+}
+
+static void sfplayer_float(t_sfplayer *x, t_floatarg f){
+    f > 0 ? sfplayer_bang(x) : sfplayer_stop(x);
+}
+
+static void sfplayer_pause(t_sfplayer *x){
+    x->x_playing = 0;
+}
+
+static void sfplayer_resume(t_sfplayer *x){
+    x->x_playing = 1;
+}
+
+static void sfplayer_loop(t_sfplayer *x, t_floatarg f){
+    x->x_loop = f > 0 ? 1 : 0;
+}
+
+static void sfplayer_trigger(t_sfplayer *x, t_floatarg f){
+    x->x_trig_mode = f > 0 ? 1 : 0;
+}
+
+static double sfplayer_fade_gain(t_sfplayer *x, double phase){
+    double fadegain = 1;
+    x->x_fading_in = x->x_fading_out = 0;
+    if(x->x_isneg){
+        if(phase < (x->x_start + x->x_fadesamp)){ // fade in
+            x->x_fade_point = (phase - x->x_start) / x->x_fadesamp;
+            fadegain = sin(x->x_fade_point * HALF_PI);
+            x->x_fading_in = 1;
+        }
+        else if(phase > (x->x_end - x->x_fadesamp)){ // fade out
+            if(x->x_xfade && !x->x_first)
+                return(1);
+            else{
+                x->x_fade_point = (phase - (x->x_end - x->x_fadesamp)) / x->x_fadesamp;
+                fadegain = cos(x->x_fade_point * HALF_PI);
+                x->x_fading_out = 1;
+            }
+        }
+    }
+    else{
+        if(phase < (x->x_start + x->x_fadesamp)){ // fade in
+            if(x->x_xfade && !x->x_first)
+                return(1);
+            else{
+                x->x_fade_point = (phase - x->x_start) / x->x_fadesamp;
+                fadegain = sin(x->x_fade_point * HALF_PI);
+                x->x_fading_in = 1;
+            }
+        }
+        else if(phase > (x->x_end - x->x_fadesamp)){ // fade out
+            x->x_fade_point = (phase - (x->x_end - x->x_fadesamp)) / x->x_fadesamp;
+            fadegain = cos(x->x_fade_point * HALF_PI);
+            x->x_fading_out = 1;
+        }
+    }
+    return(fadegain);
+}
+
+    // resolves the bounds and fades of one sample and adds it to the playback plan
+static void sfplayer_step(t_sfplayer *x){
+    double phase = x->x_phase;
+    if(x->x_isneg){ // bounds checking backwards
+        if(phase < x->x_start){
+            if(x->x_loop){
+                double dif = (double)x->x_start - phase;
+                phase = (double)(x->x_end) - dif;
+                x->x_first = 0;
+                outlet_bang(x->x_donelet);
+            }
+            else{ // done playing
+                outlet_bang(x->x_donelet);
+                x->x_playing = 0;
+            };
+        }
+    }
+    else{ // bounds checking forwards
+        if(phase > x->x_end){
+            if(x->x_loop){
+                phase = (double)x->x_start + phase - (double)x->x_end;
+                x->x_first = 0;
+                outlet_bang(x->x_donelet);
+            }
+            else{ //we're done
+                outlet_bang(x->x_donelet);
+                x->x_playing = 0;
+            };
+        }
+    };
+    if(x->x_fadesamp > 0){
+        double gain = sfplayer_fade_gain(x, phase);
+        if(x->x_xfade && x->x_loop && x->x_isneg && x->x_fading_in){
+            double xphase = phase - (double)(x->x_start) + (double)(x->x_end);
+            sampleplay_add(&x->x_play, SAMPLEPLAY_XFADE, phase, gain, xphase, cos(x->x_fade_point * HALF_PI));
+        }
+        else if(x->x_xfade && x->x_loop && !x->x_isneg && x->x_fading_out){
+            double xphase = phase - (double)(x->x_end - x->x_fadesamp) + (double)(x->x_start - x->x_fadesamp);
+            sampleplay_add(&x->x_play, SAMPLEPLAY_XFADE, phase, gain, xphase, sin(x->x_fade_point * HALF_PI));
+        }
+        else
+            sampleplay_add(&x->x_play, gain == 1 ? SAMPLEPLAY_READ : SAMPLEPLAY_FADE, phase, gain, 0, 0);
+    }
+    else
+        sampleplay_add(&x->x_play, SAMPLEPLAY_READ, phase, 1, 0, 0);
+    x->x_phase = phase + x->x_sr_ratio*x->x_rate; // increment phase
+}
+
+static void sfplayer_startplaying(t_sfplayer *x){
+    if(x->x_playnew){
+        if(!x->x_position)
+            x->x_phase = x->x_isneg ? (double)x->x_end : (double)x->x_start;
+        else
+            x->x_position = 0;
+        x->x_playnew = 0;
+        x->x_first = 1;
+    };
+}
+
+// 4-point interpolation of all channels, 0 if a frame isn't loaded yet
+static int sfplayer_frame(t_sfplayer *x, double phase, float *out){
+    long long last = (long long)x->x_npts - 1, ndx;
+    const float *a, *b, *c, *d;
+    float frac;
+    int ch;
+    if(phase < 0 || phase > last)
+        phase = phase < 0 ? 0 : last;
+    ndx = (long long)phase;
+    frac = phase - ndx;
+    a = sfstream_frame(x->x_stream, ndx > 0 ? ndx - 1 : 0);
+    b = sfstream_frame(x->x_stream, ndx);
+    c = sfstream_frame(x->x_stream, ndx + 1 < last ? ndx + 1 : last);
+    d = sfstream_frame(x->x_stream, ndx + 2 < last ? ndx + 2 : last);
+    if(!a || !b || !c || !d)
+        return(0);
+    for(ch = 0; ch < x->x_n_ch; ch++){
+        float cmb = c[ch] - b[ch];
+        out[ch] = b[ch] + frac * (cmb - ONE_SIXTH * (1. - frac) * ((d[ch] - a[ch] - 3.0f * cmb) * frac
+            + (d[ch] + 2.0f * a[ch] - 3.0f * b[ch])));
+    }
+    return(1);
+}
+
+// reads the plan, a sample whose frames aren't loaded yet is silent and counts as an underrun
+static void sfplayer_read(t_sfplayer *x, int n){
+    t_sampleplay *p = &x->x_play;
+    unsigned long missed = 0;
+    int r, i, ch;
+    for(r = 0; r < p->s_nruns; r++){
+        int kind = p->s_runkind[r];
+        int end = r + 1 < p->s_nruns ? p->s_runstart[r + 1] : p->s_n;
+        for(i = p->s_runstart[r]; i < end; i++){
+            int ok = kind != SAMPLEPLAY_SILENT && sfplayer_frame(x, p->s_phase[i], x->x_frame);
+            if(ok && kind == SAMPLEPLAY_XFADE)
+                ok = sfplayer_frame(x, p->s_xphase[i], x->x_xframe);
+            if(!ok){
+                missed += (kind != SAMPLEPLAY_SILENT);
+                for(ch = 0; ch < x->x_n_ch; ch++)
+                    x->x_ovecs[ch][i] = 0;
+            }
+            else if(kind == SAMPLEPLAY_READ){
+                for(ch = 0; ch < x->x_n_ch; ch++)
+                    x->x_ovecs[ch][i] = x->x_frame[ch];
+            }
+            else if(kind == SAMPLEPLAY_FADE){
+                for(ch = 0; ch < x->x_n_ch; ch++)
+                    x->x_ovecs[ch][i] = x->x_frame[ch] * p->s_gain[i];
+            }
+            else{
+                for(ch = 0; ch < x->x_n_ch; ch++)
+                    x->x_ovecs[ch][i] = x->x_frame[ch] * p->s_gain[i] + x->x_xframe[ch] * p->s_xgain[i];
+            }
+        }
+    }
+    for(ch = 0; ch < x->x_n_ch; ch++) // stopped in the middle of the block
+        for(i = p->s_n; i < n; i++)
+            x->x_ovecs[ch][i] = 0;
+    if(missed){
+        x->x_underruns += missed;
+        clock_delay(x->x_clock, 0);
+    }
+}
+
+// asks for the chunk at the play position and the ones it runs into next,
+// wrapping around the loop, or for the start while idle so a bang plays right away
+static void sfplayer_schedule(t_sfplayer *x){
+    long long frames[SFSTREAM_LOOKAHEAD + 2];
+    int n = 0, k;
+    double step = x->x_isneg ? -SFSTREAM_CHUNK : SFSTREAM_CHUNK;
+    double phase = x->x_phase;
+    if(!x->x_playing){
+        frames[n++] = x->x_isneg ? (long long)x->x_end - 1 : (long long)x->x_start;
+        sfstream_schedule(x->x_stream, frames, n);
+        return;
+    }
+    frames[n++] = (long long)phase;
+    for(k = 0; k < SFSTREAM_LOOKAHEAD; k++){
+        phase += step;
+        if(phase > x->x_end || phase < x->x_start){
+            if(!x->x_loop || !x->x_rangesamp)
+                break;
+            phase += x->x_isneg ? (double)x->x_rangesamp : -(double)x->x_rangesamp;
+        }
+        frames[n++] = (long long)phase;
+    }
+    if(x->x_xfade && x->x_loop && x->x_fadesamp) // where the crossfade reads from
+        frames[n++] = x->x_isneg ? (long long)x->x_end - 1 : (long long)(x->x_start - x->x_fadesamp);
+    sfstream_schedule(x->x_stream, frames, n);
+}
+
+static t_int *sfplayer_perform(t_int *w){
+    t_sfplayer *x = (t_sfplayer *)(w[1]);
+    int n = (int)(w[2]);
+    int ch, i;
+    t_float *xin = x->x_ivec;
+    float last_sig_input = x->x_lastin;
+    if(x->x_waiting)
+        sfplayer_update(x);
+    if(sfstream_info(x->x_stream) && x->x_npts && x->x_play.s_maxn >= n){
+        // transport first, then the reads for all channels at once
+        sampleplay_begin(&x->x_play);
+        if(x->x_hasfeeders){ // signal input present
+            for(i = 0; i < n; i++){
+                float sig_input = *xin++;
+                if(sig_input != 0 && last_sig_input == 0){
+                    // bang
+                    x->x_position = 0;
+                    x->x_playing = x->x_playnew = 1; // start playing
+                }
+                else if(!x->x_trig_mode && sig_input == 0 && last_sig_input != 0){
+                    if(x->x_playing){
+                        x->x_playing = x->x_playnew = 0;
+                        outlet_bang(x->x_donelet);
+                    };
+                }
+                if(!x->x_playing) // not playing, out zeros
+                    sampleplay_add(&x->x_play, SAMPLEPLAY_SILENT, 0, 0, 0, 0);
+                else{ // PLAYING
+                    sfplayer_startplaying(x);
+                    sfplayer_step(x);
+                }
+                last_sig_input = sig_input;
+            };
+        }
+        else{ // no signal input present, auto playback mode
+            last_sig_input = 0;
+            if(x->x_playing){
+                sfplayer_startplaying(x);
+                for(i = 0; i < n && x->x_playing; i++)
+                    sfplayer_step(x);
+            }
+        };
+        sfplayer_read(x, n);
+        sfplayer_schedule(x);
+    }
+    else{
+        for(ch = 0; ch < x->x_n_ch; ch++){
+            t_float *output = *(x->x_ovecs+ch);
+            int nblock = n;
+            while(nblock--)
+                *output++ = 0;
+        };
+    };
+    x->x_lastin = last_sig_input;
+    return(w+3);
+}
+
+static void sfplayer_dsp(t_sfplayer *x, t_signal **sp){
+    x->x_hasfeeders = magic_inlet_connection((t_object *)x, x->x_glist, 0, &s_signal);
+    t_float pdksr = sp[0]->s_sr * 0.001;
+    if(x->x_sr_khz != pdksr)
+        x->x_sr_ratio = (double)(x->x_file_sr_khz/(x->x_sr_khz = pdksr));
+    if(!sampleplay_setup(&x->x_play, sp[0]->s_n))
+        pd_error(x, "[sfplayer~]: out of memory");
+    t_signal **sigp = sp;
+    x->x_ivec = (*sigp++)->s_vec;
+    for(int i = 0; i < x->x_n_ch; i++) //input vectors first
+        *(x->x_ovecs+i) = (*sigp++)->s_vec;
+    dsp_add(sfplayer_perform, 2, x, sp[0]->s_n);
+}
+
+static void *sfplayer_free(t_sfplayer *x){
+    sfstream_free(x->x_stream);
+    sampleplay_free(&x->x_play);
+    clock_free(x->x_clock);
+    clock_free(x->x_pollclock);
+    freebytes(x->x_ovecs, x->x_n_ch * sizeof(*x->x_ovecs));
+    freebytes(x->x_frame, x->x_n_ch * sizeof(*x->x_frame));
+    freebytes(x->x_xframe, x->x_n_ch * sizeof(*x->x_xframe));
+    return(void *)x;
+}
+
+static void *sfplayer_new(t_symbol * s, int ac, t_atom *av){
+    t_sfplayer *x = (t_sfplayer *)pd_new(sfplayer_class);
+    sampleplay_init(&x->x_play, ONE_SIXTH, 1);
+    t_symbol *filename = NULL;
+    t_float channels = 1;
+    t_float fade = 0;
+    t_float range_start = 0;
+    t_float range_end = 1;
+    x->x_xfade = 0;
+    x->x_lastin = 0;
+    x->x_sr_khz = (float)sys_getsr() * 0.001;
+    x->x_file_sr_khz = x->x_sr_khz; // pd's sample rate until a file is open
+    x->x_loop = 0;
+    x->x_rate = 1.f;
+    x->x_trig_mode = 0;
+    int nameset = 0;
+    int argn = 0;
+    while(ac){
+        if(av->a_type == A_SYMBOL){ // if name not passed so far, count arg as file name
+            s = atom_getsymbolarg(0, ac, av);
+            if(s == gensym("-loop") && !argn){
+                x->x_loop = 1;
+                ac--, av++;
+            }
+            else if(s == gensym("-xfade") && !argn){
+                x->x_xfade = 1;
+                ac--, av++;
+            }
+            else if(s == gensym("-tr") && !argn){
+                x->x_trig_mode = 1;
+                ac--, av++;
+            }
+            else if(s == gensym("-mmap") && !argn){
+                x->x_usemap = 1;
+                ac--, av++;
+            }
+            else if(s == gensym("-fade") && ac >= 2  && !argn){
+                fade = atom_getfloatarg(1, ac, av);
+                ac-=2, av+=2;
+            }
+            else if(s == gensym("-sr") && ac >= 2 && !argn){
+                x->x_file_sr_khz = atom_getfloatarg(1, ac, av) * 0.001;
+                if(x->x_file_sr_khz < 8)
+                    x->x_file_sr_khz = 8;
+                x->x_fixed_sr = 1;
+                ac-=2, av+=2;
+            }
+            else if(s == gensym("-speed") && ac >= 2 && !argn){
+                x->x_rate = (double)atom_getfloatarg(1, ac, av) * 0.01;
+                ac-=2, av+=2;
+            }
+            else if(s == gensym("-range") && ac >= 3 && !argn){
+                range_start = atom_getfloatarg(1, ac, av);
+                range_end = atom_getfloatarg(2, ac, av);
+                ac-=3, av+=3;
+            }
+            else if(!nameset){
+                filename = s;
+                ac--, av++;
+                nameset = 1;
+                argn = 1;
+            }
+            else
+                goto errstate;
+        }
+        else{ // float
+            channels = atom_getfloatarg(0, ac, av);
+            argn = 1;
+            ac--, av++;
+        }
+    };
+    x->x_sr_ratio = x->x_file_sr_khz/x->x_sr_khz;
+    x->x_isneg = (int)(x->x_rate < 0);
+    int ch = (int)channels < 1 ? 1 : (int)channels > SFSTREAM_MAXCHANS ? SFSTREAM_MAXCHANS : (int)channels;
+    x->x_glist = canvas_getcurrent();
+    x->x_hasfeeders = 0;
+    x->x_n_ch = ch;
+    x->x_stream = sfstream_new(ch);
+    x->x_ovecs = getbytes(x->x_n_ch * sizeof(*x->x_ovecs));
+    x->x_frame = getbytes(x->x_n_ch * sizeof(*x->x_frame));
+    x->x_xframe = getbytes(x->x_n_ch * sizeof(*x->x_xframe));
+    x->x_clock = clock_new(x, (t_method)sfplayer_tick);
+    x->x_pollclock = clock_new(x, (t_method)sfplayer_poll);
+    while(ch--)
+        outlet_new((t_object *)x, &s_signal);
+    x->x_donelet = outlet_new(&x->x_obj, &s_bang);
+    x->x_infolet = outlet_new(&x->x_obj, &s_anything);
+    x->x_playing = 0;
+    x->x_playnew = 0;
+    x->x_range_start = range_start;
+    x->x_range_end = range_end;
+    sfplayer_fade(x, fade);
+    if(filename)
+        sfplayer_open(x, filename);
+    return(x);
+    errstate:
+        pd_error(x, "[sfplayer~]: improper args");
+        return(NULL);
+}
+
+void sfplayer_tilde_setup(void){
+    sfplayer_class = class_new(gensym("sfplayer~"), (t_newmethod)sfplayer_new, (t_method)sfplayer_free,
+        sizeof(t_sfplayer), 0, A_GIMME, 0);
+    class_domainsignalin(sfplayer_class, -1);
+    class_addbang(sfplayer_class, sfplayer_bang);
+    class_addfloat(sfplayer_class, sfplayer_float);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_dsp, gensym("dsp"), A_CANT, 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_open, gensym("open"), A_SYMBOL, 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_open, gensym("set"), A_SYMBOL, 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_pos, gensym("pos"), A_FLOAT, 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_play, gensym("play"), A_GIMME, 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_stop, gensym("stop"), 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_pause, gensym("pause"), 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_resume, gensym("resume"), 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_reset, gensym("reset"), 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_start, gensym("start"), A_FLOAT, 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_end, gensym("end"), A_FLOAT, 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_range, gensym("range"), A_FLOAT, A_FLOAT, 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_speed, gensym("speed"), A_FLOAT, 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_loop, gensym("loop"), A_FLOAT, 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_trigger, gensym("tr"), A_FLOAT, 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_fade, gensym("fade"), A_FLOAT, 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_xfade, gensym("xfade"), A_FLOAT, 0);
+    class_addmethod(sfplayer_class, (t_method)sfplayer_filesr, gensym("sr"), A_FLOAT, 0);
+}
@@ -3,6 +3,7 @@
 #include "m_pd.h"
 #include "math.h"
 #include "magic.h"
+#include "blosc.h"
 
 
 static t_class *square_class;
@@ -10,166 +11,48 @@ static t_class *square_class;
 typedef struct _square
 {
     t_object x_obj;
-    double  x_phase;
-    double  x_last_phase_offset;
+    t_blosc  x_osc;
     t_float  x_freq;
     t_inlet  *x_inlet_width;
     t_inlet  *x_inlet_phase;
     t_inlet  *x_inlet_sync;
     t_outlet *x_outlet;
-    t_float x_sr;
 // MAGIC:
     t_glist *x_glist; // object list
     t_float *x_signalscalar; // right inlet's float field
     int x_hasfeeders; // right inlet connection flag
-    t_float  x_phase_sync_float; // float from magic
 } t_square;
 
 
 static t_int *square_perform_magic(t_int *w)
 {
     t_square *x = (t_square *)(w[1]);
-    int nblock = (t_int)(w[2]);
-    t_float *in1 = (t_float *)(w[3]); // freq
-    t_float *in2 = (t_float *)(w[4]); // width
-    t_float *in4 = (t_float *)(w[6]); // phase
-    t_float *out = (t_float *)(w[7]);
 // Magic Start
     t_float *scalar = x->x_signalscalar;
     if (!magic_isnan(*x->x_signalscalar)){
         t_float input_phase = fmod(*scalar, 1);
         if (input_phase < 0)
             input_phase += 1;
-        x->x_phase = input_phase;
+        blosc_phase(&x->x_osc, input_phase);
         magic_setnan(x->x_signalscalar);
     }
 // Magic End
-    double phase = x->x_phase;
-    double last_phase_offset = x->x_last_phase_offset;
-    double sr = x->x_sr;
-    double output;
-    while (nblock--){
-        double hz = *in1++;
-        double width = *in2++;
-        width = width > 1. ? 1. : width < 0. ? 0. : width; // clipped
-        double phase_offset = *in4++;
-        double phase_step = hz / sr; // phase_step
-        phase_step = phase_step > 0.5 ? 0.5 : phase_step < -0.5 ? -0.5 : phase_step; // clipped to nyq
-        double phase_dev = phase_offset - last_phase_offset;
-        if (phase_dev >= 1 || phase_dev <= -1)
-            phase_dev = fmod(phase_dev, 1); // fmod(phase_dev)
-        if (hz >= 0){
-            phase = phase + phase_dev;
-            if (phase <= 0)
-                phase = phase + 1.; // wrap deviated phase
-            if (phase >= 1){
-                output = 1; // 1st sample is always 1
-                phase = phase - 1; // wrapped phase
-            }
-            else if (phase + phase_step >= 1)
-                output = -1; // last sample is always -1
-            else
-                output = phase <= width ? 1 : -1;
-        }
-        else{
-            phase = phase + phase_dev;
-            if (phase >= 1)
-                phase = phase - 1.; // wrap deviated phase
-            if (phase <= 0){
-                output = -1; // 1st sample is always 0
-                phase = phase + 1; // wrapped phase
-            }
-            else if (phase + phase_step <= 0)
-                output = 1; // last sample is always 1
-            else
-                output = phase <= width ? 1 : -1;
-        }
-        *out++ = output;
-        phase += phase_step; // next phase
-        last_phase_offset = phase_offset; // last phase offset
-    }
-    x->x_phase = phase;
-    x->x_last_phase_offset = last_phase_offset;
+    blosc_perform(&x->x_osc, (int)(w[2]), (t_float *)(w[3]), (t_float *)(w[4]), 0,
+        (t_float *)(w[6]), (t_float *)(w[7]));
     return (w + 8);
 }
 
 static t_int *square_perform(t_int *w)
 {
     t_square *x = (t_square *)(w[1]);
-    int nblock = (t_int)(w[2]);
-    t_float *in1 = (t_float *)(w[3]); // freq
-    t_float *in2 = (t_float *)(w[4]); // width
-    t_float *in3 = (t_float *)(w[5]); // sync
-    t_float *in4 = (t_float *)(w[6]); // phase
-    t_float *out = (t_float *)(w[7]);
-    double phase = x->x_phase;
-    double last_phase_offset = x->x_last_phase_offset;
-    double sr = x->x_sr;
-    double output;
-    while (nblock--)
-    {
-        double hz = *in1++;
-        double width = *in2++;
-        width = width > 1. ? 1. : width < 0. ? 0. : width; // clipped
-        double trig = *in3++;
-        double phase_offset = *in4++;
-        double phase_step = hz / sr; // phase_step
-        phase_step = phase_step > 0.5 ? 0.5 : phase_step < -0.5 ? -0.5 : phase_step; // clipped to nyq
-        double phase_dev = phase_offset - last_phase_offset;
-        if (phase_dev >= 1 || phase_dev <= -1)
-            phase_dev = fmod(phase_dev, 1); // fmod(phase_dev)
-        if (hz >= 0)
-            {
-                if (trig > 0 && trig <= 1) phase = trig;
-                else
-                    {
-                        phase = phase + phase_dev;
-                        if (phase <= 0)
-                            phase = phase + 1.; // wrap deviated phase
-                    }
-                    if (phase >= 1)
-                        {
-                        output = 1; // 1st sample is always 1
-                        phase = phase - 1; // wrapped phase
-                        }
-                    else if (phase + phase_step >= 1)
-                        output = -1; // last sample is always -1
-                    else
-                        output = phase <= width ? 1 : -1;
-            }
-        else
-            {
-                if (trig > 0 && trig < 1) phase = trig;
-                else if (trig == 1)
-                    phase = 0;
-                else
-                {
-                    phase = phase + phase_dev;
-                    if (phase >= 1)
-                        phase = phase - 1.; // wrap deviated phase
-                }
-                    if (phase <= 0)
-                        {
-                        output = -1; // 1st sample is always -1
-                        phase = phase + 1; // wrapped phase
-                        }
-                    else if (phase + phase_step <= 0)
-                        output = 1; // last sample is always 1
-                    else
-                        output = phase <= width ? 1 : -1;
-            }
-        *out++ = output;
-        phase = phase + phase_step; // next phase
-        last_phase_offset = phase_offset; // last phase offset
-    }
-    x->x_phase = phase;
-    x->x_last_phase_offset = last_phase_offset;
+    blosc_perform(&x->x_osc, (int)(w[2]), (t_float *)(w[3]), (t_float *)(w[4]),
+        (t_float *)(w[5]), (t_float *)(w[6]), (t_float *)(w[7]));
     return (w + 8);
 }
 
 static void square_dsp(t_square *x, t_signal **sp){
     x->x_hasfeeders = magic_inlet_connection((t_object *)x, x->x_glist, 2, &s_signal); // magic feeder flag
-    x->x_sr = sp[0]->s_sr;
+    x->x_osc.o_sr = sp[0]->s_sr;
     if (x->x_hasfeeders){
         dsp_add(square_perform, 7, x, sp[0]->s_n,
                 sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, sp[3]->s_vec, sp[4]->s_vec);
@@ -180,6 +63,10 @@ static void square_dsp(t_square *x, t_signal **sp){
     }
 }
 
+static void square_detune(t_square *x, t_floatarg f){
+    blosc_detune(&x->x_osc, f);
+}
+
 static void *square_free(t_square *x)
 {
     inlet_free(x->x_inlet_width);
@@ -193,6 +80,8 @@ static void *square_new(t_symbol *s, int ac, t_atom *av)
 {
     s = NULL;
     t_square *x = (t_square *)pd_new(square_class);
+    if(!blosc_flags(&x->x_osc, BLOSC_SQUARE, &ac, &av))
+        goto errstate;
     t_float f1 = 0, f2 = 0.5, f3 = 0;
     if (ac && av->a_type == A_FLOAT)
     {
@@ -212,13 +101,11 @@ static void *square_new(t_symbol *s, int ac, t_atom *av)
     t_float init_phase = f3;
     init_phase = init_phase < 0 ? 0 : init_phase >= 1 ? 0 : init_phase; // clipping phase input
     if (init_phase == 0 && init_freq > 0)
-        x->x_phase = 1.;
+        blosc_phase(&x->x_osc, 1.);
     else
-         x->x_phase = init_phase;
+         blosc_phase(&x->x_osc, init_phase);
     
-    x->x_last_phase_offset = 0;
     x->x_freq = init_freq;
-    x->x_sr = sys_getsr(); // sample rate
 
     x->x_inlet_width = inlet_new((t_object *)x, (t_pd *)x, &s_signal, &s_signal);
     pd_float((t_pd *)x->x_inlet_width, init_width);
@@ -234,6 +121,9 @@ static void *square_new(t_symbol *s, int ac, t_atom *av)
     x->x_glist = canvas_getcurrent();
     x->x_signalscalar = obj_findsignalscalar((t_object *)x, 2);
     return (x);
+errstate:
+    pd_error(x, "[square~]: improper args");
+    return(NULL);
 }
 
 void square_tilde_setup(void)
@@ -243,4 +133,5 @@ void square_tilde_setup(void)
         sizeof(t_square), CLASS_DEFAULT, A_GIMME, 0);
     CLASS_MAINSIGNALIN(square_class, t_square, x_freq);
     class_addmethod(square_class, (t_method)square_dsp, gensym("dsp"), A_CANT, 0);
+    class_addmethod(square_class, (t_method)square_detune, gensym("detune"), A_FLOAT, 0);
 }
@@ -3,6 +3,7 @@
 #include "m_pd.h"
 #include "magic.h"
 #include "buffer.h"
+#include "sampleplay.h"
 #include <stdlib.h>
 #include <math.h>
 
@@ -46,6 +47,7 @@ typedef struct _tabplayer{
     int         x_n_ch;
     t_float    *x_ivec;             // input vector
     t_float   **x_ovecs;            // output vectors
+    t_sampleplay x_play;
     t_outlet   *x_donelet;
 }t_play;
 
@@ -241,35 +243,63 @@ static double tabplayer_fade_gain(t_play *x, double phase){
     return(fadegain);
 }
 
-static double tabplayer_interp(t_play *x, int ch, double phase){
-    double out = 0.;
-    t_word **vectable = x->x_buffer->c_vectors; // ??
-    t_word *vp = vectable[ch]; // ??
-    if(vp){
-        float f,  a,  b,  c,  d, cmb;
-        int maxindex = x->x_npts - 3;
-        if(phase < 0 || phase > maxindex)
-            phase = 0;  // CHECKED: a value 0, not ndx 0 (???)
-        int ndx = (int)phase;
-        if(ndx < 1){
-            ndx = 1;
-            f = 0;
+    // resolves the bounds and fades of one sample and adds it to the playback plan
+static void tabplayer_step(t_play *x){
+    double phase = x->x_phase;
+    if(x->x_isneg){ // bounds checking backwards
+        if(phase < x->x_start){
+            if(x->x_loop){
+                double dif = (double)x->x_start - phase;
+                phase = (double)(x->x_end) - dif;
+                x->x_first = 0;
+                outlet_bang(x->x_donelet);
+            }
+            else{ // done playing
+                outlet_bang(x->x_donelet);
+                x->x_playing = 0;
+            };
+        }
+    }
+    else{ // bounds checking forwards
+        if(phase > x->x_end){
+            if(x->x_loop){
+                phase = (double)x->x_start + phase - (double)x->x_end;
+                x->x_first = 0;
+                outlet_bang(x->x_donelet);
+            }
+            else{ //we're done
+                outlet_bang(x->x_donelet);
+                x->x_playing = 0;
+            };
+        }
+    };
+    if(x->x_fadesamp > 0){
+        double gain = tabplayer_fade_gain(x, phase);
+        if(x->x_xfade && x->x_loop && x->x_isneg && x->x_fading_in){
+            double xphase = phase - (double)(x->x_start) + (double)(x->x_end);
+            sampleplay_add(&x->x_play, SAMPLEPLAY_XFADE, phase, gain, xphase, cos(x->x_fade_point * HALF_PI));
         }
-        else if(ndx > maxindex){
-            ndx = maxindex;
-            f = 1;
+        else if(x->x_xfade && x->x_loop && !x->x_isneg && x->x_fading_out){
+            double xphase = phase - (double)(x->x_end - x->x_fadesamp) + (double)(x->x_start - x->x_fadesamp);
+            sampleplay_add(&x->x_play, SAMPLEPLAY_XFADE, phase, gain, xphase, sin(x->x_fade_point * HALF_PI));
         }
         else
-            f = phase - ndx;
-        vp += ndx;
-        a = vp[-1].w_float;
-        b = vp[0].w_float;
-        c = vp[1].w_float;
-        d = vp[2].w_float;
-        cmb = c-b;
-        out = b + f*(cmb - ONE_SIXTH*(1.-f)*((d - a - 3.0f*cmb)*f + (d + 2.0f*a - 3.0f*b)));
+            sampleplay_add(&x->x_play, gain == 1 ? SAMPLEPLAY_READ : SAMPLEPLAY_FADE, phase, gain, 0, 0);
     }
-    return(out);
+    else
+        sampleplay_add(&x->x_play, SAMPLEPLAY_READ, phase, 1, 0, 0);
+    x->x_phase = phase + x->x_sr_ratio*x->x_rate; // increment phase
+}
+
+static void tabplayer_startplaying(t_play *x){
+    if(x->x_playnew){
+        if(!x->x_position)
+            x->x_phase = x->x_isneg ? (double)x->x_end : (double)x->x_start;
+        else
+            x->x_position = 0;
+        x->x_playnew = 0;
+        x->x_first = 1;
+    };
 }
 
 static t_int *tabplayer_perform(t_int *w){
@@ -279,83 +309,29 @@ static t_int *tabplayer_perform(t_int *w){
     int ch, i;
     t_float *xin = x->x_ivec;
     float last_sig_input = x->x_lastin;
-    if(buffer->c_playable){
+    if(buffer->c_playable && x->x_play.s_maxn >= n){
+        // transport first, then the reads for all channels at once
+        sampleplay_begin(&x->x_play);
         if(x->x_hasfeeders){ // signal input present
             for(i = 0; i < n; i++){
                 float sig_input = *xin++;
-                for(ch = 0; ch < x->x_n_ch; ch++){
-                    t_float *output = *(x->x_ovecs+ch);
-                    if(sig_input != 0 && last_sig_input == 0){
-                        // bang
-                        x->x_position = 0;
-                        x->x_playing = x->x_playnew = 1; // start playing
-                    }
-                    else if(!x->x_trig_mode && sig_input == 0 && last_sig_input != 0){
-                        if(x->x_playing){
-                            x->x_playing = x->x_playnew = 0;
-                            outlet_bang(x->x_donelet);
-                        };
-                    }
-                    if(!x->x_playing) // not playing, out zeros
-                        output[i] = 0;
-                    else{ // PLAYING
-                        if(x->x_playnew){
-                            if(!x->x_position)
-                                x->x_phase = x->x_isneg ? (double)x->x_end : (double)x->x_start;
-                            else
-                                x->x_position = 0;
-                            x->x_playnew = 0;
-                                x->x_first = 1;
-                        };
-                        double phase = x->x_phase;
-                        if(x->x_isneg){ // bounds checking backwards
-                            if(phase < x->x_start){
-                                if(x->x_loop){
-                                    double dif = (double)x->x_start - phase;
-                                    phase = (double)(x->x_end) - dif;
-                                    x->x_first = 0;
-                                    outlet_bang(x->x_donelet);
-                                }
-                                else{ // done playing
-                                    outlet_bang(x->x_donelet);
-                                    x->x_playing = 0;
-                                };
-                            }
-                        }
-                        else{ // bounds checking forwards
-                            if(phase > x->x_end){
-                                if(x->x_loop){
-                                    phase = (double)x->x_start + phase - (double)x->x_end;
-                                    x->x_first = 0;
-                                    outlet_bang(x->x_donelet);
-                                }
-                                else{ //we're done
-                                    outlet_bang(x->x_donelet);
-                                    x->x_playing = 0;
-                                };
-                            }
-                        };
-                        output[i] = tabplayer_interp(x, ch, phase);
-                        if(x->x_fadesamp > 0){
-                            output[i] *= tabplayer_fade_gain(x, phase);
-                            if(x->x_xfade && x->x_loop){
-                                if(x->x_isneg){
-                                    if(x->x_fading_in){
-                                        double xphase = phase - (double)(x->x_start) + (double)(x->x_end);
-                                        output[i] += (tabplayer_interp(x, ch, xphase) * cos(x->x_fade_point * HALF_PI));
-                                    }
-                                }
-                                else{
-                                    if(x->x_fading_out){
-                                        double xphase = phase - (double)(x->x_end - x->x_fadesamp) + (double)(x->x_start - x->x_fadesamp);
-                                        output[i] += (tabplayer_interp(x, ch, xphase) * sin(x->x_fade_point * HALF_PI));
-                                    }
-                                }
-                            }
-                        }
-                        x->x_phase = phase + x->x_sr_ratio*x->x_rate; // increment phase
-                    }
-                };
+                if(sig_input != 0 && last_sig_input == 0){
+                    // bang
+                    x->x_position = 0;
+                    x->x_playing = x->x_playnew = 1; // start playing
+                }
+                else if(!x->x_trig_mode && sig_input == 0 && last_sig_input != 0){
+                    if(x->x_playing){
+                        x->x_playing = x->x_playnew = 0;
+                        outlet_bang(x->x_donelet);
+                    };
+                }
+                if(!x->x_playing) // not playing, out zeros
+                    sampleplay_add(&x->x_play, SAMPLEPLAY_SILENT, 0, 0, 0, 0);
+                else{ // PLAYING
+                    tabplayer_startplaying(x);
+                    tabplayer_step(x);
+                }
                 last_sig_input = sig_input;
             };
         }
@@ -363,69 +339,11 @@ static t_int *tabplayer_perform(t_int *w){
             last_sig_input = 0;
             if(!x->x_playing) // not playing, out zeros
                 goto nullstate;
-            else{ // PLAYING
-                if(x->x_playnew){
-                    if(!x->x_position)
-                        x->x_phase = x->x_isneg ? (double)x->x_end : (double)x->x_start;
-                    else
-                        x->x_position = 0;
-                    x->x_playnew = 0;
-                    x->x_first = 1;
-                };
-                for(i = 0; i < n; i++){
-                    double phase = x->x_phase;
-                    if(x->x_isneg){ // bounds checking backwards
-                        if(phase < x->x_start){
-                            if(x->x_loop){
-                                double dif = (double)x->x_start - phase;
-                                phase = (double)(x->x_end) - dif;
-                                x->x_first = 0;
-                                outlet_bang(x->x_donelet);
-                            }
-                            else{ // done playing
-                                outlet_bang(x->x_donelet);
-                                x->x_playing = 0;
-                            };
-                        }
-                    }
-                    else{ // bounds checking forwards
-                        if(phase > x->x_end){
-                            if(x->x_loop){
-                                phase = (double)x->x_start + phase - (double)x->x_end;
-                                x->x_first = 0;
-                                outlet_bang(x->x_donelet);
-                            }
-                            else{ //we're done
-                                outlet_bang(x->x_donelet);
-                                x->x_playing = 0;
-                            };
-                        }
-                    };
-                    for(ch = 0; ch < x->x_n_ch; ch++){ // get output
-                        t_float *output = *(x->x_ovecs+ch);
-                        output[i] = tabplayer_interp(x, ch, phase);
-                        if(x->x_fadesamp > 0){
-                            output[i] *= tabplayer_fade_gain(x, phase);
-                            if(x->x_xfade && x->x_loop){
-                                if(x->x_isneg){
-                                    if(x->x_fading_in){
-                                        double xphase = phase - (double)(x->x_start) + (double)(x->x_end);
-                                        output[i] += (tabplayer_interp(x, ch, xphase) * cos(x->x_fade_point * HALF_PI));
-                                    }
-                                }
-                                else{
-                                    if(x->x_fading_out){
-                                        double xphase = phase - (double)(x->x_end - x->x_fadesamp) + (double)(x->x_start - x->x_fadesamp);
-                                        output[i] += (tabplayer_interp(x, ch, xphase) * sin(x->x_fade_point * HALF_PI));
-                                    }
-                                }
-                            }
-                        }
-                    };
-                    x->x_phase = phase + x->x_sr_ratio*x->x_rate; // increment phase
-                };
-            }
+            tabplayer_startplaying(x);
+            for(i = 0; i < n; i++)
+                tabplayer_step(x);
         };
+        sampleplay_perform(&x->x_play, buffer->c_vectors, buffer->c_fvectors, buffer->c_stride, (int)x->x_npts, x->x_ovecs, x->x_n_ch);
     }
     else{
         nullstate:
@@ -451,6 +369,8 @@ static void tabplayer_dsp(t_play *x, t_signal **sp){
         x->x_npts = npts;
         tabplayer_reset(x); // recalculate sample equivalents
     };
+    if(!sampleplay_setup(&x->x_play, sp[0]->s_n))
+        pd_error(x, "[tabplayer~]: out of memory");
     t_signal **sigp = sp;
     x->x_ivec = (*sigp++)->s_vec;
     for(int i = 0; i < x->x_n_ch; i++) //input vectors first
@@ -460,6 +380,7 @@ static void tabplayer_dsp(t_play *x, t_signal **sp){
 
 static void *tabplayer_free(t_play *x){
     buffer_free(x->x_buffer);
+    sampleplay_free(&x->x_play);
     freebytes(x->x_ovecs, x->x_n_ch * sizeof(*x->x_ovecs));
     outlet_free(x->x_donelet);
     return(void *)x;
@@ -467,6 +388,7 @@ static void *tabplayer_free(t_play *x){
 
 static void *tabplayer_new(t_symbol * s, int ac, t_atom *av){
     t_play *x = (t_play *)pd_new(tabplayer_class);
+    sampleplay_init(&x->x_play, ONE_SIXTH, 1);
     t_symbol *arrname = NULL;
     t_float channels = 1;
     t_float fade = 0;
@@ -539,6 +461,7 @@ static void *tabplayer_new(t_symbol * s, int ac, t_atom *av){
     x->x_buffer = buffer_init((t_class *)x, arrname, chn_n, 0);
     if(x->x_buffer){
         int ch = x->x_buffer->c_numchans;
+        buffer_usepool(x->x_buffer);
         x->x_npts = x->x_buffer->c_npts;
         x->x_n_ch = ch;
         x->x_ovecs = getbytes(x->x_n_ch * sizeof(*x->x_ovecs));
@@ -0,0 +1,418 @@
+// oscillator core shared by saw~, square~, tri~ and vsaw~, see blosc.h
+
+#include "m_pd.h"
+#include <math.h>
+#include "blosc.h"
+
+#define BLOSC_SPREAD 0.381966011250105 // golden section, keeps unison phases apart
+
+void blosc_init(t_blosc *o, int shape, int nvoices, double phase){
+    int v;
+    o->o_shape = shape;
+    o->o_bl = 0;
+    o->o_nvoices = nvoices < 1 ? 1 : nvoices > BLOSC_MAXVOICES ? BLOSC_MAXVOICES : nvoices;
+    o->o_sr = sys_getsr();
+    o->o_last_offset = 0;
+    o->o_width = -1; // no gain yet
+    o->o_gain = 0;
+    for(v = 0; v < o->o_nvoices; v++){
+        o->o_ratio[v] = 1;
+        o->o_spread[v] = fmod(v * BLOSC_SPREAD, 1);
+    }
+    blosc_phase(o, phase);
+}
+
+int blosc_flags(t_blosc *o, int shape, int *ac, t_atom **av){
+    int bl = 0, nvoices = 1;
+    t_float detune = 0;
+    while(*ac && (*av)->a_type == A_SYMBOL){
+        t_symbol *sym = atom_getsymbol(*av);
+        if(sym == gensym("-bl")){
+            bl = 1;
+            (*ac)--, (*av)++;
+        }
+        else if(sym == gensym("-unison") && *ac >= 2 && (*av)[1].a_type == A_FLOAT){
+            nvoices = atom_getint(*av + 1);
+            *ac -= 2, *av += 2;
+        }
+        else if(sym == gensym("-detune") && *ac >= 2 && (*av)[1].a_type == A_FLOAT){
+            detune = atom_getfloat(*av + 1);
+            *ac -= 2, *av += 2;
+        }
+        else
+            return(0);
+    }
+    blosc_init(o, shape, nvoices, 0);
+    o->o_bl = bl;
+    blosc_detune(o, detune);
+    return(1);
+}
+
+void blosc_detune(t_blosc *o, double cents){
+    int v, n = o->o_nvoices;
+    for(v = 0; v < n; v++) // evenly from -cents to +cents
+        o->o_ratio[v] = n > 1 ? pow(2, cents * (2. * v / (n - 1) - 1) / 1200.) : 1;
+}
+
+void blosc_phase(t_blosc *o, double phase){
+    int v;
+    o->o_phase[0] = phase;
+    for(v = 1; v < o->o_nvoices; v++){
+        double p = phase + o->o_spread[v];
+        o->o_phase[v] = p >= 1 ? p - 1 : p;
+    }
+}
+
+// one sample of one voice as the objects always computed it, advances the phase
+static inline double blosc_naive(t_blosc *o, int shape, double *phasep, double step,
+double width, double dev, double trig, double spread){
+    double phase = *phasep, output;
+    if(shape == BLOSC_SQUARE){
+        if(step >= 0){
+            if(trig > 0 && trig <= 1)
+                phase = trig + spread;
+            else{
+                phase = phase + dev;
+                if(phase <= 0)
+                    phase = phase + 1.; // wrap deviated phase
+            }
+            if(phase >= 1){
+                output = 1; // 1st sample is always 1
+                phase = phase - 1; // wrapped phase
+            }
+            else if(phase + step >= 1)
+                output = -1; // last sample is always -1
+            else
+                output = phase <= width ? 1 : -1;
+        }
+        else{
+            if(trig > 0 && trig < 1)
+                phase = trig + spread;
+            else if(trig == 1)
+                phase = spread;
+            else{
+                phase = phase + dev;
+                if(phase >= 1)
+                    phase = phase - 1.; // wrap deviated phase
+            }
+            if(phase <= 0){
+                output = -1; // 1st sample is always -1
+                phase = phase + 1; // wrapped phase
+            }
+            else if(phase + step <= 0)
+                output = 1; // last sample is always 1
+            else
+                output = phase <= width ? 1 : -1;
+        }
+        *phasep = phase + step;
+        return(output);
+    }
+    if(trig > 0 && trig <= 1){ // vsaw~ syncs to 0 where the others sync to 1
+        phase = shape == BLOSC_VSAW && trig == 1 ? 0 : trig;
+        if(spread > 0){
+            phase += spread;
+            if(phase >= 1)
+                phase -= 1;
+        }
+    }
+    else{
+        phase = phase + dev;
+        if(phase <= 0)
+            phase = phase + 1.; // wrap deviated phase
+        if(phase >= 1)
+            phase = phase - 1.; // wrap deviated phase
+    }
+    if(shape == BLOSC_SAW)
+        output = phase * -2 + 1;
+    else if(shape == BLOSC_TRI){
+        output = phase * 4;
+        if(output >= 1 && output < 3)
+            output = 1 - (output - 1);
+        else if(output >= 3 && output)
+            output = (output - 4);
+    }
+    else if(width == 0)
+        output = phase * -2 + 1;
+    else if(width == 1)
+        output = phase * 2 - 1;
+    else{
+        if(width != o->o_width){ // only changes with the width input
+            o->o_width = width;
+            o->o_gain = (t_float)pow(width * (width - 1), -1);
+        }
+        t_float inc = phase * width;
+        t_float dec = (phase - 1) * (width - 1);
+        t_float gain = o->o_gain;
+        t_float min = (inc < dec ? inc : dec);
+        output = (min * gain) * 2 + 1;
+    }
+    *phasep = phase + step;
+    return(output);
+}
+
+// adds a voice to out through a block without sync or phase offset changes,
+// returns the phase after it
+static inline double blosc_naivevoice(t_blosc *o, int shape, int n, double phase,
+double step, double width, double gain, t_float *out){
+    int i;
+    for(i = 0; i < n; i++)
+        out[i] += blosc_naive(o, shape, &phase, step, width, 0, 0, 0) * gain;
+    return(phase);
+}
+
+// a single naive voice through a block without sync or phase offset changes,
+// written straight to out with one loop for each shape and the branches on the
+// width and direction taken before it, sample for sample what blosc_naive() gives
+static void blosc_naivesingle(t_blosc *o, int n, double step, double width, t_float *out){
+    double phase = o->o_phase[0];
+    int i;
+    if(o->o_shape == BLOSC_SQUARE){
+        if(step >= 0){
+            for(i = 0; i < n; i++){
+                if(phase <= 0)
+                    phase = phase + 1.;
+                if(phase >= 1){
+                    out[i] = 1;
+                    phase = phase - 1;
+                }
+                else
+                    out[i] = phase + step >= 1 ? -1 : phase <= width ? 1 : -1;
+                phase = phase + step;
+            }
+        }
+        else{
+            for(i = 0; i < n; i++){
+                if(phase >= 1)
+                    phase = phase - 1.;
+                if(phase <= 0){
+                    out[i] = -1;
+                    phase = phase + 1;
+                }
+                else
+                    out[i] = phase + step <= 0 ? 1 : phase <= width ? 1 : -1;
+                phase = phase + step;
+            }
+        }
+        o->o_phase[0] = phase;
+        return;
+    }
+    if(o->o_shape == BLOSC_VSAW && width > 0 && width < 1){
+        t_float gain;
+        if(width != o->o_width){
+            o->o_width = width;
+            o->o_gain = (t_float)pow(width * (width - 1), -1);
+        }
+        gain = o->o_gain;
+        for(i = 0; i < n; i++){
+            if(phase <= 0)
+                phase = phase + 1.;
+            if(phase >= 1)
+                phase = phase - 1.;
+            t_float inc = phase * width;
+            t_float dec = (phase - 1) * (width - 1);
+            t_float min = (inc < dec ? inc : dec);
+            out[i] = (min * gain) * 2 + 1;
+            phase = phase + step;
+        }
+    }
+    else if(o->o_shape == BLOSC_TRI){
+        for(i = 0; i < n; i++){
+            double output;
+            if(phase <= 0)
+                phase = phase + 1.;
+            if(phase >= 1)
+                phase = phase - 1.;
+            output = phase * 4;
+            out[i] = output >= 3 ? output - 4 : output >= 1 ? 1 - (output - 1) : output;
+            phase = phase + step;
+        }
+    }
+    else{ // saw~, and vsaw~ at a width of 0 or 1
+        double sign = o->o_shape == BLOSC_VSAW && width == 1 ? 1 : -1;
+        for(i = 0; i < n; i++){
+            if(phase <= 0)
+                phase = phase + 1.;
+            if(phase >= 1)
+                phase = phase - 1.;
+            out[i] = phase * (2 * sign) - sign;
+            phase = phase + step;
+        }
+    }
+    o->o_phase[0] = phase;
+}
+
+// PolyBLEP residual of a step of +2 at phase 0, dt is the step size of the phase;
+// these are written without branches so the loops over them vectorize
+static inline double blosc_blep(double t, double dt, double idt){
+    double a = t * idt, b = (t - 1.) * idt;
+    return(t < dt ? a + a - a * a - 1. : t > 1. - dt ? b * b + b + b + 1. : 0);
+}
+
+// PolyBLAMP residual of a slope change of 1 per sample at phase 0
+static inline double blosc_blamp(double t, double dt, double idt){
+    double x = t < dt ? 1. - t * idt : t > 1. - dt ? 1. - (1. - t) * idt : 0;
+    return(x * x * x * (1. / 6.));
+}
+
+// the band-limited shapes come down to three kernels
+#define BLOSC_KSAW      0 // falling from 1 to -1
+#define BLOSC_KSQUARE   1 // 1 up to the width, then -1
+#define BLOSC_KCORNER   2 // 1 at 0, down to -1 at a and back up
+
+static inline double blosc_kernel(int k, double t, double dt, double idt, double a){
+    if(k == BLOSC_KSAW)
+        return(1. - 2. * t + blosc_blep(t, dt, idt));
+    double u = t - a;
+    u += u < 0 ? 1 : 0;
+    if(k == BLOSC_KSQUARE)
+        return((t < a ? 1. : -1.) + blosc_blep(t, dt, idt) - blosc_blep(u, dt, idt));
+    double y = t < a ? 1. - t * (2. / a) : -1. + (t - a) * (2. / (1. - a));
+    double slope = 2. * dt / (a * (1. - a)); // change per sample at the corners
+    return(y + slope * (blosc_blamp(u, dt, idt) - blosc_blamp(t, dt, idt)));
+}
+
+// kernel, its gain and phase shift for a shape, dt is the absolute phase step
+static inline int blosc_blkernel(int shape, double width, double dt,
+double *a, double *gain, double *shift){
+    *a = width, *gain = 1, *shift = 0;
+    if(shape == BLOSC_SAW)
+        return(BLOSC_KSAW);
+    if(shape == BLOSC_SQUARE)
+        return(BLOSC_KSQUARE);
+    if(shape == BLOSC_TRI){ // a corner at 0.5 a quarter cycle later
+        *a = 0.5, *shift = 0.75;
+        return(BLOSC_KCORNER);
+    }
+    if(width <= dt) // corners less than a sample apart, the saw vsaw~ tends to
+        return(BLOSC_KSAW);
+    if(width >= 1. - dt){
+        *gain = -1;
+        return(BLOSC_KSAW);
+    }
+    *a = 1. - width;
+    return(BLOSC_KCORNER);
+}
+
+static inline double blosc_blshape(int shape, double t, double dt, double width){
+    double a, gain, shift, idt = dt > 0 ? 1. / dt : 0;
+    int k = blosc_blkernel(shape, width, dt, &a, &gain, &shift);
+    t += shift;
+    t -= t >= 1 ? 1 : 0;
+    return(gain * blosc_kernel(k, t, dt, idt, a));
+}
+
+// adds a voice to out, each phase found from the first so the samples don't
+// depend on each other, returns the phase after the block
+static inline double blosc_blvoice(int k, int n, double p, double step, double dt,
+double a, double gain, t_float *out){
+    double idt = dt > 0 ? 1. / dt : 0;
+    int i;
+    for(i = 0; i < n; i++){
+        double t = p + i * step;
+        t -= (int)t;
+        out[i] += gain * blosc_kernel(k, t, dt, idt, a);
+    }
+    p += n * step;
+    return(p - (int)p);
+}
+
+static inline double blosc_step(double hz, double ratio, double sr){
+    double step = (hz * ratio) / sr;
+    return(step > 0.5 ? 0.5 : step < -0.5 ? -0.5 : step); // clipped to nyq
+}
+
+static int blosc_constant(t_float *in, int n, double f){
+    int i;
+    for(i = 0; i < n; i++)
+        if(in[i] != f)
+            return(0);
+    return(1);
+}
+
+// no sync and nothing changes in the block
+static void blosc_perform_constant(t_blosc *o, int n, double hz, double width, t_float *out){
+    int i, v, nv = o->o_nvoices;
+    double norm = 1. / nv;
+    if(!o->o_bl && nv == 1){
+        blosc_naivesingle(o, n, blosc_step(hz, o->o_ratio[0], o->o_sr), width, out);
+        return;
+    }
+    for(i = 0; i < n; i++)
+        out[i] = 0;
+    if(!o->o_bl){
+        for(v = 0; v < nv; v++){
+            double step = blosc_step(hz, o->o_ratio[v], o->o_sr), p = o->o_phase[v];
+            if(o->o_shape == BLOSC_SAW) // a loop for each shape
+                p = blosc_naivevoice(o, BLOSC_SAW, n, p, step, width, norm, out);
+            else if(o->o_shape == BLOSC_SQUARE)
+                p = blosc_naivevoice(o, BLOSC_SQUARE, n, p, step, width, norm, out);
+            else if(o->o_shape == BLOSC_TRI)
+                p = blosc_naivevoice(o, BLOSC_TRI, n, p, step, width, norm, out);
+            else
+                p = blosc_naivevoice(o, BLOSC_VSAW, n, p, step, width, norm, out);
+            o->o_phase[v] = p;
+        }
+        return;
+    }
+    for(v = 0; v < nv; v++){
+        double a, gain, shift, p;
+        double step = blosc_step(hz, o->o_ratio[v], o->o_sr), dt = fabs(step);
+        int k = blosc_blkernel(o->o_shape, width, dt, &a, &gain, &shift);
+        p = o->o_phase[v] - floor(o->o_phase[v]) + shift;
+        if(step < 0) // keeps the phases positive for the truncation
+            p += (double)(n / 2 + 2);
+        gain *= norm;
+        if(k == BLOSC_KSAW) // a loop for each kernel
+            p = blosc_blvoice(BLOSC_KSAW, n, p, step, dt, a, gain, out);
+        else if(k == BLOSC_KSQUARE)
+            p = blosc_blvoice(BLOSC_KSQUARE, n, p, step, dt, a, gain, out);
+        else
+            p = blosc_blvoice(BLOSC_KCORNER, n, p, step, dt, a, gain, out);
+        p -= shift;
+        o->o_phase[v] = p < 0 ? p + 1 : p;
+    }
+}
+
+void blosc_perform(t_blosc *o, int n, t_float *freq, t_float *width,
+t_float *sync, t_float *offset, t_float *out){
+    double last_phase_offset = o->o_last_offset;
+    double sr = o->o_sr, norm = 1. / o->o_nvoices;
+    int i, v, nv = o->o_nvoices;
+    if(!sync && blosc_constant(offset, n, last_phase_offset)
+    && blosc_constant(freq, n, freq[0]) && (!width || blosc_constant(width, n, width[0]))){
+        double w = width ? width[0] : 0;
+        w = w > 1. ? 1. : w < 0. ? 0. : w; // clipped
+        blosc_perform_constant(o, n, freq[0], w, out);
+        return;
+    }
+    for(i = 0; i < n; i++){
+        double hz = freq[i];
+        double w = width ? width[i] : 0;
+        w = w > 1. ? 1. : w < 0. ? 0. : w; // clipped
+        double trig = sync ? sync[i] : 0;
+        double phase_offset = offset[i];
+        double phase_dev = phase_offset - last_phase_offset;
+        double sum = 0;
+        if(phase_dev >= 1 || phase_dev <= -1)
+            phase_dev = fmod(phase_dev, 1); // fmod(phase_dev)
+        for(v = 0; v < nv; v++){
+            double step = blosc_step(hz, o->o_ratio[v], sr);
+            if(!o->o_bl)
+                sum += blosc_naive(o, o->o_shape, &o->o_phase[v], step, w,
+                    phase_dev, trig, o->o_spread[v]);
+            else{
+                double p = o->o_phase[v];
+                if(trig > 0 && trig <= 1)
+                    p = trig + o->o_spread[v];
+                else
+                    p += phase_dev;
+                p -= floor(p);
+                sum += blosc_blshape(o->o_shape, p, fabs(step), w);
+                o->o_phase[v] = p + step;
+            }
+        }
+        out[i] = nv > 1 ? sum * norm : sum;
+        last_phase_offset = phase_offset;
+    }
+    o->o_last_offset = last_phase_offset;
+}
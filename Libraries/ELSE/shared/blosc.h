@@ -0,0 +1,50 @@
+// oscillator core shared by saw~, square~, tri~ and vsaw~
+
+// An oscillator runs one or more voices from the same inputs, more than one makes a
+// unison detuned around the input frequency. The phase follows the inputs the way the
+// objects always did: frequency, phase sync and phase offset, steps clipped to nyquist.
+// Shapes are read either naive, sample for sample what the objects always output, or
+// band-limited with PolyBLEP corrections at the steps and PolyBLAMP at the corners.
+//
+// A block without sync whose frequency, width and phase offset stay put takes a fast
+// path: steps and gains are computed once, and the band-limited shapes find each phase
+// in closed form, so the loop over the block has no dependency from sample to sample
+// and the compiler can vectorize it. A single naive voice is written straight to the
+// output, with a loop for each shape. Sync and phase offset jumps aren't band-limited.
+
+#ifndef __BLOSC_H__
+#define __BLOSC_H__
+
+#define BLOSC_MAXVOICES 16
+
+#define BLOSC_SAW       0
+#define BLOSC_SQUARE    1
+#define BLOSC_TRI       2
+#define BLOSC_VSAW      3
+
+typedef struct _blosc{
+    int     o_shape;
+    int     o_bl;                           // band-limited
+    int     o_nvoices;
+    double  o_sr;
+    double  o_last_offset;                  // phase offset input at the last sample
+    double  o_width;                        // vsaw~: width o_gain was computed for
+    double  o_gain;
+    double  o_phase[BLOSC_MAXVOICES];       // next phase, wrapped when it is read
+    double  o_ratio[BLOSC_MAXVOICES];       // frequency relative to the input
+    double  o_spread[BLOSC_MAXVOICES];      // phase relative to the first voice
+}t_blosc;
+
+// phase as the objects set it from their argument, 1 starts a rising cycle
+void blosc_init(t_blosc *o, int shape, int nvoices, double phase);
+// reads the -bl, -unison <n> and -detune <cents> flags in front of the arguments
+// and inits, returns 0 for flags it doesn't know
+int blosc_flags(t_blosc *o, int shape, int *ac, t_atom **av);
+void blosc_detune(t_blosc *o, double cents); // spread of the unison, outer voices
+void blosc_phase(t_blosc *o, double phase);  // sets every voice, from 0 to 1
+
+// width and sync may be 0 for shapes without width and when sync isn't a signal
+void blosc_perform(t_blosc *o, int n, t_float *freq, t_float *width,
+    t_float *sync, t_float *offset, t_float *out);
+
+#endif
@@ -29,6 +29,39 @@ t_word *buffer_get(t_buffer *c, t_symbol * name, int *bufsize, int indsp, int co
     return (0);
 }
 
+// binds the sample pool named like the buffer, returns 0 if there is none
+// the reference is kept until the pool is gone or the buffer is renamed
+static int buffer_getpool(t_buffer *c){
+    t_samplepool *p = c->c_usepool ? samplepool_find(c->c_bufname) : 0;
+    int ch, found = 0;
+    if(p != c->c_pool){
+        if(p)
+            samplepool_acquire(p);
+        if(c->c_pool)
+            samplepool_release(c->c_pool);
+        c->c_pool = p;
+    }
+    memset(c->c_fvectors, 0, c->c_numchans * sizeof(*c->c_fvectors));
+    if(!p)
+        return(0);
+    for(ch = 0; ch < c->c_numchans; ch++){
+        // single channel mode reads channel c_single (1-indexed)
+        int idx = c->c_single ? c->c_single - 1 : ch;
+        c->c_vectors[ch] = 0;
+        c->c_fvectors[ch] = samplepool_channel(p, idx, &c->c_stride);
+        if(c->c_fvectors[ch])
+            found = 1;
+    }
+    c->c_npts = found ? p->p_nframes : 0;
+    return(1);
+}
+
+void buffer_usepool(t_buffer *c){
+    c->c_usepool = 1;
+    buffer_validate(c, 0);
+    buffer_playcheck(c);
+}
+
 //making peek~ work with channel number choosing, assuming 1-indexed
 void buffer_getchannel(t_buffer *c, int chan_num, int complain){
     int chan_idx;
@@ -41,6 +74,8 @@ void buffer_getchannel(t_buffer *c, int chan_num, int complain){
     c->c_single = chan_num;
     //convert to 0-indexing, separate steps and diff variable for sanity's sake
     chan_idx = chan_num - 1;
+    if(buffer_getpool(c))
+        return;
     //making the buffer channel name string we'll be looking for
     if(c->c_bufname != &s_){
         if(chan_idx == 0){
@@ -80,9 +115,12 @@ void buffer_bug(char *fmt, ...){ // from loud.c
 void buffer_clear(t_buffer *c){
     c->c_npts = 0;
     memset(c->c_vectors, 0, c->c_numchans * sizeof(*c->c_vectors));
+    memset(c->c_fvectors, 0, c->c_numchans * sizeof(*c->c_fvectors));
 }
 
 void buffer_redraw(t_buffer *c){
+    if(c->c_pool) // pools aren't drawn
+        return;
     if(!c->c_single){
         if(c->c_numchans <= 1 && c->c_bufname != &s_){
             t_garray *ap = (t_garray *)pd_findbyclass(c->c_bufname, garray_class);
@@ -133,6 +171,8 @@ void buffer_validate(t_buffer *c, int complain){
     buffer_clear(c);
     c->c_npts = SHARED_INT_MAX;
     if(!c->c_single){
+        if(buffer_getpool(c))
+            return;
         if (c->c_numchans <= 1 && c->c_bufname != &s_){
             c->c_vectors[0] = buffer_get(c, c->c_bufname, &c->c_npts, 1, 0);
             if(!c->c_vectors[0]){ // check for 0-bufname if bufname array isn't found
@@ -200,6 +240,10 @@ void buffer_free(t_buffer *c){
         freebytes(c->c_vectors, c->c_numchans * sizeof(*c->c_vectors));
     if (c->c_channames)
         freebytes(c->c_channames, c->c_numchans * sizeof(*c->c_channames));
+    if (c->c_fvectors)
+        freebytes(c->c_fvectors, c->c_numchans * sizeof(*c->c_fvectors));
+    if (c->c_pool)
+        samplepool_release(c->c_pool);
     freebytes(c, sizeof(t_buffer));
 }
 
@@ -213,6 +257,7 @@ void *buffer_init(t_class *owner, t_symbol *bufname, int numchans, int singlemod
     t_buffer *c = (t_buffer *)getbytes(sizeof(t_buffer));
     t_float **vectors;
     t_symbol **channames = 0;
+    float **fvectors;
     if(!bufname)
         bufname = &s_;
     c->c_bufname = bufname;
@@ -224,11 +269,20 @@ void *buffer_init(t_class *owner, t_symbol *bufname, int numchans, int singlemod
 		freebytes(vectors, numchans * sizeof(*vectors));
         return(0);
     };
+    if(!(fvectors = (float **)getbytes(numchans * sizeof(*fvectors)))){
+        freebytes(vectors, numchans * sizeof(*vectors));
+        freebytes(channames, numchans * sizeof(*channames));
+        return(0);
+    }
     c->c_single = singlemode;
     c->c_owner = owner;
     c->c_npts = 0;
     c->c_vectors = (t_word**)vectors;
     c->c_channames = channames;
+    c->c_fvectors = fvectors;
+    c->c_pool = 0;
+    c->c_usepool = 0;
+    c->c_stride = 1;
     c->c_disabled = 0;
     c->c_playable = 0;
     c->c_minsize = 1;
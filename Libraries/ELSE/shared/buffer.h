@@ -10,6 +10,8 @@
 
 #define buffer_MAXCHANS 64 //max number of channels
 
+#include "samplepool.h"
+
 typedef struct _buffer{
     //t_sic       s_sic;
     void     *c_owner; //owner of buffer, note i don't know if this actually works
@@ -26,6 +28,10 @@ typedef struct _buffer{
     int         c_single; //flag for single channel mode
                         //0-regular mode, 1-load this particular channel (1-idx)
                         //should be used with c_numchans == 1
+    int         c_usepool;  //owner reads sample pools, see buffer_usepool
+    t_samplepool *c_pool;   //pool of c_bufname, c_vectors are all null when it's set
+    float     **c_fvectors; //channels of c_pool
+    int         c_stride;   //floats between two frames of c_fvectors
 }t_buffer;
 
 void buffer_bug(char *fmt, ...);
@@ -54,5 +60,8 @@ void buffer_free(t_buffer *c);
 //void buffer_setup(t_class *c, void *dspfn, void *floatfn);
 void buffer_checkdsp(t_buffer *c);
 void buffer_getchannel(t_buffer *c, int chan_num, int complain);
+//look for a sample pool named like the buffer before the arrays
+//only for owners that read both c_vectors and c_fvectors
+void buffer_usepool(t_buffer *c);
 
 #endif
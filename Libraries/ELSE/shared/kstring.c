@@ -0,0 +1,239 @@
+// plucked string core of pluck~, see kstring.h
+
+#include "m_pd.h"
+#include <math.h>
+#include <string.h>
+#include "random.h"
+#include "kstring.h"
+
+#define PI 3.14159265358979323846
+
+static uint32_t random_trand(uint32_t* s1, uint32_t* s2, uint32_t* s3 ){
+    // This function is provided for speed in inner loops where the
+    // state variables are loaded into registers.
+    // Thus updating the instance variables can
+    // be postponed until the end of the loop.
+    *s1 = ((*s1 &  (uint32_t)- 2) << 12) ^ (((*s1 << 13) ^  *s1) >> 19);
+    *s2 = ((*s2 &  (uint32_t)- 8) <<  4) ^ (((*s2 <<  2) ^  *s2) >> 25);
+    *s3 = ((*s3 &  (uint32_t)-16) << 17) ^ (((*s3 <<  3) ^  *s3) >> 11);
+    return *s1 ^ *s2 ^ *s3;
+}
+
+static float random_frand(uint32_t* s1, uint32_t* s2, uint32_t* s3){
+    // return a float from -1.0 to +0.999...
+    union { uint32_t i; float f; } u;        // union for floating point conversion of result
+    u.i = 0x40000000 | (random_trand(s1, s2, s3) >> 9);
+    return u.f - 3.f;
+}
+
+static void kstring_period(t_kstring *k, int s, t_float hz){
+    float period = 1./hz;
+    k->k_hz[s] = hz;
+    k->k_delms[s] = period * 1000;
+    k->k_samps[s] = (int)roundf(period * k->k_sr);
+    k->k_delay[s] = k->k_samps[s] < 1 ? 1 : k->k_samps[s];
+    if((unsigned int)k->k_delay[s] > k->k_size)
+        k->k_delay[s] = k->k_size;
+}
+
+static void kstring_feedback(t_kstring *k, int s, t_float decay){
+    k->k_decay[s] = decay;
+    if(decay == 0)
+        k->k_fb[s] = 0;
+    else
+        k->k_fb[s] = copysign(exp(log(0.001) * k->k_delms[s]/fabs(decay)), decay);
+}
+
+static void kstring_filter(t_kstring *k, int s, t_float cutoff){
+    double cuttoff = (double)cutoff;
+    double omega, alphaQ, cos_w, b0;
+    double nyq = (k->k_sr * 0.5);
+    double hz2rad = PI/nyq;
+    k->k_cutoff[s] = cutoff;
+    if (cuttoff < 0.000001)
+        cuttoff = 0.000001;
+    if (cuttoff > nyq - 0.000001)
+        cuttoff = nyq - 0.000001;
+    omega = cuttoff * hz2rad;
+    alphaQ = sin(omega); // q = 0.5
+    cos_w = cos(omega);
+    b0 = alphaQ + 1;
+    k->k_a0[s] = (1 - cos_w) / (2 * b0);
+    k->k_a1[s] = (1 - cos_w) / b0;
+    k->k_b1[s] = 2*cos_w / b0;
+    k->k_b2[s] = (alphaQ - 1) / b0;
+}
+
+// whole samples plus an allpass for what the loop filter leaves of the period
+static void kstring_tuning(t_kstring *k, int s){
+    double w = 2 * PI * k->k_hz[s] / k->k_sr;
+    double b1 = k->k_b1[s], b2 = k->k_b2[s];
+    // the numerator is symmetric, a sample of delay, the poles add the rest
+    double tau = 1 + atan2(b1 * sin(w) + b2 * sin(2 * w),
+        1 - b1 * cos(w) - b2 * cos(2 * w)) / w;
+    double delay = k->k_sr / k->k_hz[s] - tau, frac, eta;
+    int whole = (int)floor(delay - 0.1); // keeps the fraction from 0.1 to 1.1
+    if(whole < 1)
+        whole = 1;
+    if((unsigned int)whole > k->k_size - 1)
+        whole = k->k_size - 1;
+    frac = delay - whole;
+    if(frac < 0)
+        frac = 0;
+    // the allpass has exactly this phase delay at w
+    eta = sin((1 - frac) * w / 2) / sin((1 + frac) * w / 2);
+    k->k_delay[s] = whole;
+    k->k_eta[s] = eta < -0.999 ? -0.999 : eta > 0.999 ? 0.999 : eta;
+}
+
+// recomputes what the inputs changed
+static inline void kstring_params(t_kstring *k, int s, t_float hz, t_float decay,
+t_float cutoff){
+    int newhz = hz != k->k_hz[s] && hz >= 1, newcut = cutoff != k->k_cutoff[s];
+    if(newhz)
+        kstring_period(k, s, hz);
+    if(newhz || decay != k->k_decay[s])
+        kstring_feedback(k, s, decay);
+    if(newcut)
+        kstring_filter(k, s, cutoff);
+    if(k->k_tune && (newhz || newcut) && k->k_hz[s] >= 1)
+        kstring_tuning(k, s);
+}
+
+void kstring_init(t_kstring *k, int n, int tune){
+    int s;
+    memset(k, 0, sizeof(*k));
+    k->k_n = n < 1 ? 1 : n > KSTRING_MAX ? KSTRING_MAX : n;
+    k->k_tune = tune;
+    k->k_sr = sys_getsr();
+    for(s = 0; s < KSTRING_MAX; s++){
+        k->k_delay[s] = 1;
+        kstring_filter(k, s, 0);
+    }
+}
+
+int kstring_resize(t_kstring *k, float sr, double maxms){
+    // a sample more, a delay of the whole buffer reads where it writes
+    unsigned int size = (unsigned int)ceil(maxms * 0.001 * (double)sr) + 1;
+    int s;
+    kstring_free(k);
+    k->k_sr = sr;
+    if(!(k->k_ring = (double *)getbytes(sizeof(double) * size * k->k_n)))
+        return(0);
+    k->k_size = size;
+    for(s = 0; s < KSTRING_MAX; s++){ // parameters for the new rate
+        t_float hz = k->k_hz[s], cutoff = k->k_cutoff[s];
+        k->k_hz[s] = 0;
+        kstring_filter(k, s, cutoff);
+        kstring_params(k, s, hz, k->k_decay[s], cutoff);
+    }
+    kstring_clear(k);
+    return(1);
+}
+
+void kstring_free(t_kstring *k){
+    if(k->k_ring)
+        freebytes(k->k_ring, sizeof(double) * k->k_size * k->k_n);
+    k->k_ring = 0;
+    k->k_size = 0;
+}
+
+void kstring_clear(t_kstring *k){
+    int s;
+    if(k->k_ring)
+        memset(k->k_ring, 0, sizeof(double) * k->k_size * k->k_n);
+    k->k_wh = 0;
+    for(s = 0; s < KSTRING_MAX; s++)
+        k->k_xnm1[s] = k->k_xnm2[s] = k->k_ynm1[s] = k->k_ynm2[s] =
+            k->k_apx[s] = k->k_apy[s] = 0.;
+}
+
+// one sample of every string: the delayed samples are gathered first, then the same
+// operations run for all strings, which the compiler can run side by side
+static inline t_float kstring_tick(t_kstring *k, const t_float *ex, int tune){
+    int s, n = k->k_n;
+    unsigned int wh = k->k_wh, size = k->k_size;
+    double *ring = k->k_ring, *frame = ring + (size_t)wh * n;
+    double fb_del[KSTRING_MAX], output[KSTRING_MAX], yn[KSTRING_MAX];
+    double sum = 0;
+    for(s = 0; s < n; s++){
+        int rd = (int)wh - k->k_delay[s];
+        fb_del[s] = ring[(size_t)(rd < 0 ? rd + (int)size : rd) * n + s];
+    }
+    if(tune){
+        for(s = 0; s < n; s++){
+            double ap = k->k_eta[s] * (fb_del[s] - k->k_apy[s]) + k->k_apx[s];
+            k->k_apx[s] = fb_del[s];
+            k->k_apy[s] = fb_del[s] = ap;
+        }
+    }
+    for(s = 0; s < n; s++){
+        output[s] = (double)ex[s] + (double)k->k_fb[s] * fb_del[s];
+        yn[s] = k->k_a0[s] * output[s] + k->k_a1[s] * k->k_xnm1[s]
+            + k->k_a0[s] * k->k_xnm2[s] + k->k_b1[s] * k->k_ynm1[s]
+            + k->k_b2[s] * k->k_ynm2[s];
+        k->k_xnm2[s] = k->k_xnm1[s];
+        k->k_xnm1[s] = output[s];
+        k->k_ynm2[s] = k->k_ynm1[s];
+        k->k_ynm1[s] = yn[s];
+    }
+    for(s = 0; s < n; s++){
+        frame[s] = yn[s]; // put into delay buffer
+        sum += output[s];
+    }
+    k->k_wh = (wh + 1) % size; // increment writehead
+    return(sum);
+}
+
+void kstring_perform(t_kstring *k, struct _random_state *rstate, int n,
+t_float *hz_in, t_float *t_in, t_float *decay_in, t_float *cut_in,
+t_float *noise_in, t_float *out){
+    uint32_t *s1 = &rstate->s1;
+    uint32_t *s2 = &rstate->s2;
+    uint32_t *s3 = &rstate->s3;
+    t_float last_trig = k->k_last_trig;
+    t_float ex[KSTRING_MAX];
+    int nstrings = k->k_n, s;
+    if(!k->k_ring){
+        memset(out, 0, n * sizeof(t_float));
+        return;
+    }
+    for(int i = 0; i < n; i++){
+        t_float hz = hz_in[i];
+        t_float trig = t_in[i];
+        t_float decay = decay_in[i], cutoff = cut_in[i];
+        if(nstrings == 1){
+            if(hz < 1){ // mute
+                out[i] = k->k_count[0] = k->k_amp[0] = 0;
+                k->k_xnm1[0] = k->k_xnm2[0] = k->k_ynm1[0] = k->k_ynm2[0] = 0;
+                continue;
+            }
+            kstring_params(k, 0, hz, decay, cutoff);
+            if(trig != 0 && last_trig == 0){
+                k->k_count[0] = 0;
+                k->k_amp[0] = trig;
+            }
+        }
+        else{
+            if(trig != 0 && last_trig == 0 && hz >= 1){ // pluck the next string
+                s = k->k_next;
+                k->k_next = (s + 1) % nstrings;
+                kstring_params(k, s, hz, decay, cutoff);
+                k->k_count[s] = 0;
+                k->k_amp[s] = trig;
+            }
+            for(s = 0; s < nstrings; s++)
+                kstring_params(k, s, k->k_hz[s], decay, cutoff);
+        }
+        last_trig = trig;
+        for(s = 0; s < nstrings; s++){ // noise burst for a period after the pluck
+            t_float gate = (k->k_count[s]++ <= k->k_samps[s]) * k->k_amp[s];
+            if(gate != 0)
+                ex[s] = (noise_in ? noise_in[i] : (t_float)(random_frand(s1, s2, s3))) * gate;
+            else
+                ex[s] = 0;
+        }
+        out[i] = k->k_tune ? kstring_tick(k, ex, 1) : kstring_tick(k, ex, 0);
+    }
+    k->k_last_trig = last_trig;
+}
@@ -0,0 +1,68 @@
+// plucked string core of pluck~, see kstring.c
+
+// A bank runs one or more Karplus-Strong strings that share the delay buffer, one
+// frame of it holds a sample of every string, so they all use the same write head.
+// Every string keeps the parameters it was last computed for, and they are only
+// recomputed when the input they come from changes: at control rate the delay, the
+// feedback and the loop filter are computed once, not for every sample.
+//
+// One string follows the inputs sample for sample, as pluck~ always did. With more
+// strings a trigger plucks the next one at the frequency it gets then, so they ring
+// on together, the decay and cutoff inputs go to all of them.
+//
+// By default the period is rounded to whole samples, as pluck~ always did. Tuned,
+// the delay is shortened by the phase delay of the loop filter at the frequency and
+// the fraction of a sample left is made by a first order allpass in the loop.
+
+#ifndef __KSTRING_H__
+#define __KSTRING_H__
+
+#define KSTRING_MAX 8
+
+struct _random_state;
+
+typedef struct _kstring{
+    int             k_n;                    // strings
+    int             k_tune;                 // fraction of the period through the allpass
+    int             k_next;                 // string the next trigger plucks
+    float           k_sr;
+    unsigned int    k_size;                 // frames in the buffer
+    unsigned int    k_wh;                   // write head
+    double         *k_ring;                 // k_size frames of k_n strings
+    t_float         k_last_trig;
+// parameters and the inputs they were computed for
+    t_float         k_hz[KSTRING_MAX];
+    t_float         k_decay[KSTRING_MAX];
+    t_float         k_cutoff[KSTRING_MAX];
+    float           k_delms[KSTRING_MAX];   // period in ms
+    int             k_samps[KSTRING_MAX];   // rounded period, also the length of the burst
+    int             k_delay[KSTRING_MAX];   // whole samples read back
+    double          k_eta[KSTRING_MAX];     // allpass coefficient, 0 untuned
+    t_float         k_fb[KSTRING_MAX];
+    double          k_a0[KSTRING_MAX];      // loop filter, a2 = a0
+    double          k_a1[KSTRING_MAX];
+    double          k_b1[KSTRING_MAX];
+    double          k_b2[KSTRING_MAX];
+// state
+    double          k_xnm1[KSTRING_MAX];
+    double          k_xnm2[KSTRING_MAX];
+    double          k_ynm1[KSTRING_MAX];
+    double          k_ynm2[KSTRING_MAX];
+    double          k_apx[KSTRING_MAX];     // allpass input and output
+    double          k_apy[KSTRING_MAX];
+    t_float         k_count[KSTRING_MAX];   // samples since the pluck
+    t_float         k_amp[KSTRING_MAX];
+}t_kstring;
+
+void kstring_init(t_kstring *k, int n, int tune);
+// buffer for periods up to maxms at sr, clears, returns 0 if allocation failed
+int kstring_resize(t_kstring *k, float sr, double maxms);
+void kstring_free(t_kstring *k);
+void kstring_clear(t_kstring *k);
+
+// noise may be 0 for the internal generator
+void kstring_perform(t_kstring *k, struct _random_state *rstate, int n,
+    t_float *hz, t_float *trig, t_float *decay, t_float *cutoff,
+    t_float *noise, t_float *out);
+
+#endif
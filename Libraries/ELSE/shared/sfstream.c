@@ -0,0 +1,690 @@
+
+#include "m_pd.h"
+#include "sfstream.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <sys/timeb.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#define sfstream_fseek _fseeki64
+#define sfstream_ftell _ftelli64
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define sfstream_fseek(fp, pos, whence) fseeko(fp, (off_t)(pos), whence)
+#define sfstream_ftell(fp) (long long)ftello(fp)
+#endif
+
+// The audio side writes s_chunk and s_gen of an EMPTY or READY slot, then hands it to the
+// reader by storing WANTED. The reader marks it LOADING, decodes and stores READY, which
+// hands it back. A store is a release and a load an acquire, so whatever a side wrote before
+// the hand-over is visible to the other side once it sees the new state.
+#define SLOT_EMPTY   0
+#define SLOT_WANTED  1
+#define SLOT_LOADING 2
+#define SLOT_READY   3
+
+#ifdef _MSC_VER
+#define sfstream_load(p)        _InterlockedOr((p), 0)
+#define sfstream_store(p, v)    _InterlockedExchange((p), (v))
+#else
+#define sfstream_load(p)        __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define sfstream_store(p, v)    __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+#define SFSTREAM_WAIT 5 // ms the reader sleeps when a wake up got lost
+
+typedef struct _sffile{
+    FILE           *f_fp;
+    unsigned char  *f_map;      // whole file if mapped
+    long long       f_size;
+#ifdef _WIN32
+    HANDLE          f_handle;
+    HANDLE          f_mapping;
+#endif
+    long long       f_offset;   // of the first frame
+    int             f_bytes;    // per sample
+    int             f_float;
+    int             f_bigendian;
+    int             f_unsigned; // 8 bit WAV
+    unsigned char  *f_buf;      // one chunk as read from the file
+    t_sfinfo        f_info;
+}t_sffile;
+
+struct _sfstream{
+    int             s_nchans;
+    t_sfslot        s_slots[SFSTREAM_NSLOTS];
+// audio side
+    long            s_seq;
+    long            s_gen;      // file in use
+    long            s_failed;   // failures already reported
+    int             s_last;     // slot of the last frame read
+    int             s_hasfile;
+    t_sfinfo        s_current;
+// handed over by the reader: s_info is written before s_published and
+// only rewritten once the audio side acknowledged the last file
+    t_sfatomic      s_published;
+    t_sfatomic      s_acked;
+    t_sfatomic      s_nfailed;
+    t_sfinfo        s_info;
+// under sfstream_mutex
+    char           *s_request;
+    int             s_usemap;
+    int             s_busy;     // reader is working on the stream
+    t_sfstream     *s_next;
+// reader only
+    t_sffile       *s_file;
+    t_sffile       *s_pending;  // opened, waits for the audio side to take the last one
+    long            s_filegen;
+};
+
+static pthread_mutex_t sfstream_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sfstream_cond = PTHREAD_COND_INITIALIZER;   // wakes the reader
+static pthread_cond_t sfstream_idle = PTHREAD_COND_INITIALIZER;   // reader let go of a stream
+static pthread_t sfstream_thread;
+static int sfstream_running, sfstream_quit;
+static t_sfstream *sfstream_list;
+
+// ----------------------------------------------------------------------------------------
+// sound file headers
+
+static unsigned long sfstream_be32(const unsigned char *p){
+    return((unsigned long)p[0] << 24 | (unsigned long)p[1] << 16 | (unsigned long)p[2] << 8 | p[3]);
+}
+
+static unsigned long sfstream_le32(const unsigned char *p){
+    return((unsigned long)p[3] << 24 | (unsigned long)p[2] << 16 | (unsigned long)p[1] << 8 | p[0]);
+}
+
+static unsigned long long sfstream_be64(const unsigned char *p){
+    return((unsigned long long)sfstream_be32(p) << 32 | sfstream_be32(p + 4));
+}
+
+static unsigned long long sfstream_le64(const unsigned char *p){
+    return((unsigned long long)sfstream_le32(p + 4) << 32 | sfstream_le32(p));
+}
+
+static int sfstream_readat(FILE *fp, long long pos, void *buf, int n){
+    if(sfstream_fseek(fp, pos, SEEK_SET))
+        return(0);
+    return(fread(buf, 1, n, fp) == (size_t)n);
+}
+
+// 80 bit extended of the AIFF sample rate
+static double sfstream_extended(const unsigned char *p){
+    int expon = ((p[0] & 0x7F) << 8 | p[1]) - 16383 - 63;
+    double mant = (double)sfstream_be64(p + 2);
+    return((p[0] & 0x80 ? -1 : 1) * ldexp(mant, expon));
+}
+
+static int sfstream_wav(t_sffile *f, FILE *fp){
+    unsigned char b[40];
+    long long pos = 12, ds64 = -1;
+    int tag = 0, align = 0, bits = 0, gotfmt = 0;
+    while(pos + 8 <= f->f_size && sfstream_readat(fp, pos, b, 8)){
+        long long size = sfstream_le32(b + 4);
+        if(!memcmp(b, "ds64", 4)){
+            if(!sfstream_readat(fp, pos + 8, b, 24))
+                return(0);
+            ds64 = (long long)sfstream_le64(b + 8);
+        }
+        else if(!memcmp(b, "fmt ", 4)){
+            int n = size < 40 ? (int)size : 40;
+            if(n < 16 || !sfstream_readat(fp, pos + 8, b, n))
+                return(0);
+            tag = b[0] | b[1] << 8;
+            f->f_info.i_nchans = b[2] | b[3] << 8;
+            f->f_info.i_sr = (double)sfstream_le32(b + 4);
+            align = b[12] | b[13] << 8;
+            bits = b[14] | b[15] << 8;
+            if(tag == 0xFFFE){ // extensible, the format is in the subformat GUID
+                if(n < 26)
+                    return(0);
+                tag = b[24] | b[25] << 8;
+            }
+            gotfmt = 1;
+        }
+        else if(!memcmp(b, "data", 4)){
+            if(!gotfmt)
+                return(0);
+            f->f_offset = pos + 8;
+            if(size == 0xFFFFFFFF && ds64 >= 0)
+                size = ds64;
+            if(size > f->f_size - f->f_offset) // still being written
+                size = f->f_size - f->f_offset;
+            if(tag == 3 && (bits == 32 || bits == 64))
+                f->f_float = 1;
+            else if(tag != 1)
+                return(0);
+            // a zero or short block align would give 0 byte samples and divide by zero below
+            if(f->f_info.i_nchans < 1 || align < f->f_info.i_nchans || align % f->f_info.i_nchans)
+                return(0);
+            f->f_bytes = align / f->f_info.i_nchans; // container, 24 in 32 bit is left justified
+            f->f_unsigned = (f->f_bytes == 1);
+            f->f_info.i_nframes = size / align;
+            return(1);
+        }
+        pos += 8 + size + (size & 1);
+    }
+    return(0);
+}
+
+static int sfstream_aiff(t_sffile *f, FILE *fp, int aifc){
+    unsigned char b[26];
+    long long pos = 12;
+    int bits = 0, gotcomm = 0;
+    f->f_bigendian = 1;
+    while(pos + 8 <= f->f_size && sfstream_readat(fp, pos, b, 8)){
+        long long size = sfstream_be32(b + 4);
+        if(!memcmp(b, "COMM", 4)){
+            if(size < 18 || !sfstream_readat(fp, pos + 8, b, aifc ? 22 : 18))
+                return(0);
+            f->f_info.i_nchans = b[0] << 8 | b[1];
+            f->f_info.i_nframes = sfstream_be32(b + 2);
+            bits = b[6] << 8 | b[7];
+            f->f_info.i_sr = sfstream_extended(b + 8);
+            if(aifc){
+                if(!memcmp(b + 18, "sowt", 4))
+                    f->f_bigendian = 0;
+                else if(!memcmp(b + 18, "fl32", 4) || !memcmp(b + 18, "FL32", 4))
+                    f->f_float = 1, bits = 32;
+                else if(!memcmp(b + 18, "fl64", 4) || !memcmp(b + 18, "FL64", 4))
+                    f->f_float = 1, bits = 64;
+                else if(memcmp(b + 18, "NONE", 4) && memcmp(b + 18, "twos", 4))
+                    return(0);
+            }
+            gotcomm = 1;
+        }
+        else if(!memcmp(b, "SSND", 4)){
+            if(!gotcomm || !sfstream_readat(fp, pos + 8, b, 4))
+                return(0);
+            f->f_offset = pos + 16 + sfstream_be32(b);
+            f->f_bytes = (bits + 7) / 8;
+            if(f->f_info.i_nchans < 1 || f->f_bytes < 1 || f->f_bytes > 8)
+                return(0);
+            if(f->f_info.i_nframes * f->f_info.i_nchans * f->f_bytes > f->f_size - f->f_offset)
+                f->f_info.i_nframes = (f->f_size - f->f_offset) / (f->f_info.i_nchans * f->f_bytes);
+            return(1);
+        }
+        pos += 8 + size + (size & 1);
+    }
+    return(0);
+}
+
+static int sfstream_caf(t_sffile *f, FILE *fp){
+    unsigned char b[32];
+    long long pos = 8;
+    int gotdesc = 0;
+    while(pos + 12 <= f->f_size && sfstream_readat(fp, pos, b, 12)){
+        long long size = (long long)sfstream_be64(b + 4);
+        if(!memcmp(b, "desc", 4)){
+            unsigned long flags, bytes;
+            uint64_t u;
+            if(size < 32 || !sfstream_readat(fp, pos + 12, b, 32))
+                return(0);
+            if(memcmp(b + 8, "lpcm", 4))
+                return(0);
+            u = sfstream_be64(b);
+            memcpy(&f->f_info.i_sr, &u, sizeof(double));
+            flags = sfstream_be32(b + 12);
+            bytes = sfstream_be32(b + 16);
+            f->f_info.i_nchans = (int)sfstream_be32(b + 24);
+            // same for 0 bytes per packet, which is also what variable sized packets use
+            if(f->f_info.i_nchans < 1 || bytes < (unsigned long)f->f_info.i_nchans
+            || bytes % f->f_info.i_nchans)
+                return(0);
+            f->f_bytes = (int)(bytes / f->f_info.i_nchans);
+            f->f_float = (flags & 1) != 0;
+            f->f_bigendian = !(flags & 2);
+            gotdesc = 1;
+        }
+        else if(!memcmp(b, "data", 4)){
+            if(!gotdesc)
+                return(0);
+            f->f_offset = pos + 16; // after the edit count
+            if(size < 0 || size - 4 > f->f_size - f->f_offset) // -1 runs to the end of the file
+                size = f->f_size - f->f_offset;
+            else
+                size -= 4;
+            f->f_info.i_nframes = size / (f->f_info.i_nchans * f->f_bytes);
+            return(1);
+        }
+        if(size < 0)
+            return(0);
+        pos += 12 + size;
+    }
+    return(0);
+}
+
+static void sfstream_closefile(t_sffile *f){
+    if(f->f_map){
+#ifdef _WIN32
+        UnmapViewOfFile(f->f_map);
+        CloseHandle(f->f_mapping);
+        CloseHandle(f->f_handle);
+#else
+        munmap(f->f_map, (size_t)f->f_size);
+#endif
+    }
+    if(f->f_fp)
+        fclose(f->f_fp);
+    if(f->f_buf)
+        freebytes(f->f_buf, (size_t)SFSTREAM_CHUNK * f->f_info.i_nchans * f->f_bytes);
+    freebytes(f, sizeof(*f));
+}
+
+// maps the whole file, only where the address space is large enough for any file
+static void sfstream_map(t_sffile *f, const char *path){
+    if(sizeof(void *) < 8 || f->f_size <= 0)
+        return;
+#ifdef _WIN32
+    {
+        wchar_t wpath[MAXPDSTRING];
+        if(!MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, MAXPDSTRING))
+            return;
+        f->f_handle = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, 0);
+        if(f->f_handle == INVALID_HANDLE_VALUE)
+            return;
+        f->f_mapping = CreateFileMappingW(f->f_handle, 0, PAGE_READONLY, 0, 0, 0);
+        if(f->f_mapping){
+            f->f_map = (unsigned char *)MapViewOfFile(f->f_mapping, FILE_MAP_READ, 0, 0, 0);
+            if(f->f_map)
+                return;
+            CloseHandle(f->f_mapping);
+        }
+        CloseHandle(f->f_handle);
+    }
+#else
+    {
+        void *map;
+        int fd = open(path, O_RDONLY);
+        if(fd < 0)
+            return;
+        map = mmap(0, (size_t)f->f_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if(map != MAP_FAILED){
+            f->f_map = (unsigned char *)map;
+#ifdef POSIX_MADV_SEQUENTIAL
+            posix_madvise(map, (size_t)f->f_size, POSIX_MADV_SEQUENTIAL);
+#endif
+        }
+    }
+#endif
+}
+
+static t_sffile *sfstream_openfile(const char *path, int usemap){
+    unsigned char b[12];
+    int ok = 0;
+    t_sffile *f;
+    FILE *fp = sys_fopen(path, "rb");
+    if(!fp)
+        return(0);
+    f = (t_sffile *)getbytes(sizeof(*f));
+    f->f_fp = fp;
+    if(!sfstream_fseek(fp, 0, SEEK_END))
+        f->f_size = sfstream_ftell(fp);
+    if(f->f_size >= 12 && sfstream_readat(fp, 0, b, 12)){
+        if((!memcmp(b, "RIFF", 4) || !memcmp(b, "RF64", 4)) && !memcmp(b + 8, "WAVE", 4))
+            ok = sfstream_wav(f, fp);
+        else if(!memcmp(b, "FORM", 4) && !memcmp(b + 8, "AIFF", 4))
+            ok = sfstream_aiff(f, fp, 0);
+        else if(!memcmp(b, "FORM", 4) && !memcmp(b + 8, "AIFC", 4))
+            ok = sfstream_aiff(f, fp, 1);
+        else if(!memcmp(b, "caff", 4))
+            ok = sfstream_caf(f, fp);
+    }
+    if(ok && f->f_float)
+        ok = (f->f_bytes == 4 || f->f_bytes == 8);
+    else if(ok)
+        ok = (f->f_bytes >= 1 && f->f_bytes <= 4);
+    if(ok)
+        ok = (f->f_info.i_nchans <= SFSTREAM_MAXCHANS && f->f_info.i_nframes >= 0);
+    if(!ok){
+        f->f_bytes = 0;
+        sfstream_closefile(f);
+        return(0);
+    }
+    if(usemap)
+        sfstream_map(f, path);
+    if(f->f_map){
+        fclose(f->f_fp);
+        f->f_fp = 0;
+    }
+    else
+        f->f_buf = (unsigned char *)getbytes((size_t)SFSTREAM_CHUNK * f->f_info.i_nchans * f->f_bytes);
+    return(f);
+}
+
+// ----------------------------------------------------------------------------------------
+// decoding
+
+static float sfstream_sample(const t_sffile *f, const unsigned char *p){
+    unsigned char b[8];
+    int i, n = f->f_bytes;
+    for(i = 0; i < n; i++) // most significant byte first
+        b[i] = f->f_bigendian ? p[i] : p[n - 1 - i];
+    if(f->f_float){
+        if(n == 4){
+            uint32_t u = (uint32_t)sfstream_be32(b);
+            float v;
+            memcpy(&v, &u, 4);
+            return(v);
+        }
+        else{
+            uint64_t u = sfstream_be64(b);
+            double v;
+            memcpy(&v, &u, 8);
+            return((float)v);
+        }
+    }
+    if(n == 1)
+        return((f->f_unsigned ? b[0] - 128 : (signed char)b[0]) * (1.f / 128.f));
+    else{
+        uint32_t u = (uint32_t)b[0] << 24 | (uint32_t)b[1] << 16
+            | (n > 2 ? (uint32_t)b[2] << 8 : 0) | (n > 3 ? b[3] : 0);
+        return((float)((double)(int32_t)u * (1. / 2147483648.)));
+    }
+}
+
+// frames of one chunk to s_nchans interleaved floats, missing channels are silent
+static int sfstream_read(t_sffile *f, long long chunk, float *dst, int nchans){
+    long long frame = chunk * SFSTREAM_CHUNK;
+    int fch = f->f_info.i_nchans, bytes = f->f_bytes, framebytes = fch * bytes;
+    int n, i, ch;
+    const unsigned char *src;
+    if(frame >= f->f_info.i_nframes)
+        return(0);
+    n = f->f_info.i_nframes - frame < SFSTREAM_CHUNK ? (int)(f->f_info.i_nframes - frame) : SFSTREAM_CHUNK;
+    if(f->f_map)
+        src = f->f_map + f->f_offset + frame * framebytes;
+    else{
+        if(sfstream_fseek(f->f_fp, f->f_offset + frame * framebytes, SEEK_SET))
+            return(0);
+        n = (int)(fread(f->f_buf, framebytes, n, f->f_fp));
+        src = f->f_buf;
+    }
+    for(i = 0; i < n; i++){
+        for(ch = 0; ch < nchans; ch++)
+            dst[ch] = ch < fch ? sfstream_sample(f, src + ch * bytes) : 0;
+        src += framebytes;
+        dst += nchans;
+    }
+    return(n);
+}
+
+// ----------------------------------------------------------------------------------------
+// reader thread
+
+static int sfstream_loadchunk(t_sfstream *s){
+    t_sfslot *slot = 0;
+    int i;
+    for(i = 0; i < SFSTREAM_NSLOTS; i++){ // the oldest request first
+        t_sfslot *sp = &s->s_slots[i];
+        if(sfstream_load(&sp->s_state) == SLOT_WANTED && (!slot || sp->s_seq < slot->s_seq))
+            slot = sp;
+    }
+    if(!slot)
+        return(0);
+    sfstream_store(&slot->s_state, SLOT_LOADING);
+    if(s->s_file && slot->s_gen == s->s_filegen)
+        slot->s_nframes = sfstream_read(s->s_file, slot->s_chunk, slot->s_data, s->s_nchans);
+    else // asked for with a file that is gone
+        slot->s_nframes = 0;
+    sfstream_store(&slot->s_state, SLOT_READY);
+    return(1);
+}
+
+static int sfstream_work(t_sfstream *s, char *request, int usemap){
+    if(request){
+        t_sffile *f = sfstream_openfile(request, usemap);
+        freebytes(request, strlen(request) + 1);
+        if(!f){
+            sfstream_store(&s->s_nfailed, sfstream_load(&s->s_nfailed) + 1);
+            return(1);
+        }
+        if(s->s_pending)
+            sfstream_closefile(s->s_pending);
+        s->s_pending = f;
+    }
+    if(s->s_pending && sfstream_load(&s->s_acked) == s->s_filegen){
+        if(s->s_file)
+            sfstream_closefile(s->s_file);
+        s->s_file = s->s_pending;
+        s->s_pending = 0;
+        s->s_info = s->s_file->f_info;
+        sfstream_store(&s->s_published, ++s->s_filegen);
+        return(1);
+    }
+    return(sfstream_loadchunk(s));
+}
+
+static void sfstream_abstime(struct timespec *ts, int ms){
+    long long ns;
+#ifdef _WIN32
+    struct __timeb64 tb;
+    _ftime64(&tb);
+    ts->tv_sec = tb.time;
+    ns = (long long)tb.millitm * 1000000 + (long long)ms * 1000000;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    ts->tv_sec = tv.tv_sec;
+    ns = (long long)tv.tv_usec * 1000 + (long long)ms * 1000000;
+#endif
+    ts->tv_sec += ns / 1000000000;
+    ts->tv_nsec = ns % 1000000000;
+}
+
+// serves the streams in turn, one open or one chunk each
+static void *sfstream_reader(void *dummy){
+    pthread_mutex_lock(&sfstream_mutex);
+    while(!sfstream_quit){
+        int worked = 0;
+        t_sfstream *s;
+        for(s = sfstream_list; s; s = s->s_next){
+            char *request = s->s_request;
+            int usemap = s->s_usemap;
+            s->s_request = 0;
+            s->s_busy = 1;
+            pthread_mutex_unlock(&sfstream_mutex);
+            worked |= sfstream_work(s, request, usemap);
+            pthread_mutex_lock(&sfstream_mutex);
+            s->s_busy = 0;
+            pthread_cond_broadcast(&sfstream_idle);
+        }
+        if(!worked && !sfstream_quit){
+            struct timespec ts;
+            sfstream_abstime(&ts, SFSTREAM_WAIT);
+            pthread_cond_timedwait(&sfstream_cond, &sfstream_mutex, &ts);
+        }
+    }
+    pthread_mutex_unlock(&sfstream_mutex);
+    return(dummy);
+}
+
+// ----------------------------------------------------------------------------------------
+// stream
+
+t_sfstream *sfstream_new(int nchans){
+    t_sfstream *s = (t_sfstream *)getbytes(sizeof(*s));
+    int i;
+    s->s_nchans = nchans < 1 ? 1 : nchans > SFSTREAM_MAXCHANS ? SFSTREAM_MAXCHANS : nchans;
+    for(i = 0; i < SFSTREAM_NSLOTS; i++)
+        s->s_slots[i].s_data = (float *)getbytes((size_t)SFSTREAM_CHUNK * s->s_nchans * sizeof(float));
+    pthread_mutex_lock(&sfstream_mutex);
+    s->s_next = sfstream_list;
+    sfstream_list = s;
+    if(!sfstream_running){
+        sfstream_quit = 0;
+        if(!pthread_create(&sfstream_thread, 0, sfstream_reader, 0))
+            sfstream_running = 1;
+        else
+            pd_error(0, "sfstream: couldn't start the reader thread");
+    }
+    pthread_mutex_unlock(&sfstream_mutex);
+    return(s);
+}
+
+void sfstream_free(t_sfstream *s){
+    t_sfstream **sp;
+    int i, join = 0;
+    pthread_mutex_lock(&sfstream_mutex);
+    while(s->s_busy)
+        pthread_cond_wait(&sfstream_idle, &sfstream_mutex);
+    for(sp = &sfstream_list; *sp; sp = &(*sp)->s_next){
+        if(*sp == s){
+            *sp = s->s_next;
+            break;
+        }
+    }
+    if(!sfstream_list && sfstream_running){ // last one, stop the reader
+        sfstream_quit = 1;
+        sfstream_running = 0;
+        pthread_cond_signal(&sfstream_cond);
+        join = 1;
+    }
+    pthread_mutex_unlock(&sfstream_mutex);
+    if(join)
+        pthread_join(sfstream_thread, 0);
+    if(s->s_request)
+        freebytes(s->s_request, strlen(s->s_request) + 1);
+    if(s->s_file)
+        sfstream_closefile(s->s_file);
+    if(s->s_pending)
+        sfstream_closefile(s->s_pending);
+    for(i = 0; i < SFSTREAM_NSLOTS; i++)
+        freebytes(s->s_slots[i].s_data, (size_t)SFSTREAM_CHUNK * s->s_nchans * sizeof(float));
+    freebytes(s, sizeof(*s));
+}
+
+void sfstream_open(t_sfstream *s, const char *path, int usemap){
+    char *request = (char *)getbytes(strlen(path) + 1);
+    strcpy(request, path);
+    pthread_mutex_lock(&sfstream_mutex);
+    if(s->s_request) // not picked up yet, only the last one counts
+        freebytes(s->s_request, strlen(s->s_request) + 1);
+    s->s_request = request;
+    s->s_usemap = usemap;
+    pthread_cond_signal(&sfstream_cond);
+    pthread_mutex_unlock(&sfstream_mutex);
+}
+
+int sfstream_update(t_sfstream *s){
+    int result = 0;
+    long gen = sfstream_load(&s->s_published), failed = sfstream_load(&s->s_nfailed);
+    if(gen != s->s_gen){
+        s->s_current = s->s_info;
+        s->s_gen = gen;
+        s->s_hasfile = 1;
+        sfstream_store(&s->s_acked, gen);
+        result |= SFSTREAM_OPENED;
+    }
+    if(failed != s->s_failed){
+        s->s_failed = failed;
+        result |= SFSTREAM_FAILED;
+    }
+    return(result);
+}
+
+const t_sfinfo *sfstream_info(t_sfstream *s){
+    return(s->s_hasfile ? &s->s_current : 0);
+}
+
+// loaded, or on its way, for the file in use
+static int sfstream_has(t_sfstream *s, t_sfslot *slot, long long chunk){
+    long state = sfstream_load(&slot->s_state);
+    if(state == SLOT_EMPTY || slot->s_chunk != chunk || slot->s_gen != s->s_gen)
+        return(0);
+    return(state != SLOT_READY || slot->s_nframes > 0);
+}
+
+void sfstream_schedule(t_sfstream *s, const long long *frames, int n){
+    long long want[SFSTREAM_NSLOTS];
+    int nwant = 0, asked = 0, i, j;
+    if(!s->s_hasfile)
+        return;
+    for(i = 0; i < n && nwant < SFSTREAM_NSLOTS; i++){
+        long long chunk;
+        if(frames[i] < 0 || frames[i] >= s->s_current.i_nframes)
+            continue;
+        chunk = frames[i] / SFSTREAM_CHUNK;
+        for(j = 0; j < nwant && want[j] != chunk; j++)
+            ;
+        if(j == nwant)
+            want[nwant++] = chunk;
+    }
+    for(i = 0; i < nwant; i++){
+        t_sfslot *victim = 0;
+        int keep;
+        for(j = 0; j < SFSTREAM_NSLOTS && !sfstream_has(s, &s->s_slots[j], want[i]); j++)
+            ;
+        if(j < SFSTREAM_NSLOTS)
+            continue;
+        // an empty slot or one of another file, else the oldest chunk that isn't wanted
+        for(j = 0; j < SFSTREAM_NSLOTS; j++){
+            t_sfslot *slot = &s->s_slots[j];
+            long state = sfstream_load(&slot->s_state);
+            int k;
+            if(state == SLOT_WANTED || state == SLOT_LOADING)
+                continue;
+            if(state == SLOT_EMPTY || slot->s_gen != s->s_gen){
+                victim = slot;
+                break;
+            }
+            for(k = keep = 0; k < nwant; k++)
+                keep |= (slot->s_chunk == want[k] && slot->s_nframes > 0);
+            if(!keep && (!victim || slot->s_seq < victim->s_seq))
+                victim = slot;
+        }
+        if(!victim) // all taken, the reader is behind
+            break;
+        victim->s_chunk = want[i];
+        victim->s_gen = s->s_gen;
+        victim->s_seq = ++s->s_seq;
+        sfstream_store(&victim->s_state, SLOT_WANTED);
+        asked = 1;
+    }
+    // never waits, the reader polls if it misses this
+    if(asked && !pthread_mutex_trylock(&sfstream_mutex)){
+        pthread_cond_signal(&sfstream_cond);
+        pthread_mutex_unlock(&sfstream_mutex);
+    }
+}
+
+const float *sfstream_frame(t_sfstream *s, long long frame){
+    long long chunk;
+    t_sfslot *slot;
+    int off, i;
+    if(frame < 0)
+        return(0);
+    chunk = frame / SFSTREAM_CHUNK;
+    off = (int)(frame - chunk * SFSTREAM_CHUNK);
+    slot = &s->s_slots[s->s_last];
+    if(sfstream_load(&slot->s_state) != SLOT_READY || slot->s_chunk != chunk || slot->s_gen != s->s_gen){
+        for(i = 0; i < SFSTREAM_NSLOTS; i++){
+            slot = &s->s_slots[i];
+            if(sfstream_load(&slot->s_state) == SLOT_READY && slot->s_chunk == chunk
+            && slot->s_gen == s->s_gen)
+                break;
+        }
+        if(i == SFSTREAM_NSLOTS)
+            return(0);
+        s->s_last = i;
+    }
+    if(off >= slot->s_nframes)
+        return(0);
+    return(slot->s_data + (size_t)off * s->s_nchans);
+}
@@ -0,0 +1,62 @@
+// sound file streaming for players that can't keep the whole file in an array
+
+// A stream keeps a few chunks of the file in memory, decoded to interleaved floats.
+// The player asks for the chunks around its play position every block with
+// sfstream_schedule() and reads frames with sfstream_frame(). One reader thread,
+// shared by all streams, loads the chunks in the order they were asked for.
+//
+// The player and the reader thread only hand slots over through their state, so the
+// audio side never waits for the disk: a frame that isn't loaded yet reads as missing
+// and the player reports an underrun.
+//
+// WAV (also RF64), AIFF/AIFC and CAF with 8 to 32 bit integer or 32/64 bit float samples.
+// The reader uses buffered reads or, if asked for, a memory mapping of the file.
+
+#ifndef __SFSTREAM_H__
+#define __SFSTREAM_H__
+
+#define SFSTREAM_CHUNK     16384 // frames per chunk
+#define SFSTREAM_NSLOTS    8     // chunks kept in memory per stream
+#define SFSTREAM_LOOKAHEAD 3     // chunks read ahead of the play position
+#define SFSTREAM_MAXCHANS  64
+
+// shared between the audio side and the reader thread, see sfstream.c
+typedef volatile long t_sfatomic;
+
+typedef struct _sfinfo{
+    int         i_nchans;   // channels of the file
+    long long   i_nframes;
+    double      i_sr;
+}t_sfinfo;
+
+typedef struct _sfslot{
+    t_sfatomic  s_state;    // see sfstream.c, decides which side may touch the slot
+    long long   s_chunk;
+    long        s_gen;      // file the chunk was asked for
+    long        s_seq;      // order of the requests
+    int         s_nframes;  // frames loaded, the last chunk of a file is shorter
+    float      *s_data;     // SFSTREAM_CHUNK frames of s_nchans
+}t_sfslot;
+
+typedef struct _sfstream t_sfstream;
+
+t_sfstream *sfstream_new(int nchans);
+// waits for the reader to finish with the stream, not for use in the audio thread
+void sfstream_free(t_sfstream *s);
+
+// asks the reader to open a file, the stream keeps the current file until that succeeded
+void sfstream_open(t_sfstream *s, const char *path, int usemap);
+
+// picks up what the reader did since the last call, from the audio side or a method
+#define SFSTREAM_OPENED 1 // a new file is in use
+#define SFSTREAM_FAILED 2 // a file couldn't be opened, the previous one stays
+int sfstream_update(t_sfstream *s);
+const t_sfinfo *sfstream_info(t_sfstream *s); // 0 while no file is open
+
+// asks for the chunks holding these frames, most urgent first
+void sfstream_schedule(t_sfstream *s, const long long *frames, int n);
+
+// s_nchans samples of a frame, 0 if its chunk isn't loaded
+const float *sfstream_frame(t_sfstream *s, long long frame);
+
+#endif
@@ -17,14 +17,15 @@
    changed new method to accept list rather that defsym and deffloat
     NOTE: I've written the bufrd so that it only uses [0, npoints) which makes overwriting the sample that drops
     off the moving average easier, but this won't work if you want to resize the buffer and not clear it
-    also, averages are over npoints always, even if there are less than npoints accumulated so far */
+    also, averages are over npoints always, even if there are less than npoints accumulated so far
+   the moving sum now lives in Libraries/shared/runstat.c, also used by ELSE's [mov.avg~] and [mov.rms~] */
 
 #include <stdlib.h>
 #include <math.h>
 #include "m_pd.h"
 #include <common/api.h>
+#include "runstat.h"
 
-#define AVERAGE_STACK    44100 //stack value
 #define AVERAGE_MAXBUF  882000 //max buffer size
 #define AVERAGE_DEFNPOINTS  100  /* CHECKME */
 #define AVERAGE_DEFMODE     AVERAGE_BIPOLAR
@@ -35,108 +36,25 @@ typedef struct _average
     t_object    x_obj;
     t_inlet    *x_inlet1;
     int         x_mode;
-    double      (*x_sumfn)(double, double, int);
-    unsigned int         x_count; //number of samples seen so far, will no go beyond x_npoints + 1
-    unsigned int         x_npoints; //number of samples for moving average
-    double     x_accum; //sum
-    double	   x_calib; //accumulator calibrator
-    double      *x_buf; //buffer pointer
-    double     x_stack[AVERAGE_STACK]; //buffer
-    int         x_alloc; //if x_buf is allocated or stack
-    unsigned int    x_sz; //allocated size for x_buf
-    unsigned int    x_bufrd; //readhead for buffer
+    t_runstat   x_stat; //last x_max inputs and the sum of the last npoints
     unsigned int         x_max; //max size of buffer as specified by argt
 } t_average;
 
 static t_class *average_class;
 
-static void average_zerobuf(t_average *x){
-
-    unsigned int i;
-    for(i=0; i < x->x_sz; i++){
-        x->x_buf[i] = 0.;
-    };
-}
-
 static void average_reset(t_average * x){
     //clear buffer and reset everything to 0
-    x->x_count = 0;
-    x->x_accum = 0;
-    x->x_bufrd = 0;
-    average_zerobuf(x);
+    runstat_clear(&x->x_stat);
 };
 
-static void average_sz(t_average *x, unsigned int newsz){
-    //helper function to deal with allocation issues if needed
-    int alloc = x->x_alloc;
-    unsigned int cursz = x->x_sz; //current size
-    //requested size
-    if(newsz < 0){
-        newsz = 0;
-    }
-    else if(newsz > AVERAGE_MAXBUF){
-        newsz = AVERAGE_MAXBUF;
-    };
-    if(!alloc && newsz > AVERAGE_STACK){
-        x->x_buf = (double *)malloc(sizeof(double)*newsz);
-        x->x_alloc = 1;
-        x->x_sz = newsz;
-    }
-    else if(alloc && newsz > cursz){
-        x->x_buf = (double *)realloc(x->x_buf, sizeof(double)*newsz);
-        x->x_sz = newsz;
-    }
-    else if(alloc && newsz < AVERAGE_STACK){
-        free(x->x_buf);
-        x->x_sz = AVERAGE_STACK;
-        x->x_buf = x->x_stack;
-        x->x_alloc = 0;
-    };
-    average_reset(x);
-}
-
-
-static double average_bipolarsum(double input, double accum, int add)
-{
-    if(add){
-        accum += input;
-    }
-    else{
-        accum -= input;
-    };
-    return (accum);
-}
-
-static double average_absolutesum(double input, double accum, int add)
-{
-    if(add){
-        accum += (input >= 0 ? input : -input);
-    }
-    else{
-        accum -= (input >= 0 ? input : -input);
-    };
-    return (accum);
-}
-
-static double average_rmssum(double input, double accum, int add)
-{
-    if(add){
-        accum += (input * input);
-    }
-    else{
-        accum -= (input * input);
-    };
-    return (accum);
-}
-
 static void average_setmode(t_average *x, int mode)
 {
     if (mode == AVERAGE_BIPOLAR)
-	x->x_sumfn = average_bipolarsum;
+	runstat_mode(&x->x_stat, RUNSTAT_BIPOLAR);
     else if (mode == AVERAGE_ABSOLUTE)
-	x->x_sumfn = average_absolutesum;
+	runstat_mode(&x->x_stat, RUNSTAT_ABSOLUTE);
     else if (mode == AVERAGE_RMS)
-	x->x_sumfn = average_rmssum;
+	runstat_mode(&x->x_stat, RUNSTAT_SQUARE);
     x->x_mode = mode;
     average_reset(x);
 }
@@ -150,7 +68,7 @@ static void average_float(t_average *x, t_float f)
         if(i >= x->x_max){
             i = x->x_max;
         };
-	x->x_npoints = i;
+	runstat_window(&x->x_stat, i);
         average_reset(x);
     }
 }
@@ -176,68 +94,10 @@ static t_int *average_perform(t_int *w)
     int nblock = (int)(w[2]);
     t_float *in = (t_float *)(w[3]);
     t_float *out = (t_float *)(w[4]);
-    double (*sumfn)(double, double, int) = x->x_sumfn;
-    int i;
-    unsigned int npoints = x->x_npoints;
-    for(i=0; i <nblock; i++){
-        double result; //eventual result
-        double input = (double)in[i];
-        if(npoints > 1)
-        {
-            unsigned int bufrd = x->x_bufrd;
-            //add input to accumulator
-            x->x_accum = (*sumfn)(input, x->x_accum, 1);
-            x->x_calib = (*sumfn)(input, x->x_calib, 1);
-            unsigned int count = x->x_count;
-            if(count < npoints){
-                //update count
-                count++;
-                x->x_count = count;
-            }
-            else{
-                //start subtracting from the accumulator the sample that drops off the moving sum
-
-                /*say npoints = 2, then when bufrd = 1, 0 and 1 are the accum, then when bufrd = 2, 1 and 2 should be the accum
-                  so you subtract 0 from accum and add 2 and 0 = bufrd - npoints
-                  if we are only using npoints of the x_buf, then bufrd will be the value we want to subtract
-                */
-            
-                //subtract current value in bufrd's location from accum
-                x->x_accum = (*sumfn)(x->x_buf[bufrd], x->x_accum, 0);
-
-            };
-
-            //overwrite/store current input value into buf
-            x->x_buf[bufrd] = input;
- 
-
-            //calculate result
-            result = x->x_accum/(double)npoints;
-            if (x->x_mode == AVERAGE_RMS)
-                result = sqrt(result);           
-            
-            //incrementation step
-            bufrd++;
-            if(bufrd >= npoints){
-                bufrd = 0;
-                x->x_accum = x->x_calib;
-                x->x_calib = 0.0;
-            };
-            x->x_bufrd = bufrd;
-
-        }
-        else{
-            //npoints = 1, just pass through (or absolute)
-            if(x->x_mode == AVERAGE_ABSOLUTE || x->x_mode == AVERAGE_RMS){
-                result = fabs(input);
-            }
-            else{
-                result = input;
-            };
-        };
-        out[i] = result;
-    };
-
+    /* npoints = 1 passes through, the absolute value for absolute and rms */
+    runstat_perform(&x->x_stat, nblock, in, 0, out);
+    if (x->x_mode == AVERAGE_RMS)
+        runstat_output(&x->x_stat, nblock, RUNSTAT_ROOT, out);
     return (w + 5);
 }
 
@@ -248,9 +108,7 @@ static void average_dsp(t_average *x, t_signal **sp)
 
 static void average_free(t_average *x)
 {
-    if(x->x_alloc){
-        free(x->x_buf);
-    };
+    runstat_free(&x->x_stat);
 }
 
 static void *average_new(t_symbol *s, int argc, t_atom * argv)
@@ -259,10 +117,6 @@ static void *average_new(t_symbol *s, int argc, t_atom * argv)
     int mode;
     t_symbol * modename = &s_;
     unsigned int maxbuf = AVERAGE_DEFNPOINTS; //default for max buf size
-    //default to stack for now...
-    x->x_buf = x->x_stack; 
-    x->x_alloc = 0;
-    x->x_sz = AVERAGE_STACK;
 
     while(argc){
         if(argv -> a_type == A_FLOAT){
@@ -279,8 +133,16 @@ static void *average_new(t_symbol *s, int argc, t_atom * argv)
     /* CHECKED it looks like memory is allocated for the entire window,
        in tune with the refman's note about ``maximum averaging interval'' --
        needed for dynamic control over window size, or what? LATER rethink */
-    x->x_npoints = (maxbuf > 0 ? maxbuf : 1);
-    x->x_max = x->x_npoints; //designated max of average buffer
+    if (maxbuf > AVERAGE_MAXBUF)
+        maxbuf = AVERAGE_MAXBUF;
+    x->x_max = (maxbuf > 0 ? maxbuf : 1); //designated max of average buffer
+    runstat_init(&x->x_stat, RUNSTAT_BIPOLAR);
+    if (!runstat_resize(&x->x_stat, x->x_max))
+    {
+        pd_error(x, "average~: couldn't allocate %u samples", x->x_max);
+        return (0);
+    }
+    runstat_window(&x->x_stat, x->x_max);
     if (modename == gensym("bipolar"))
 	mode = AVERAGE_BIPOLAR;
     else if (modename == gensym("absolute"))
@@ -293,9 +155,6 @@ static void *average_new(t_symbol *s, int argc, t_atom * argv)
 	/* CHECKME a warning if (s && s != &s_) */
     }
     average_setmode(x, mode);
-
-    //now allocate x_buf if necessary
-    average_sz(x, x->x_npoints);
     /* CHECKME if not x->x_phase = 0 */
     outlet_new((t_object *)x, &s_signal);
     return (x);
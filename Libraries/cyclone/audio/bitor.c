@@ -6,6 +6,7 @@
 #include "m_pd.h"
 #include <common/api.h>
 #include "common/magicbit.h"
+#include "binop.h"
 
 //EXTERN t_float *obj_findsignalscalar(t_object *x, int m);
 
@@ -34,81 +35,33 @@ static void bitor_intmask(t_bitor *x, t_floatarg f)
 	pd_float(x->x_rightinlet, (t_float)x->x_mask);
 }
 
+// the kernel for each mode, see binop.h
+static const t_binop bitor_kernels[4] =
+{
+    binop_bitor_bits, binop_bitor, binop_bitor_bitsint, binop_bitor_intbits
+};
+
 static t_int *bitor_perform(t_int *w)
 {
     t_bitor *x = (t_bitor *)(w[1]);
-    int nblock = (int)(w[2]);
-    t_float *in1 = (t_float *)(w[3]);
-    t_float *in2 = (t_float *)(w[4]);
-    t_float *out = (t_float *)(w[5]);
-    t_i32_fl left, right, result;
-    switch (x->x_mode)
-    {
-        case 0:	while (nblock--)  // treat inputs as float
-        {
-        left.if_float = *in1++;
-        right.if_float = *in2++;
-        result.if_int32 = left.if_int32 | right.if_int32;
-        if (BITWISE_ISDENORM(result.if_float))
-        	*out++ = 0;
-        else
-            *out++ = result.if_float;
-        }
-        break;
-        case 1: while (nblock--) // convert inputs to int
-    	{ 
-    	int32_t i = ((int32_t)*in1++) | ((int32_t)*in2++);
-    	*out++ = (t_float)i;
-        }
-        break;
-        case 2: while (nblock--) // right input as int
-        {
-        left.if_float = *in1++;
-        result.if_int32 = left.if_int32 | ((int32_t)*in2++);
-        if (BITWISE_ISDENORM(result.if_float))
-        	*out++ = 0;
-        else
-            *out++ = result.if_float;
-        }
-        break;
-        case 3: while (nblock--) // left input as int
-        {
-        right.if_float = *in2++;
-        int32_t i = ((int32_t)*in1++) | right.if_int32;
-        *out++ = (t_float)i;
-        }
-	break;
-    }
+    bitor_kernels[x->x_mode]((int)(w[2]), (t_float *)(w[3]), (t_float *)(w[4]),
+        (t_float *)(w[5]));
     return (w + 6);
 }
 
 static t_int *bitor_perform_noin2(t_int *w)
-{ // LATER think about performance
+{
     t_bitor *x = (t_bitor *)(w[1]);
-    int nblock = (int)(w[2]);
-    t_float *in = (t_float *)(w[3]);
-    t_float *out = (t_float *)(w[4]);
-    t_i32_fl left, result;
     int32_t mask = x->x_mask;
     t_float inmask = *x->x_signalscalar;
     if (!magic_isnan(inmask) && mask != (int32_t)inmask)
     {
-    	bitor_intmask(x, inmask);
+        bitor_intmask(x, inmask);
     }
     if (x->x_convert1)
-    while (nblock--)
-        { int32_t i = ((int32_t)*in++) | mask;
-        	*out++ = (t_float)i;
-        }
-    else while (nblock--)
-        { 
-          left.if_float = *in++;
-          result.if_int32 = left.if_int32 | mask;
-          if (BITWISE_ISDENORM(result.if_float))
-        	*out++ = 0;
-          else
-            *out++ = result.if_float;
-        }
+        binop_bitor_mask((int)(w[2]), (t_float *)(w[3]), mask, (t_float *)(w[4]));
+    else
+        binop_bitor_bits_mask((int)(w[2]), (t_float *)(w[3]), mask, (t_float *)(w[4]));
     return (w + 5);
 }
 
@@ -6,9 +6,12 @@
 #include "m_pd.h"
 #include <common/api.h>
 #include "signal/cybuf.h"
+#include "signal/convolver.h"
 
 #define BUFFIR_DEFSIZE    0
 #define BUFFIR_MAXSIZE  4096
+/* use the fft convolver above this many taps per block size */
+#define BUFFIR_FFTRATIO    2
 
 typedef struct _buffir
 {
@@ -22,6 +25,8 @@ typedef struct _buffir
     t_float *x_histhi;
     t_float  x_histbuf[2 * BUFFIR_MAXSIZE];
     int      x_checked;
+    t_convolver x_conv;
+    int      x_convactive;  /* delay line of x_conv is up to date */
 } t_buffir;
 
 static t_class *buffir_class;
@@ -45,6 +50,7 @@ static void buffir_clear(t_buffir *x)
     memset(x->x_histlo, 0, 2 * BUFFIR_MAXSIZE * sizeof(*x->x_histlo));
     x->x_lohead = x->x_histlo;
     x->x_hihead = x->x_histhi = x->x_histlo + BUFFIR_MAXSIZE;
+    x->x_convactive = 0;
 }
 
 static void buffir_set(t_buffir *x, t_symbol *s, t_floatarg f1, t_floatarg f2)
@@ -59,6 +65,68 @@ static void buffir_float(t_buffir *x, t_float f)
     pd_error(x, "buffir~: no method for 'float'");
 }
 
+    /* if offset and size are the same for the whole block, returns
+       the number of taps to use, clipped to the table */
+static int buffir_blockconstant(t_float *oin, t_float *sin, int nblock,
+    int bufnpts, int *offp)
+{
+    int off = (int)oin[0], npoints = (int)sin[0], i;
+    for (i = 1; i < nblock; i++)
+        if ((int)oin[i] != off || (int)sin[i] != npoints)
+            return (0);
+    if (off < 0)
+        off = 0;
+    if (npoints > BUFFIR_MAXSIZE)
+        npoints = BUFFIR_MAXSIZE;
+    if (npoints > bufnpts - off)
+        npoints = bufnpts - off;
+    *offp = off;
+    return (npoints > 0 ? npoints : 0);
+}
+
+    /* long filters with constant offset and size go through the
+       partitioned convolver, same output but far less work per sample */
+static int buffir_performfft(t_buffir *x, int nblock, t_float *xin,
+    t_float *oin, t_float *sin, t_float *out)
+{
+    t_cybuf *c = x->x_cybuf;
+    t_float *lohead = x->x_lohead;
+    t_float *hihead = x->x_hihead;
+    int off, npoints, i;
+    if (x->x_conv.c_blocksize != nblock)
+        return (0);
+    npoints = buffir_blockconstant(oin, sin, nblock, c->c_npts, &off);
+    if (npoints <= BUFFIR_FFTRATIO * nblock)
+    {
+        x->x_convactive = 0;
+        return (0);
+    }
+        /* before touching the history, which may share memory with out */
+    if (c->c_fvectors[0])
+        convolver_update_float(&x->x_conv, c->c_fvectors[0] + (size_t)off * c->c_stride,
+            c->c_stride, npoints);
+    else convolver_update(&x->x_conv, c->c_vectors[0] + off, npoints);
+    if (!x->x_convactive)
+    {
+        convolver_prime(&x->x_conv, hihead - BUFFIR_MAXSIZE, BUFFIR_MAXSIZE);
+        x->x_convactive = 1;
+    }
+        /* keep the history going, so we can switch back at any time */
+    for (i = 0; i < nblock; i++)
+    {
+        *lohead++ = *hihead++ = xin[i];
+        if (lohead >= x->x_histhi)
+        {
+            lohead = x->x_histlo;
+            hihead = x->x_histhi;
+        }
+    }
+    x->x_lohead = lohead;
+    x->x_hihead = hihead;
+    convolver_perform(&x->x_conv, xin, out);
+    return (1);
+}
+
 static t_int *buffir_perform(t_int *w)
 {
     t_buffir *x = (t_buffir *)(w[1]);
@@ -68,6 +136,9 @@ static t_int *buffir_perform(t_int *w)
     t_float *lohead = x->x_lohead;
     t_float *hihead = x->x_hihead;
     t_cybuf *c = x->x_cybuf;
+    if (c->c_playable && buffir_performfft(x, nblock, xin,
+        (t_float *)(w[4]), (t_float *)(w[5]), out))
+        return (w + 7);
     if (c->c_playable)
     {	
 
@@ -75,6 +146,8 @@ static t_int *buffir_perform(t_int *w)
 	t_float *sin = (t_float *)(w[5]);
 	int bufnpts = c->c_npts;
 	t_word *vec = c->c_vectors[0];  /* playable implies nonzero (mono) */
+	float *fvec = c->c_fvectors[0]; /* ... or this one, with a sample pool */
+	int stride = c->c_stride;
 	while (nblock--)
 	{
 
@@ -99,7 +172,10 @@ static t_int *buffir_perform(t_int *w)
 		t_float *hp = hihead;
 		t_float sum = 0.;
 		*lohead++ = *hihead++ = *xin++;
-		while (npoints--)
+		if (fvec)
+		    while (npoints--)
+			sum += fvec[(size_t)off++ * stride] * *hp--;
+		else while (npoints--)
 			sum += coefp[off++].w_float * *hp--;
 			//sum += coefp->w_float * *hp--;
 		*out++ = sum;
@@ -135,6 +211,8 @@ static void buffir_dsp(t_buffir *x, t_signal **sp)
 {
 	x->x_checked = 0;
     cybuf_checkdsp(x->x_cybuf); 
+    convolver_setup(&x->x_conv, sp[0]->s_n, BUFFIR_MAXSIZE);
+    x->x_convactive = 0;
     dsp_add(buffir_perform, 6, x, sp[0]->s_n, sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec, sp[3]->s_vec);
 }
 
@@ -143,6 +221,7 @@ static void buffir_free(t_buffir *x)
     inlet_free(x->x_offlet);
     inlet_free(x->x_sizlet);
     cybuf_free(x->x_cybuf);
+    convolver_free(&x->x_conv);
 }
 
 static void *buffir_new(t_symbol *s, t_floatarg f1, t_floatarg f2)
@@ -153,6 +232,7 @@ static void *buffir_new(t_symbol *s, t_floatarg f1, t_floatarg f2)
     x->x_cybuf = cybuf_init((t_class *)x, s, 1, 0);
     if (x->x_cybuf)
     {
+	cybuf_usepool(x->x_cybuf);
 	
 	
         x->x_offlet = inlet_new(&x->x_obj, &x->x_obj.ob_pd, &s_signal, &s_signal);
@@ -164,6 +244,8 @@ static void *buffir_new(t_symbol *s, t_floatarg f1, t_floatarg f2)
 	x->x_histlo = x->x_histbuf;
 	x->x_histhi = x->x_histbuf+BUFFIR_MAXSIZE;
 	x->x_checked = 0;
+	convolver_init(&x->x_conv);
+	x->x_convactive = 0;
 	buffir_clear(x);
 	buffir_setrange(x, f1, f2);
     }
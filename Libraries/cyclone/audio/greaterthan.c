@@ -2,6 +2,8 @@
 
 #include "m_pd.h"
 #include <common/api.h>
+#include "common/magicbit.h"
+#include "binop.h"
 
 // ---------------------------------------------------
 // Class definition
@@ -15,6 +17,8 @@ typedef struct _greaterthan
 {
     t_object x_obj;
     t_inlet  *x_inlet;
+    t_glist  *x_glist;
+    t_float  *x_signalscalar; // right inlet's float field
 } t_greaterthan;
 
 // ---------------------------------------------------
@@ -22,16 +26,14 @@ typedef struct _greaterthan
 // ---------------------------------------------------
 static t_int *greaterthan_perform(t_int *w)
 {
-    int nblock = (int)(w[1]);
-    t_float *in1 = (t_float *)(w[2]);
-    t_float *in2 = (t_float *)(w[3]);
-    t_float *out = (t_float *)(w[4]);
-    while (nblock--)
-    {
-        t_float f1 = *in1++;
-        t_float f2 = *in2++;
-        *out++ = (f1 > f2);
-    }
+    binop_gt((int)(w[1]), (t_float *)(w[2]), (t_float *)(w[3]), (t_float *)(w[4]));
+    return (w + 5);
+}
+
+static t_int *greaterthan_perform_scalar(t_int *w)
+{
+    t_float *scalar = (t_float *)(w[2]);
+    binop_gt_scalar((int)(w[1]), (t_float *)(w[3]), *scalar, (t_float *)(w[4]));
     return (w + 5);
 }
 
@@ -40,8 +42,12 @@ static t_int *greaterthan_perform(t_int *w)
 // ---------------------------------------------------
 static void greaterthan_dsp(t_greaterthan *x, t_signal **sp)
 {
-    dsp_add(greaterthan_perform, 4, sp[0]->s_n,
+    if (magic_inlet_connection((t_object *)x, x->x_glist, 1, &s_signal))
+        dsp_add(greaterthan_perform, 4, sp[0]->s_n,
             sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec);
+    else  // no signal, use the float
+        dsp_add(greaterthan_perform_scalar, 4, sp[0]->s_n,
+            x->x_signalscalar, sp[0]->s_vec, sp[2]->s_vec);
 }
 
 // FREE
@@ -60,6 +66,8 @@ static void *greaterthan_new(t_floatarg f)
     x->x_inlet = inlet_new((t_object *)x, (t_pd *)x, &s_signal, &s_signal);
     pd_float((t_pd *)x->x_inlet, f);
     outlet_new((t_object *)x, &s_signal);
+    x->x_glist = canvas_getcurrent();
+    x->x_signalscalar = obj_findsignalscalar((t_object *)x, 1);
     return (x);
 }
 
@@ -6,6 +6,8 @@
 
 #include "m_pd.h"
 #include <common/api.h>
+#include "common/magicbit.h"
+#include "binop.h"
 
 typedef struct _minimum {
     t_object    x_obj;
@@ -13,29 +15,33 @@ typedef struct _minimum {
     t_inlet    *x_inlet1;  // main 1st inlet
     t_inlet    *x_inlet2;  // 2nd inlet
     t_outlet   *x_outlet;
+    t_glist    *x_glist;
+    t_float    *x_signalscalar; // right inlet's float field
 } t_minimum;
 
 static t_class *minimum_class;
 
 static t_int *minimum_perform(t_int *w)
 {
-    int nblock = (int)(w[1]);
-    t_float *in1 = (t_float *)(w[2]);
-    t_float *in2 = (t_float *)(w[3]);
-    t_float *out = (t_float *)(w[4]);
-    while (nblock--)
-    {
-	t_float f1 = *in1++;
-	t_float f2 = *in2++;
-	*out++ = (f1 < f2 ? f1 : f2);
-    }
+    binop_min((int)(w[1]), (t_float *)(w[2]), (t_float *)(w[3]), (t_float *)(w[4]));
+    return (w + 5);
+}
+
+static t_int *minimum_perform_scalar(t_int *w)
+{
+    t_float *scalar = (t_float *)(w[2]);
+    binop_min_scalar((int)(w[1]), (t_float *)(w[3]), *scalar, (t_float *)(w[4]));
     return (w + 5);
 }
 
 static void minimum_dsp(t_minimum *x, t_signal **sp)
 {
-    dsp_add(minimum_perform, 4, sp[0]->s_n,
-	    sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec);
+    if (magic_inlet_connection((t_object *)x, x->x_glist, 1, &s_signal))
+        dsp_add(minimum_perform, 4, sp[0]->s_n,
+            sp[0]->s_vec, sp[1]->s_vec, sp[2]->s_vec);
+    else  // no signal, use the float
+        dsp_add(minimum_perform_scalar, 4, sp[0]->s_n,
+            x->x_signalscalar, sp[0]->s_vec, sp[2]->s_vec);
 }
 
 static void *minimum_new(t_floatarg f)
@@ -44,6 +50,8 @@ static void *minimum_new(t_floatarg f)
     x->x_inlet2 = inlet_new((t_object *)x, (t_pd *)x, &s_signal, &s_signal);
     pd_float((t_pd *)x->x_inlet2, f);
     outlet_new((t_object *)x, &s_signal);
+    x->x_glist = canvas_getcurrent();
+    x->x_signalscalar = obj_findsignalscalar((t_object *)x, 1);
     return (x);
 }
 
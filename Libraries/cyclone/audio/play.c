@@ -15,6 +15,7 @@
 #include "m_pd.h"
 #include <common/api.h>
 #include "signal/cybuf.h"
+#include "sampleplay.h"
 #include "common/magicbit.h"
 #include "common/shared.h"
 
@@ -62,6 +63,7 @@ typedef struct _play
     int 	x_numchans;
     t_float     *x_ivec; // input vector
     t_float     **x_ovecs; //output vectors
+    t_sampleplay x_play;
 
     t_outlet    *x_donelet;
 } t_play;
@@ -296,45 +298,6 @@ static void play_loopinterp(t_play *x, t_floatarg f){
     x->x_linterp = f > 0 ? 1 : 0;
 }
 
-static double play_getvecval(t_play *x, int chidx, double phase, int interp){
-    int ndx;
-    double output;
-    t_word **vectable = x->x_cybuf->c_vectors;
-    int npts = x->x_npts;
-    int maxindex = (interp ? npts - 3 : npts - 1);
-    if (phase < 0 || phase > maxindex)
-        phase = 0;  /* CHECKED: a value 0, not ndx 0 */
-    ndx = (int)phase;
-    float frac,  a,  b,  c,  d, cminusb;
-    /* CHECKME: what kind of interpolation? (CHECKED: multi-point) */
-    if (ndx < 1)
-        ndx = 1, frac = 0;
-    else if (ndx > maxindex)
-        ndx = maxindex, frac = 1;
-    else frac = phase - ndx;
-    t_word *vp = vectable[chidx];
-    if (vp)
-    {
-        vp += ndx;
-        a = vp[-1].w_float;
-        b = vp[0].w_float;
-        c = vp[1].w_float;
-        d = vp[2].w_float;
-        cminusb = c-b;
-        output = b + frac * (
-            cminusb - 0.1666667f * (1. - frac) * (
-                (d - a - 3.0f * cminusb) * frac
-                + (d + 2.0f * a - 3.0f * b)
-            )
-        );
-    }
-    else output = 0;
-
-    return output;
-
-}
-
-/* LATER optimize */
 static t_int *play_perform(t_int *w)
 {
     t_play *x = (t_play *)(w[1]);
@@ -342,12 +305,13 @@ static t_int *play_perform(t_int *w)
     int nblock = (int)(w[2]);
     int nch = x->x_numchans;
     int chidx; //channel index
-    if (cybuf->c_playable)
+    if (cybuf->c_playable && x->x_play.s_maxn >= nblock)
     {	
         float pdksr = x->x_pdksr;
-        int interp = 1;
         int iblock;
 
+        //transport first, then the reads for all channels at once
+        sampleplay_begin(&x->x_play);
         if(x->x_hasfeeders){
             //signal input present, indexing into array
             t_float *xin = x->x_ivec;
@@ -355,18 +319,16 @@ static t_int *play_perform(t_int *w)
             for (iblock = 0; iblock < nblock; iblock++)
             {
                 float phase = *xin++ * pdksr; // converts input in ms to samples!
-            for(chidx=0; chidx<nch; chidx++){
-                t_float *out = *(x->x_ovecs+chidx);
-                out[iblock] = play_getvecval(x, chidx, phase, interp);
-                };
+                sampleplay_add(&x->x_play, SAMPLEPLAY_READ, phase, 1, 0, 0);
             };
         }
         else{
             //no signal input present, auto playback mode
             if(x->x_playing){
                 //post("%f", x->x_phase);
-                double output;
                 double gain;
+                //like gain, these keep their value after the ramp for the rest of the block
+                double fadephase = 0, fadegain = 0;
                 int npts = x->x_npts;
                 int stsamp = x->x_stsamp;
                 int endsamp = x->x_endsamp;
@@ -388,7 +350,6 @@ static t_int *play_perform(t_int *w)
                 //let's handle this in two cases, forwards playing (isneg == 0), backwards playing (isneg == 1)
                 for (iblock = 0; iblock < nblock; iblock++){
                     double phase = x->x_phase;
-                    double fadephase, fadegain;
                     if(isneg){
 
                     //[0---endxsamp---endsamp----stxsamp----stsamp----npts]
@@ -495,28 +456,19 @@ static t_int *play_perform(t_int *w)
                     }; 
                         //reading output vals (for both forwards and backwards)
                         int rfirst = x->x_rfirst;
-                        
-                            for(chidx =0; chidx<nch;chidx++){
-                                t_float *out = *(x->x_ovecs+chidx);
-                                //get current val
-                                if(x->x_playing){
-                                    output = play_getvecval(x, chidx, phase, interp);
-                                    if(ramping){
-                                        output *= gain;
-                                        if(!rfirst){
-                                            //if not the first ramp, need the fading out ramp
-                                            double out2 = play_getvecval(x, chidx, fadephase, interp);
-                                            out2 *= fadegain;
-                                            output += out2;
-                                        };
-                                    };
-                                }
-                                else{
-                                    output = 0.;
-                                };
-                                out[iblock] = output;
-
-                             };
+                        if(!x->x_playing){
+                            sampleplay_add(&x->x_play, SAMPLEPLAY_SILENT, 0, 0, 0, 0);
+                        }
+                        else if(!ramping){
+                            sampleplay_add(&x->x_play, SAMPLEPLAY_READ, phase, 1, 0, 0);
+                        }
+                        else if(rfirst){
+                            sampleplay_add(&x->x_play, SAMPLEPLAY_FADE, phase, gain, 0, 0);
+                        }
+                        else{
+                            //if not the first ramp, need the fading out ramp
+                            sampleplay_add(&x->x_play, SAMPLEPLAY_XFADE, phase, gain, fadephase, fadegain);
+                        };
                         //incrementation time (for both forwards and backwards)!
                             x->x_phase = phase + x->x_ksrrat*x->x_rate;
                     };
@@ -527,6 +479,7 @@ static t_int *play_perform(t_int *w)
             };
 
         };
+        sampleplay_perform(&x->x_play, cybuf->c_vectors, cybuf->c_fvectors, cybuf->c_stride, x->x_npts, x->x_ovecs, nch);
     }
     else
     {
@@ -557,6 +510,8 @@ static void play_dsp(t_play *x, t_signal **sp)
 
     };
     int i, nblock = sp[0]->s_n;
+    if(!sampleplay_setup(&x->x_play, nblock))
+        pd_error(x, "play~: out of memory");
 
     t_signal **sigp = sp;
     x->x_ivec = (*sigp++)->s_vec;
@@ -571,6 +526,7 @@ static void play_dsp(t_play *x, t_signal **sp)
 static void *play_free(t_play *x)
 {
     cybuf_free(x->x_cybuf);
+    sampleplay_free(&x->x_play);
     freebytes(x->x_ovecs, x->x_numchans * sizeof(*x->x_ovecs));
     outlet_free(x->x_donelet);
     return (void *)x;
@@ -629,6 +585,7 @@ static void *play_new(t_symbol * s, int argc, t_atom * argv){
     int chn_n = (int)channels > 64 ? 64 : (int)channels;
 
     t_play *x = (t_play *)pd_new(play_class);
+    sampleplay_init(&x->x_play, 0.1666667f, 0);
     x->x_glist = canvas_getcurrent();
     x->x_hasfeeders = 0;
     x->x_pdksr = (float)sys_getsr() * 0.001;
@@ -640,6 +597,7 @@ static void *play_new(t_symbol * s, int argc, t_atom * argv){
     if (c)
     {
         int nch = c->c_numchans;
+        cybuf_usepool(c);
         x->x_npts = c->c_npts;
         x->x_numchans = nch;
         x->x_ovecs = getbytes(x->x_numchans * sizeof(*x->x_ovecs));
@@ -98,15 +98,18 @@ static void poke_redraw_lim(t_poke *x)
 static void poke_float(t_poke *x, t_float f)
     {
     t_cybuf *c = x->x_cybuf;
-    t_word *vp = c->c_vectors[0];
+    t_word *vp;
+    float *fp;
     //second arg is to allow error posting
     cybuf_validate(c, 1);  // LATER rethink (efficiency, and complaining)
-    if (vp)
+    vp = c->c_vectors[0];
+    fp = c->c_fvectors[0];
+    if (vp || fp)
         {
         int index = (int)*x->x_indexptr;
         if (index >= 0 && index < c->c_npts)
             {
-            vp[index].w_float = f;
+            CYBUF_SETSAMPLE(vp, fp, c->c_stride, index, f);
             poke_redraw_lim(x);
             };
         }
@@ -138,15 +141,17 @@ static t_int *poke_perform(t_int *w)
     t_float *in1 = (t_float *)(w[3]); // value
     t_float *in2 = (t_float *)(w[4]); // index
     t_word *vp = c->c_vectors[0];
-    if (vp && c->c_playable) // ??? (porres)
+    float *fp = c->c_fvectors[0];
+    if ((vp || fp) && c->c_playable) // ??? (porres)
         {
         poke_redraw_lim(x);
         int npts = c->c_npts;
+        int stride = c->c_stride;
         while (nblock--)
             {
             t_float value = *in1++; // value
             int index = (int)*in2++; // index
-            if (index >= 0 && index < npts) vp[index].w_float = value;
+            if (index >= 0 && index < npts) CYBUF_SETSAMPLE(vp, fp, stride, index, value);
             }
         }
     return (w + 5);
@@ -170,6 +175,7 @@ static void *poke_new(t_symbol *s, t_floatarg f)
     int ch = (f < 1) ? 1 : (f > CYBUF_MAXCHANS) ? CYBUF_MAXCHANS : (int)f;
 	t_poke *x = (t_poke  *)pd_new(poke_class);
     x->x_cybuf = cybuf_init((t_class *) x, s, 1, ch);
+    cybuf_usepool(x->x_cybuf);
     if (x) // ??? (porres)
         {
         x->x_channum = ch;
@@ -198,9 +198,10 @@ static t_int *record_perform(t_int *w){
             if(x->x_isrunning == 1){ // if we're still running after boundschecking
                 for(j = 0; j < nch; j++){
                     t_word *vp = c->c_vectors[j];
+                    float *fp = c->c_fvectors[j];
                     t_float *insig = x->x_ivecs[j];
-                    if(vp)
-                        vp[phase].w_float = insig[i];
+                    if(vp || fp)
+                        CYBUF_SETSAMPLE(vp, fp, c->c_stride, phase, insig[i]);
                 };
                 // sync output
                 sync = (t_float)(phase - startsamp)/(t_float)range;
@@ -359,6 +360,7 @@ static void *record_new(t_symbol *s, int argc, t_atom *argv){
         if(loopstart < 0)
             loopstart = 0;
         cybuf_setminsize(x->x_cybuf, 2);
+        cybuf_usepool(x->x_cybuf);
         record_append(x, append);
         record_loop(x, loopstatus);
         x->x_clock = clock_new(x, (t_method)record_tick);
@@ -23,6 +23,8 @@ handle managemente, added a receive symbol, visible inlets and implemented zoom;
 #include "common/magicbit.h"
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
+#include "x_libpd_scope.h"
 
 #define SCOPE_MINSIZE       18
 #define SCOPE_MINPERIOD     2
@@ -77,6 +79,7 @@ typedef struct _scope{
     t_symbol       *x_bindsym;
     t_clock        *x_clock;
     t_pd           *x_handle;
+    t_libpd_scope   x_display;
 }t_scope;
 
 typedef struct _handle{
@@ -629,7 +632,7 @@ static t_int *scope_perform(t_int *w){
     t_scope *x = (t_scope *)(w[1]);
     if(!x->x_xymode || x->x_frozen) // do nothing
         return(w+5);
-    if(!gobj_shouldvis((t_gobj *)x, x->x_glist) || !glist_isvisible(x->x_glist))
+    if(!x->x_display.s_watched && (!gobj_shouldvis((t_gobj *)x, x->x_glist) || !glist_isvisible(x->x_glist)))
         return(w+5);
     int nblock = (int)(w[2]);
     int bufphase = x->x_bufphase;
@@ -774,7 +777,11 @@ static t_int *scope_perform(t_int *w){
                         memcpy(x->x_ybuflast, x->x_ybuffer, bufsize * sizeof(*x->x_ybuffer));
                         x->x_retrigger = (x->x_trigmode != 0);
                         x->x_trigx = x->x_triglevel;
-                        clock_delay(x->x_clock, 0);
+                        x->x_display.s_frame++;
+                        if(x->x_display.s_watched) // drawn natively, skip the Tk redraw
+                            x->x_precount = (int)(x->x_delay * x->x_ksr);
+                        else
+                            clock_delay(x->x_clock, 0);
                     }
                     else{
                         *bp1 = currx;
@@ -1277,6 +1284,15 @@ static void *scope_new(t_symbol *s, int ac, t_atom *av){
     else
         x->x_gg[0] = grred, x->x_gg[1] = grgreen, x->x_gg[2] = grblue;
     x->x_clock = clock_new(x, (t_method)scope_tick);
+    x->x_display.s_x = x->x_xbuflast;
+    x->x_display.s_y = x->x_ybuflast;
+    x->x_display.s_npoints = &x->x_lastbufsize;
+    x->x_display.s_xymode = &x->x_xymode;
+    x->x_display.s_min = &x->x_min;
+    x->x_display.s_max = &x->x_max;
+    x->x_display.s_bg = x->x_bg;
+    x->x_display.s_fg = x->x_fg;
+    x->x_display.s_grid = x->x_gg;
     return(x);
 errstate:
     pd_error(x, "[scope~]: improper creation arguments");
@@ -1286,6 +1302,7 @@ errstate:
 CYCLONE_OBJ_API void scope_tilde_setup(void){
     scope_class = class_new(gensym("scope~"), (t_newmethod)scope_new,
             (t_method)scope_free, sizeof(t_scope), 0, A_GIMME, 0);
+    libpd_scope_register(scope_class, offsetof(t_scope, x_display));
     class_addmethod(scope_class, nullfn, gensym("signal"), 0);
     class_addmethod(scope_class, (t_method) scope_dsp, gensym("dsp"), A_CANT, 0);
     class_addfloat(scope_class, (t_method)scope_period);
@@ -1327,6 +1344,7 @@ CYCLONE_OBJ_API void scope_tilde_setup(void){
 CYCLONE_OBJ_API void Scope_tilde_setup(void){  
     scope_class = class_new(gensym("Scope~"), (t_newmethod)scope_new,
             (t_method)scope_free, sizeof(t_scope), 0, A_GIMME, 0);
+    libpd_scope_register(scope_class, offsetof(t_scope, x_display));
     class_addmethod(scope_class, nullfn, gensym("signal"), 0);
     class_addmethod(scope_class, (t_method) scope_dsp, gensym("dsp"), A_CANT, 0);
     class_addfloat(scope_class, (t_method)scope_period);
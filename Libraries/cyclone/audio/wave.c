@@ -125,7 +125,8 @@ static void wave_set(t_wave *x, t_symbol *s)
 
 static void wave_nointerp(t_wave *x,
 	t_int *outp, t_float *xin, t_float *sin, t_float *ein,
-	int nblock, int nch, int maxindex, float ksr, t_word **vectable)
+	int nblock, int nch, int maxindex, float ksr, t_word **vectable,
+	float **fvectable, int stride)
 {
 	int iblock;
 	for (iblock = 0; iblock < nblock; iblock++)
@@ -139,8 +140,9 @@ static void wave_nointerp(t_wave *x,
 		while (ch--)
 		{
 			t_word *vp = vectable[ch];
+			float *fp = fvectable[ch];
 			t_float *out = (t_float *)(outp[ch]);
-			out[iblock] = (vp ? vp[ndx].w_float : 0);
+			out[iblock] = (vp || fp ? CYBUF_GETSAMPLE(vp, fp, stride, ndx) : 0);
 		}	
 	}
 	return;
@@ -148,7 +150,8 @@ static void wave_nointerp(t_wave *x,
 
 static void wave_linear(t_wave *x,
 	t_int *outp, t_float *xin, t_float *sin, t_float *ein,
-	int nblock, int nch, int maxindex, float ksr, t_word **vectable)
+	int nblock, int nch, int maxindex, float ksr, t_word **vectable,
+	float **fvectable, int stride)
 {
 	int iblock;
 	for (iblock = 0; iblock < nblock; iblock++)
@@ -161,11 +164,12 @@ static void wave_linear(t_wave *x,
 		while (ch--)
 		{
 			t_word *vp = vectable[ch];
+			float *fp = fvectable[ch];
 			t_float *out = (t_float *)(outp[ch]);
-			if (vp)
+			if (vp || fp)
 			{
-				a = (double)vp[ndx].w_float;
-				b = (double)vp[ndx1].w_float;
+				a = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx);
+				b = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx1);
 				out[iblock] = (t_float)(a * (1.0 - frac) + b * frac);
 			}
 			else out[iblock] = 0;
@@ -176,7 +180,8 @@ static void wave_linear(t_wave *x,
 
 static void wave_linlq(t_wave *x,
 	t_int *outp, t_float *xin, t_float *sin, t_float *ein,
-	int nblock, int nch, int maxindex, float ksr, t_word **vectable)
+	int nblock, int nch, int maxindex, float ksr, t_word **vectable,
+	float **fvectable, int stride)
 {
 	int iblock;
 	for (iblock = 0; iblock < nblock; iblock++)
@@ -189,11 +194,12 @@ static void wave_linlq(t_wave *x,
 		while (ch--)
 		{
 			t_word *vp = vectable[ch];
+			float *fp = fvectable[ch];
 			t_float *out = (t_float *)(outp[ch]);
-			if (vp)
+			if (vp || fp)
 			{
-				a = vp[ndx].w_float;
-				b = vp[ndx1].w_float;
+				a = CYBUF_GETSAMPLE(vp, fp, stride, ndx);
+				b = CYBUF_GETSAMPLE(vp, fp, stride, ndx1);
 				out[iblock] = a + frac * (b - a);
 			}
 			else out[iblock] = 0;
@@ -204,7 +210,8 @@ static void wave_linlq(t_wave *x,
 
 static void wave_cosine(t_wave *x,
 	t_int *outp, t_float *xin, t_float *sin, t_float *ein,
-	int nblock, int nch, int maxindex, float ksr, t_word **vectable)
+	int nblock, int nch, int maxindex, float ksr, t_word **vectable,
+	float **fvectable, int stride)
 {
 	int iblock;
 	for (iblock = 0; iblock < nblock; iblock++)
@@ -217,11 +224,12 @@ static void wave_cosine(t_wave *x,
 		while (ch--)
 		{
 			t_word *vp = vectable[ch];
+			float *fp = fvectable[ch];
 			t_float *out = (t_float *)(outp[ch]);
-			if (vp)
+			if (vp || fp)
 			{
-				a = (double)vp[ndx].w_float;
-				b = (double)vp[ndx1].w_float;
+				a = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx);
+				b = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx1);
 				frac = (1 - cos(frac * M_PI)) / 2.0;
 				out[iblock] = (t_float)(a * (1 - frac) + b * (frac));
 			}
@@ -234,7 +242,8 @@ static void wave_cosine(t_wave *x,
 
 static void wave_cubic(t_wave *x,
 	t_int *outp, t_float *xin, t_float *sin, t_float *ein,
-	int nblock, int nch, int maxindex, float ksr, t_word **vectable)
+	int nblock, int nch, int maxindex, float ksr, t_word **vectable,
+	float **fvectable, int stride)
 {
 	int iblock;
 	for (iblock = 0; iblock < nblock; iblock++)
@@ -247,13 +256,14 @@ static void wave_cubic(t_wave *x,
 		while (ch--)
 		{
 			t_word *vp = vectable[ch];
+			float *fp = fvectable[ch];
 			t_float *out = (t_float *)(outp[ch]);
-			if (vp)
+			if (vp || fp)
 			{
-				a = (double)vp[ndxm1].w_float;
-				b = (double)vp[ndx].w_float;
-				c = (double)vp[ndx1].w_float;
-				d = (double)vp[ndx2].w_float;
+				a = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndxm1);
+				b = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx);
+				c = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx1);
+				d = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx2);
 				double p0, p1, p2;
 				p0 = d - a + b - c;
 				p1 = a - b - p0;
@@ -269,7 +279,8 @@ static void wave_cubic(t_wave *x,
 
 static void wave_spline(t_wave *x,
 	t_int *outp, t_float *xin, t_float *sin, t_float *ein,
-	int nblock, int nch, int maxindex, float ksr, t_word **vectable)
+	int nblock, int nch, int maxindex, float ksr, t_word **vectable,
+	float **fvectable, int stride)
 {
 	int iblock;
 	for (iblock = 0; iblock < nblock; iblock++)
@@ -282,13 +293,14 @@ static void wave_spline(t_wave *x,
 		while (ch--)
 		{
 			t_word *vp = vectable[ch];
+			float *fp = fvectable[ch];
 			t_float *out = (t_float *)(outp[ch]);
-			if (vp)
+			if (vp || fp)
 			{
-				a = (double)vp[ndxm1].w_float;
-				b = (double)vp[ndx].w_float;
-				c = (double)vp[ndx1].w_float;
-				d = (double)vp[ndx2].w_float;
+				a = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndxm1);
+				b = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx);
+				c = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx1);
+				d = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx2);
 				double p0, p1, p2;
 				p0 = 0.5*(d - a) + 1.5*(b - c);
 				p2 = 0.5*(c - a);
@@ -304,7 +316,8 @@ static void wave_spline(t_wave *x,
 
 static void wave_hermite(t_wave *x,
 	t_int *outp, t_float *xin, t_float *sin, t_float *ein,
-	int nblock, int nch, int maxindex, float ksr, t_word **vectable)
+	int nblock, int nch, int maxindex, float ksr, t_word **vectable,
+	float **fvectable, int stride)
 {
 	int iblock;
 	for (iblock = 0; iblock < nblock; iblock++)
@@ -319,13 +332,14 @@ static void wave_hermite(t_wave *x,
 		while (ch--)
 		{
 			t_word *vp = vectable[ch];
+			float *fp = fvectable[ch];
 			t_float *out = (t_float *)(outp[ch]);
-			if (vp)
+			if (vp || fp)
 			{
-				a = (double)vp[ndxm1].w_float;
-				b = (double)vp[ndx].w_float;
-				c = (double)vp[ndx1].w_float;
-				d = (double)vp[ndx2].w_float;
+				a = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndxm1);
+				b = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx);
+				c = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx1);
+				d = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx2);
 				double p0, p1, p2, p3, m0, m1;
 				double frac2 = frac*frac;
 				double frac3 = frac*frac2;
@@ -350,7 +364,8 @@ static void wave_hermite(t_wave *x,
 
 static void wave_lagrange(t_wave *x,
 	t_int *outp, t_float *xin, t_float *sin, t_float *ein,
-	int nblock, int nch, int maxindex, float ksr, t_word **vectable)
+	int nblock, int nch, int maxindex, float ksr, t_word **vectable,
+	float **fvectable, int stride)
 {
 	int iblock;
 	for (iblock = 0; iblock < nblock; iblock++)
@@ -363,13 +378,14 @@ static void wave_lagrange(t_wave *x,
 		while (ch--)
 		{
 			t_word *vp = vectable[ch];
+			float *fp = fvectable[ch];
 			t_float *out = (t_float *)(outp[ch]);
-			if (vp)
+			if (vp || fp)
 			{
-				a = (double)vp[ndxm1].w_float;
-				b = (double)vp[ndx].w_float;
-				c = (double)vp[ndx1].w_float;
-				d = (double)vp[ndx2].w_float;
+				a = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndxm1);
+				b = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx);
+				c = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx1);
+				d = (double)CYBUF_GETSAMPLE(vp, fp, stride, ndx2);
 				double cminusb = c-b;
 				out[iblock] = (t_float)(b + frac * (
 					cminusb - (1. - frac)/6. * (
@@ -390,7 +406,8 @@ static t_int *wave_perform(t_int *w)
 	
 	static void (* const wif[])(t_wave *x,
 		t_int *outp, t_float *xin, t_float *sin, t_float *ein,
-		int nblock, int nch, int maxindex, float ksr, t_word **vectable) = 
+		int nblock, int nch, int maxindex, float ksr, t_word **vectable,
+		float **fvectable, int stride) = 
 	{
    		wave_nointerp,
     	wave_linear,
@@ -424,7 +441,8 @@ static t_int *wave_perform(t_int *w)
 		int interp_mode = x->x_interp_mode;
 		/*Choose interpolation function from jump table. The interpolation functions also
 		  perform the block loop in order not to make a bunch of per-sample decisions.*/	
-		wif[interp_mode](x, outp, xin, sin, ein, nblock, nch, maxindex, ksr, vectable);
+		wif[interp_mode](x, outp, xin, sin, ein, nblock, nch, maxindex, ksr, vectable,
+			c->c_fvectors, c->c_stride);
     }
     else
     {
@@ -553,6 +571,7 @@ static void *wave_new(t_symbol *s, int argc, t_atom * argv){
 
         t_wave *x = (t_wave *)pd_new(wave_class);
         x->x_cybuf = cybuf_init((t_class *)x, name, numouts, 0);
+        cybuf_usepool(x->x_cybuf);
         x->x_numouts = numouts;
 	
         //allocating output vectors
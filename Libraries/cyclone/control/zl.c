@@ -6,6 +6,7 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include "m_pd.h"
 #include <common/api.h>
 
@@ -263,6 +264,76 @@ static void zl_swap(t_atom *av, int i, int j) {
 	av[i] = temp; 
 }
 
+// set of atoms for the set operations, equal as in zl_equal(), open addressing
+// holds pointers to the atoms, so they must stay put while the set is in use
+
+#define ZL_SETINI 64 // slots that need no allocation, for lists up to half of that
+
+typedef struct _zlset{
+    int      s_mask;
+    t_atom **s_slots;
+    t_atom  *s_slotsini[ZL_SETINI];
+} t_zlset;
+
+static void zlset_init(t_zlset *set, int natoms){
+    int size = ZL_SETINI;
+    while(size < 2 * natoms)
+        size *= 2;
+    set->s_mask = size - 1;
+    if(size > ZL_SETINI)
+        set->s_slots = (t_atom **)getbytes(size * sizeof(*set->s_slots));
+    else{
+        set->s_slots = set->s_slotsini;
+        memset(set->s_slots, 0, size * sizeof(*set->s_slots));
+    }
+}
+
+static void zlset_free(t_zlset *set){
+    if(set->s_slots != set->s_slotsini)
+        freebytes(set->s_slots, (set->s_mask + 1) * sizeof(*set->s_slots));
+}
+
+static unsigned int zlset_hash(t_atom *ap){
+    uint64_t h = 0;
+    if(ap->a_type == A_FLOAT){
+        t_float f = ap->a_w.w_float;
+        if(f == 0) // -0 equals 0
+            f = 0;
+        memcpy(&h, &f, sizeof(f));
+    }
+    else
+        h = (uint64_t)(uintptr_t)ap->a_w.w_symbol;
+    h ^= h >> 32;
+    h *= 0x9E3779B97F4A7C15ULL;
+    return((unsigned int)(h >> 32));
+}
+
+// the slot of an equal atom, or the empty one where it goes
+static t_atom **zlset_slot(t_zlset *set, t_atom *ap){
+    unsigned int i = zlset_hash(ap) & set->s_mask;
+    while(set->s_slots[i] && !zl_equal(set->s_slots[i], ap))
+        i = (i + 1) & set->s_mask;
+    return(&set->s_slots[i]);
+}
+
+static int zlset_has(t_zlset *set, t_atom *ap){
+    return(*zlset_slot(set, ap) != 0);
+}
+
+// returns 0 if an equal atom was in already
+static int zlset_add(t_zlset *set, t_atom *ap){
+    t_atom **slot = zlset_slot(set, ap);
+    if(*slot)
+        return(0);
+    *slot = ap;
+    return(1);
+}
+
+static void zlset_addlist(t_zlset *set, int ac, t_atom *av){
+    while(ac--)
+        zlset_add(set, av++);
+}
+
 
 // ********************************************************************
 // ************************* ZL MODES *********************************
@@ -648,53 +719,38 @@ static void zl_sect_anyarg(t_zl *x, t_symbol *s, int ac, t_atom *av){
         zldata_set(&x->x_inbuf2, s, ac, av);
 }
 
-/* LATER rethink */
-static int zl_sect_count(t_zl *x){
-    int result = 0;
-    int ac1 = x->x_inbuf1.d_natoms, ac2 = x->x_inbuf2.d_natoms, i1;
-    t_atom *av1 = x->x_inbuf1.d_buf, *av2 = x->x_inbuf2.d_buf, *ap1;
-    for(i1 = 0, ap1 = av1; i1 < ac1; i1++, ap1++){
-        int i2;
-        t_atom *testp;
-        for(i2 = 0, testp = av1; i2 < i1; i2++, testp++)
-            if(zl_equal(ap1, testp))
-                goto
-                skip;
-        for (i2 = 0, testp = av2; i2 < ac2; i2++, testp++){
-            if (zl_equal(ap1, testp)){
-                result++;
-                break;
-            }
+// atoms of the left list that are in the right one, each once, to buf if not null
+static int zl_sect_do(t_zl *x, t_atom *buf){
+    int ac1 = x->x_inbuf1.d_natoms, ac2 = x->x_inbuf2.d_natoms, i1, result = 0;
+    t_atom *ap1 = x->x_inbuf1.d_buf;
+    t_zlset in2, seen;
+    zlset_init(&in2, ac2);
+    zlset_init(&seen, ac1);
+    zlset_addlist(&in2, ac2, x->x_inbuf2.d_buf);
+    for(i1 = 0; i1 < ac1; i1++, ap1++){
+        if(zlset_has(&in2, ap1) && zlset_add(&seen, ap1)){
+            if(buf)
+                buf[result] = *ap1;
+            result++;
         }
-    skip:;
     }
+    zlset_free(&in2);
+    zlset_free(&seen);
     return(result);
 }
 
+static int zl_sect_count(t_zl *x){
+    return(zl_sect_do(x, 0));
+}
+
 // CHECKED in-buffer duplicates are skipped
 static void zl_sect(t_zl *x, int natoms, t_atom *buf, int banged){
     banged = 0;
     if(!natoms)
         outlet_bang(x->x_out2);
     if(buf){
-        int ac1 = x->x_inbuf1.d_natoms, ac2 = x->x_inbuf2.d_natoms, i1;
-        t_atom *ap1 = x->x_inbuf1.d_buf, *av2 = x->x_inbuf2.d_buf, *to = buf;
-        for(i1 = 0; i1 < ac1; i1++, ap1++){
-            int i2;
-            t_atom *testp;
-            for(testp = buf; testp < to; testp++)
-                if(zl_equal(ap1, testp))
-                    goto
-                        skip;
-            for(i2 = 0, testp = av2; i2 < ac2; i2++, testp++){
-                if(zl_equal(ap1, testp)){
-                    *to++ = *ap1;
-                    break;
-                }
-            }
-        skip:;
-        }
-    zl_output(x, natoms, buf);
+        zl_sect_do(x, buf);
+        zl_output(x, natoms, buf);
     }
 }
 
@@ -751,6 +807,8 @@ static int zl_sort_cmp(t_zl *x, t_atom *a1, t_atom *a2){
 	}
 	if(a1->a_type == A_SYMBOL && a2->a_type == A_SYMBOL)
 		return(strcmp(a1->a_w.w_symbol->s_name, a2->a_w.w_symbol->s_name));
+	if(a1->a_type == A_POINTER && a2->a_type == A_POINTER)
+		return(0);
 	if(a1->a_type == A_POINTER)
         return(1);
     if(a2->a_type == A_POINTER)
@@ -759,26 +817,107 @@ static int zl_sort_cmp(t_zl *x, t_atom *a1, t_atom *a2){
         return(0);
 }
 
-static void zl_sort_qsort(t_zl *x, t_atom *av1, t_atom *av2, int left, int right, int dir) {
-    int i, last;
-    if(left >= right)
-        return;
-    zl_swap(av1, left, (left + right)/2);
-    if(av2)
-    	zl_swap(av2, left, (left + right)/2);
-    last = left;
-    for (i = left+1; i <= right; i++) {
-        if((dir * zl_sort_cmp(x, av1 + i, av1 + left)) < 0){
-            zl_swap(av1, ++last, i);
-            if (av2)
-            	zl_swap(av2, last, i);
+/* The sort orders input positions (ndx) rather than the atoms, and equal atoms by
+   their position, so it is stable and the positions are the right outlet's output.
+   Introsort: quicksort with a median of three, heapsort when it goes too deep,
+   insertion sort for short ranges. The loops are bounded, an inconsistent order
+   (nan) can't make them run off the range. */
+
+#define ZL_SORT_SHORT 16
+
+static int zl_sort_before(t_zl *x, t_atom *av, int i, int j, int dir){
+    int c = dir * zl_sort_cmp(x, av + i, av + j);
+    return(c ? c < 0 : i < j);
+}
+
+static void zl_sort_insertion(t_zl *x, t_atom *av, int *ndx, int lo, int hi, int dir){
+    for(int i = lo + 1; i <= hi; i++){
+        int v = ndx[i], j = i;
+        for(; j > lo && zl_sort_before(x, av, v, ndx[j-1], dir); j--)
+            ndx[j] = ndx[j-1];
+        ndx[j] = v;
+    }
+}
+
+static void zl_sort_sift(t_zl *x, t_atom *av, int *heap, int root, int n, int dir){
+    int v = heap[root];
+    for(;;){
+        int child = 2 * root + 1;
+        if(child >= n)
+            break;
+        if(child + 1 < n && zl_sort_before(x, av, heap[child], heap[child+1], dir))
+            child++;
+        if(!zl_sort_before(x, av, v, heap[child], dir))
+            break;
+        heap[root] = heap[child];
+        root = child;
+    }
+    heap[root] = v;
+}
+
+static void zl_sort_heap(t_zl *x, t_atom *av, int *heap, int n, int dir){
+    int i;
+    for(i = n/2 - 1; i >= 0; i--)
+        zl_sort_sift(x, av, heap, i, n, dir);
+    for(i = n - 1; i > 0; i--){
+        int v = heap[0];
+        heap[0] = heap[i];
+        heap[i] = v;
+        zl_sort_sift(x, av, heap, 0, i, dir);
+    }
+}
+
+static void zl_sort_intro(t_zl *x, t_atom *av, int *ndx, int lo, int hi, int depth, int dir){
+    while(hi - lo > ZL_SORT_SHORT){
+        int mid = lo + (hi - lo) / 2, i = lo, j = hi, p, v;
+        if(!depth--){
+            zl_sort_heap(x, av, ndx + lo, hi - lo + 1, dir);
+            return;
         }
+        if(zl_sort_before(x, av, ndx[mid], ndx[lo], dir))
+            v = ndx[mid], ndx[mid] = ndx[lo], ndx[lo] = v;
+        if(zl_sort_before(x, av, ndx[hi], ndx[mid], dir)){
+            v = ndx[hi], ndx[hi] = ndx[mid], ndx[mid] = v;
+            if(zl_sort_before(x, av, ndx[mid], ndx[lo], dir))
+                v = ndx[mid], ndx[mid] = ndx[lo], ndx[lo] = v;
+        }
+        p = ndx[mid];
+        for(;;){
+            do i++; while(i < hi && zl_sort_before(x, av, ndx[i], p, dir));
+            do j--; while(j > lo && zl_sort_before(x, av, p, ndx[j], dir));
+            if(i >= j)
+                break;
+            v = ndx[i], ndx[i] = ndx[j], ndx[j] = v;
+        }
+        // the shorter side first, so the recursion stays shallow
+        if(j - lo < hi - j){
+            zl_sort_intro(x, av, ndx, lo, j, depth, dir);
+            lo = j + 1;
+        }
+        else{
+            zl_sort_intro(x, av, ndx, j + 1, hi, depth, dir);
+            hi = j;
+        }
+    }
+    zl_sort_insertion(x, av, ndx, lo, hi, dir);
+}
+
+// sorted copy of av to buf, and the input positions to ndxbuf if not null
+static void zl_sort_list(t_zl *x, int natoms, t_atom *av, t_atom *buf, t_atom *ndxbuf, int dir){
+    int ndxini[ZL_DEF_SIZE], depth = 0, i;
+    int *ndx = natoms > ZL_DEF_SIZE ? (int *)getbytes(natoms * sizeof(*ndx)) : ndxini;
+    for(i = 0; i < natoms; i++)
+        ndx[i] = i;
+    for(i = natoms; i > 1; i >>= 1)
+        depth += 2;
+    zl_sort_intro(x, av, ndx, 0, natoms - 1, depth, dir);
+    for(i = 0; i < natoms; i++){
+        buf[i] = av[ndx[i]];
+        if(ndxbuf)
+            SETFLOAT(&ndxbuf[i], ndx[i]);
     }
-    zl_swap(av1, left, last);
-    if (av2)
-    	zl_swap(av2, left, last);
-    zl_sort_qsort(x, av1, av2, left, last-1, dir);
-    zl_sort_qsort(x, av1, av2, last+1, right, dir);
+    if(ndx != ndxini)
+        freebytes(ndx, natoms * sizeof(*ndx));
 }
 
 static void zl_sort_rev(t_zl *x, int natoms, t_atom *av) {
@@ -803,11 +942,7 @@ static void zl_sort(t_zl *x, int natoms, t_atom *buf, int banged){
     	}
     	else {
 
-			memcpy(buf, x->x_inbuf1.d_buf, natoms * sizeof(*buf));
-			for (int i = 0; i < natoms; i++)
-    			SETFLOAT(&buf2[i], i);
-    		zl_sort_qsort(x, buf, buf2, 0, natoms - 1, x->x_modearg);
-    		//
+			zl_sort_list(x, natoms, x->x_inbuf1.d_buf, buf, buf2, x->x_modearg);
     		x->x_inbuf1.d_sorted = x->x_modearg;
     		zl_output2(x, natoms, buf2);
     		zl_output(x, natoms, buf);
@@ -866,46 +1001,36 @@ static void zl_union_anyarg(t_zl *x, t_symbol *s, int ac, t_atom *av){
         zldata_set(&x->x_inbuf2, s, ac, av);
 }
 
-/* LATER rethink */
-static int zl_union_count(t_zl *x){
-    int result, ac1 = x->x_inbuf1.d_natoms, ac2 = x->x_inbuf2.d_natoms, i2;
+// the left list, then the atoms of the right one that aren't in it, to buf if not null
+static int zl_union_do(t_zl *x, t_atom *buf){
+    int ac1 = x->x_inbuf1.d_natoms, ac2 = x->x_inbuf2.d_natoms, i2, result = ac1;
     t_atom *av1 = x->x_inbuf1.d_buf, *ap2 = x->x_inbuf2.d_buf;
-    result = ac1 + ac2;
-    for (i2 = 0; i2 < ac2; i2++, ap2++){
-        int i1;
-        t_atom *ap1;
-        for (i1 = 0, ap1 = av1; i1 < ac1; i1++, ap1++){
-            if (zl_equal(ap1, ap2)){
-                result--;
-                break;
-            }
+    t_zlset in1;
+    if(buf)
+        memcpy(buf, av1, ac1 * sizeof(*buf));
+    zlset_init(&in1, ac1);
+    zlset_addlist(&in1, ac1, av1);
+    for(i2 = 0; i2 < ac2; i2++, ap2++){
+        if(!zlset_has(&in1, ap2)){
+            if(buf)
+                buf[result] = *ap2;
+            result++;
         }
     }
-    return (result);
+    zlset_free(&in1);
+    return(result);
+}
+
+static int zl_union_count(t_zl *x){
+    return(zl_union_do(x, 0));
 }
 
 /* CHECKED in-buffer duplicates not skipped */
 static void zl_union(t_zl *x, int natoms, t_atom *buf, int banged){
     if (buf){
         banged = 0;
-        int ac1 = x->x_inbuf1.d_natoms, ac2 = x->x_inbuf2.d_natoms, i2;
-        t_atom *av1 = x->x_inbuf1.d_buf, *ap2 = x->x_inbuf2.d_buf;
-        if (ac1){
-            t_atom *to = buf + ac1;
-            memcpy(buf, av1, ac1 * sizeof(*buf));
-            for (i2 = 0; i2 < ac2; i2++, ap2++){
-                int i1;
-                t_atom *ap1;
-                for (i1 = 0, ap1 = av1; i1 < ac1; i1++, ap1++)
-                    if (zl_equal(ap1, ap2))
-                        break;
-                if (i1 == ac1)
-                    *to++ = *ap2;
-            }
-        }
-	else
-        memcpy(buf, ap2, ac2 * sizeof(*buf));
-	zl_output(x, natoms, buf);
+        zl_union_do(x, buf);
+        zl_output(x, natoms, buf);
     }
 }
 
@@ -1007,18 +1132,17 @@ static void zl_filter(t_zl *x, int natoms, t_atom *buf, int banged){
 		t_atom *av1 = x->x_inbuf1.d_buf, *av2 = x->x_inbuf2.d_buf,
 			*buf2 = x->x_outbuf2.d_buf;
 		int filtatoms = x->x_inbuf2.d_natoms;
-		int i, j, total = 0;
+		int i, total = 0;
+		t_zlset filter;
+		zlset_init(&filter, filtatoms);
+		zlset_addlist(&filter, filtatoms, av2);
 		for (i = 0; i < natoms ; i++) {
-			for (j = 0; j < filtatoms; j++) {
-				if (zl_equal(&av1[i], &av2[j]))
-					break;
-			}
-			if (j == filtatoms) {
-				//post("total = %d", total);
+			if (!zlset_has(&filter, &av1[i])) {
 				SETFLOAT(&buf2[total], i);
 				buf[total++] = av1[i];
 			}
 		}
+		zlset_free(&filter);
 		zl_output2(x, total, buf2);
 		zl_output(x, total, buf);
 	}
@@ -1084,15 +1208,15 @@ static int zl_median_count(t_zl *x){
 static void zl_median(t_zl *x, int natoms, t_atom *buf, int banged){
 	if (buf) {
         banged = 0;
-		t_atom *av1 = x->x_inbuf1.d_buf;
+		t_atom *av1 = x->x_inbuf1.d_buf, *floats = x->x_outbuf2.d_buf;
 		int i, total = 0;
 		for (i = 0; i < natoms; i++) {
 			if (av1[i].a_type == A_FLOAT)
-				buf[total++] = av1[i];
+				floats[total++] = av1[i];
 			//post ("total %d", total);
 		}
 		if (total) {
-			zl_sort_qsort(x, buf, 0, 0, total - 1, 1);
+			zl_sort_list(x, total, floats, buf, 0, 1);
 			//zl_output2(x,total,buf);
 			if (total % 2)
 				outlet_float(((t_object *)x)->ob_outlet, buf[total/2].a_w.w_float);
@@ -1299,19 +1423,15 @@ static void zl_unique(t_zl *x, int natoms, t_atom *buf, int banged){
         banged = 0;
 		t_atom *av1 = x->x_inbuf1.d_buf, *av2 = x->x_inbuf2.d_buf;
 		int filtatoms = x->x_inbuf2.d_natoms;
-		int i, j, total = 0;
+		int i, total = 0;
+		t_zlset filter;
+		zlset_init(&filter, filtatoms);
+		zlset_addlist(&filter, filtatoms, av2);
 		for (i = 0; i < natoms ; i++) {
-			for (j = 0; j < filtatoms; j++) {
-				if (zl_equal(&av1[i], &av2[j]))
-					break;
-			}
-			if (j == filtatoms) {
-				//post("total = %d", total);
-				//SETFLOAT(&buf2[total], i);
+			if (!zlset_has(&filter, &av1[i]))
 				buf[total++] = av1[i];
-			}
 		}
-		//zl_output2(x, total, buf2);
+		zlset_free(&filter);
 		zl_output(x, total, buf);
 	}
 }
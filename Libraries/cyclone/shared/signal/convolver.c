@@ -0,0 +1,227 @@
+/* Copyright (c) 2022 Timothy Schoen and others.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+#include <string.h>
+#include "m_pd.h"
+#include "convolver.h"
+
+/* pd's real fft packs the spectrum as re[0..n/2], im[n/2-1..1] from the end */
+static void convolver_multiply_add(t_float *acc, const t_float *a, const t_float *b, int n)
+{
+    int half = n / 2, k;
+    acc[0] += a[0] * b[0];
+    acc[half] += a[half] * b[half];
+    for (k = 1; k < half; k++)
+    {
+        t_float are = a[k], aim = a[n - k];
+        t_float bre = b[k], bim = b[n - k];
+        acc[k] += are * bre - aim * bim;
+        acc[n - k] += are * bim + aim * bre;
+    }
+}
+
+static void convolver_freebuffers(t_convolver *c)
+{
+    int n = c->c_fftsize;
+    if (c->c_taps) freebytes(c->c_taps, (c->c_maxparts + 1) * c->c_blocksize * sizeof(t_float));
+    if (c->c_spectra) freebytes(c->c_spectra, c->c_maxparts * n * sizeof(t_float));
+    if (c->c_fdl) freebytes(c->c_fdl, c->c_maxparts * n * sizeof(t_float));
+    if (c->c_window) freebytes(c->c_window, n * sizeof(t_float));
+    if (c->c_acc) freebytes(c->c_acc, n * sizeof(t_float));
+    if (c->c_tail) freebytes(c->c_tail, c->c_blocksize * sizeof(t_float));
+}
+
+void convolver_init(t_convolver *c)
+{
+    memset(c, 0, sizeof(*c));
+}
+
+void convolver_free(t_convolver *c)
+{
+    convolver_freebuffers(c);
+    convolver_init(c);
+}
+
+int convolver_setup(t_convolver *c, int blocksize, int maxtaps)
+{
+    int n = 2 * blocksize, maxparts, i;
+    if (blocksize < 2 || (blocksize & (blocksize - 1)) || maxtaps < 1)
+    {
+        convolver_free(c);
+        return (0);
+    }
+    maxparts = maxtaps > blocksize ? (maxtaps - 1) / blocksize : 1;
+    if (c->c_blocksize == blocksize && c->c_maxtaps == maxtaps)
+        return (1);
+    convolver_freebuffers(c);
+    convolver_init(c);
+    c->c_blocksize = blocksize;
+    c->c_fftsize = n;
+    c->c_maxtaps = maxtaps;
+    c->c_maxparts = maxparts;
+    c->c_taps = (t_float *)getbytes((maxparts + 1) * blocksize * sizeof(t_float));
+    c->c_spectra = (t_float *)getbytes(maxparts * n * sizeof(t_float));
+    c->c_fdl = (t_float *)getbytes(maxparts * n * sizeof(t_float));
+    c->c_window = (t_float *)getbytes(n * sizeof(t_float));
+    c->c_acc = (t_float *)getbytes(n * sizeof(t_float));
+    c->c_tail = (t_float *)getbytes(blocksize * sizeof(t_float));
+    if (!c->c_taps || !c->c_spectra || !c->c_fdl || !c->c_window
+        || !c->c_acc || !c->c_tail)
+    {
+        convolver_free(c);
+        return (0);
+    }
+        /* measure the gain of a forward and inverse transform, this also
+           makes sure pd's fft tables are allocated before we start */
+    memset(c->c_acc, 0, n * sizeof(t_float));
+    c->c_acc[0] = 1;
+    mayer_realfft(n, c->c_acc);
+    mayer_realifft(n, c->c_acc);
+    c->c_scale = c->c_acc[0] != 0 ? 1. / c->c_acc[0] : 0;
+    for (i = 0; i < maxparts * n; i++)
+        c->c_spectra[i] = c->c_fdl[i] = 0;
+    return (1);
+}
+
+static void convolver_transformpartition(t_convolver *c, int part)
+{
+    int b = c->c_blocksize, n = c->c_fftsize;
+    int start = b + part * b, i;
+        /* taps after c_ntaps are always zero */
+    t_float *spectrum = c->c_spectra + part * n;
+    for (i = 0; i < b; i++)
+        spectrum[i] = c->c_taps[start + i];
+    for (; i < n; i++)
+        spectrum[i] = 0;
+    mayer_realfft(n, spectrum);
+}
+
+static void convolver_tail(t_convolver *c);
+
+    /* copies the taps and transforms the partitions that changed,
+       taps are read from either a strided float or a word array */
+static int convolver_commit(t_convolver *c, const float *ftaps, int fstride,
+    t_word *wtaps, int ntaps)
+{
+    int b = c->c_blocksize, oldtaps = c->c_ntaps, oldparts = c->c_nparts;
+    int changed = (ntaps != oldtaps), nparts, part, i;
+    if (ntaps > c->c_maxtaps) ntaps = c->c_maxtaps;
+    if (ntaps < 0) ntaps = 0;
+    nparts = ntaps > b ? (ntaps - 1) / b : 0;
+    for (part = -1; part < nparts; part++)
+    {
+            /* part -1 is the head, which is used directly */
+        int start = b + part * b, dirty = (part >= oldparts);
+        for (i = start; i < start + b; i++)
+        {
+            t_float f = i < ntaps ? (ftaps ? ftaps[(size_t)i * fstride] : wtaps[i].w_float) : 0;
+            if (c->c_taps[i] != f)
+            {
+                c->c_taps[i] = f;
+                dirty = 1;
+            }
+        }
+        if (dirty)
+        {
+            if (part >= 0) convolver_transformpartition(c, part);
+            changed = 1;
+        }
+    }
+        /* keep everything after the last partition zero */
+    for (i = (nparts + 1) * b; i < oldtaps; i++)
+        c->c_taps[i] = 0;
+    c->c_ntaps = ntaps;
+    c->c_nparts = nparts;
+        /* the tail of the coming block was made with the old taps,
+           the delay line still holds the input it needs */
+    if (changed) convolver_tail(c);
+    return (changed);
+}
+
+int convolver_update(t_convolver *c, t_word *taps, int ntaps)
+{
+    if (!c->c_blocksize) return (0);
+    return (convolver_commit(c, 0, 0, taps, ntaps));
+}
+
+int convolver_update_float(t_convolver *c, const float *taps, int stride, int ntaps)
+{
+    if (!c->c_blocksize) return (0);
+    return (convolver_commit(c, taps, stride, 0, ntaps));
+}
+
+    /* sums the delay line with the tail spectra into c_tail */
+static void convolver_tail(t_convolver *c)
+{
+    int b = c->c_blocksize, n = c->c_fftsize, part, i;
+    if (!c->c_nparts)
+    {
+        memset(c->c_tail, 0, b * sizeof(t_float));
+        return;
+    }
+    memset(c->c_acc, 0, n * sizeof(t_float));
+    for (part = 0; part < c->c_nparts; part++)
+    {
+        int slot = (c->c_fdlpos - part + c->c_maxparts) % c->c_maxparts;
+        convolver_multiply_add(c->c_acc, c->c_fdl + slot * n,
+            c->c_spectra + part * n, n);
+    }
+    mayer_realifft(n, c->c_acc);
+    for (i = 0; i < b; i++)
+        c->c_tail[i] = c->c_acc[b + i] * c->c_scale;
+}
+
+    /* pushes the current window into the delay line */
+static void convolver_pushwindow(t_convolver *c)
+{
+    int n = c->c_fftsize;
+    t_float *slot;
+    c->c_fdlpos = (c->c_fdlpos + 1) % c->c_maxparts;
+    slot = c->c_fdl + c->c_fdlpos * n;
+    memcpy(slot, c->c_window, n * sizeof(t_float));
+    mayer_realfft(n, slot);
+}
+
+void convolver_prime(t_convolver *c, const t_float *history, int nhistory)
+{
+    int b = c->c_blocksize, part, i;
+    if (!c->c_blocksize) return;
+        /* oldest block first, so the newest one ends up at c_fdlpos */
+    for (part = c->c_maxparts - 1; part >= 0; part--)
+    {
+            /* window ending 'part' blocks before the end of the history */
+        int end = nhistory - part * b;
+        for (i = 0; i < c->c_fftsize; i++)
+        {
+            int idx = end - c->c_fftsize + i;
+            c->c_window[i] = (idx >= 0 && idx < nhistory) ? history[idx] : 0;
+        }
+        convolver_pushwindow(c);
+    }
+    convolver_tail(c);
+        /* keep the newest block as the previous one */
+    memmove(c->c_window, c->c_window + b, b * sizeof(t_float));
+}
+
+void convolver_perform(t_convolver *c, const t_float *in, t_float *out)
+{
+    int b = c->c_blocksize, nhead = c->c_ntaps < b ? c->c_ntaps : b, i, k;
+    t_float *cur = c->c_window + b;
+    memcpy(cur, in, b * sizeof(t_float));
+        /* head: the first block of taps, in the time domain */
+    for (i = 0; i < b; i++)
+    {
+        t_float sum = c->c_tail[i];
+        const t_float *xp = cur + i;
+        for (k = 0; k < nhead; k++)
+            sum += c->c_taps[k] * xp[-k];
+        out[i] = sum;
+    }
+        /* tail: ready one block ahead, since it starts one block late.
+           the delay line is kept up to date even without a tail,
+           so the taps can grow without priming again */
+    convolver_pushwindow(c);
+    convolver_tail(c);
+    memmove(c->c_window, cur, b * sizeof(t_float));
+}
@@ -0,0 +1,55 @@
+/* Copyright (c) 2022 Timothy Schoen and others.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* Uniformly partitioned overlap-save convolution, for long FIRs and impulse responses.
+   The first block of taps is computed directly, so the output has no added latency.
+   The remaining taps are split in partitions of one block, whose spectra are multiplied
+   with a frequency-domain delay line of past input blocks.
+
+   Usage:
+   - convolver_setup() from the dsp method, it allocates for the block size and maximum length
+   - convolver_update() or convolver_update_float() (taps in a sample pool) whenever the taps might have changed,
+     only the partitions that actually changed are transformed again
+   - convolver_prime() when the delay line is out of date, with the past input
+   - convolver_perform() once per block
+*/
+
+#ifndef __CONVOLVER_H__
+#define __CONVOLVER_H__
+
+typedef struct _convolver
+{
+    int        c_blocksize;  /* N, samples per call to perform */
+    int        c_fftsize;    /* 2N */
+    int        c_maxtaps;
+    int        c_maxparts;   /* maximum number of tail partitions */
+    int        c_ntaps;      /* current number of taps */
+    int        c_nparts;     /* current number of tail partitions */
+    t_float    c_scale;      /* normalisation of the inverse fft */
+    t_float   *c_taps;       /* copy of the current taps, to find changes */
+    t_float   *c_spectra;    /* c_maxparts spectra of c_fftsize */
+    t_float   *c_fdl;        /* frequency-domain delay line, c_maxparts spectra */
+    int        c_fdlpos;     /* most recent entry of the delay line */
+    t_float   *c_window;     /* previous and current input block */
+    t_float   *c_acc;        /* accumulated tail spectrum */
+    t_float   *c_tail;       /* tail output for the next block */
+} t_convolver;
+
+void convolver_init(t_convolver *c);
+void convolver_free(t_convolver *c);
+
+/* returns 0 if blocksize isn't a power of two or allocation failed */
+int convolver_setup(t_convolver *c, int blocksize, int maxtaps);
+
+/* returns nonzero if any taps changed */
+int convolver_update(t_convolver *c, t_word *taps, int ntaps);
+int convolver_update_float(t_convolver *c, const float *taps, int stride, int ntaps);
+
+/* rebuilds the delay line from the last nhistory input samples, oldest first */
+void convolver_prime(t_convolver *c, const t_float *history, int nhistory);
+
+/* in and out may not overlap */
+void convolver_perform(t_convolver *c, const t_float *in, t_float *out);
+
+#endif
@@ -42,6 +42,35 @@ t_word *cybuf_get(t_cybuf *c, t_symbol * name, int *bufsize, int indsp, int comp
     return (0);
 }
 
+//binds the sample pool named like the buffer, returns 0 if there is none
+//the reference is kept until the pool is gone or the buffer is renamed
+static int cybuf_getpool(t_cybuf *c){
+    t_samplepool *p = c->c_usepool ? samplepool_find(c->c_bufname) : 0;
+    int ch, found = 0;
+    if(p != c->c_pool){
+        if(p) samplepool_acquire(p);
+        if(c->c_pool) samplepool_release(c->c_pool);
+        c->c_pool = p;
+    };
+    memset(c->c_fvectors, 0, c->c_numchans * sizeof(*c->c_fvectors));
+    if(!p) return (0);
+    for(ch = 0; ch < c->c_numchans; ch++){
+        //single channel mode reads channel c_single (1-indexed)
+        int idx = c->c_single ? c->c_single - 1 : ch;
+        c->c_vectors[ch] = 0;
+        c->c_fvectors[ch] = samplepool_channel(p, idx, &c->c_stride);
+        if(c->c_fvectors[ch]) found = 1;
+    };
+    c->c_npts = found ? p->p_nframes : 0;
+    return (1);
+}
+
+void cybuf_usepool(t_cybuf *c){
+    c->c_usepool = 1;
+    cybuf_validate(c, 0);
+    cybuf_playcheck(c);
+}
+
 //making peek~ work with channel number choosing, assuming 1-indexed
 void cybuf_getchannel(t_cybuf *c, int chan_num, int complain){
     int chan_idx;
@@ -54,6 +83,7 @@ void cybuf_getchannel(t_cybuf *c, int chan_num, int complain){
     c->c_single = chan_num;
     //convert to 0-indexing, separate steps and diff variable for sanity's sake
     chan_idx = chan_num - 1;
+    if(cybuf_getpool(c)) return;
     //making the buffer channel name string we'll be looking for
     if(c->c_bufname != &s_){
         if(chan_idx == 0){
@@ -96,10 +126,12 @@ void cybuf_clear(t_cybuf *c)
 {
     c->c_npts = 0;
     memset(c->c_vectors, 0, c->c_numchans * sizeof(*c->c_vectors));
+    memset(c->c_fvectors, 0, c->c_numchans * sizeof(*c->c_fvectors));
 }
 
 void cybuf_redraw(t_cybuf *c)
 {
+    if(c->c_pool) return; //pools aren't drawn
     if(!c->c_single){
         if (c->c_numchans <= 1 && c->c_bufname != &s_)
         {
@@ -150,6 +182,7 @@ void cybuf_validate(t_cybuf *c, int complain)
     cybuf_clear(c);
     c->c_npts = SHARED_INT_MAX;
     if(!c->c_single){
+        if (cybuf_getpool(c)) return;
         if (c->c_numchans <= 1 && c->c_bufname != &s_)
         {
             c->c_vectors[0] = cybuf_get(c, c->c_bufname, &c->c_npts, 1, 0);
@@ -256,6 +289,10 @@ void cybuf_free(t_cybuf *c)
     if (c->c_channames){
         freebytes(c->c_channames, c->c_numchans * sizeof(*c->c_channames));
     };
+    if (c->c_fvectors){
+        freebytes(c->c_fvectors, c->c_numchans * sizeof(*c->c_fvectors));
+    };
+    if (c->c_pool) samplepool_release(c->c_pool);
     freebytes(c, sizeof(t_cybuf));
 }
 
@@ -268,6 +305,7 @@ void *cybuf_init(t_class *owner, t_symbol *bufname, int numchans, int singlemode
     t_cybuf *c = (t_cybuf *)getbytes(sizeof(t_cybuf));
     t_float **vectors;
     t_symbol **channames = 0;
+    float **fvectors;
     if (!bufname){
         bufname = &s_;
     };
@@ -284,11 +322,20 @@ void *cybuf_init(t_class *owner, t_symbol *bufname, int numchans, int singlemode
 		freebytes(vectors, numchans * sizeof(*vectors));
 	return (0);
     };
+    if (!(fvectors = (float **)getbytes(numchans * sizeof(*fvectors)))) {
+        freebytes(vectors, numchans * sizeof(*vectors));
+        freebytes(channames, numchans * sizeof(*channames));
+        return (0);
+    };
     c->c_single = singlemode;
     c->c_owner = owner;
     c->c_npts = 0;
     c->c_vectors = vectors;
     c->c_channames = channames;
+    c->c_fvectors = fvectors;
+    c->c_pool = 0;
+    c->c_usepool = 0;
+    c->c_stride = 1;
     c->c_disabled = 0;
     c->c_playable = 0;
     c->c_minsize = 1;
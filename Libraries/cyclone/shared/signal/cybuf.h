@@ -16,6 +16,15 @@
 
 #define CYBUF_MAXCHANS 64 //max number of channels
 
+#include "samplepool.h"
+
+//sample ndx of a channel, which is either an array (wp) or in a sample pool (fp)
+//only the one that isn't null is read
+#define CYBUF_GETSAMPLE(wp, fp, stride, ndx) \
+    ((fp) ? (t_float)(fp)[(size_t)(ndx) * (stride)] : (wp)[ndx].w_float)
+#define CYBUF_SETSAMPLE(wp, fp, stride, ndx, f) \
+    ((fp) ? (void)((fp)[(size_t)(ndx) * (stride)] = (float)(f)) : (void)((wp)[ndx].w_float = (f)))
+
 typedef struct _cybuf
 {
     //t_sic       s_sic;
@@ -33,6 +42,10 @@ typedef struct _cybuf
     int         c_single; //flag for single channel mode
                         //0-regular mode, 1-load this particular channel (1-idx)
                         //should be used with c_numchans == 1
+    int         c_usepool;  //owner reads sample pools, see cybuf_usepool
+    t_samplepool *c_pool;   //pool of c_bufname, c_vectors are all null when it's set
+    float     **c_fvectors; //channels of c_pool
+    int         c_stride;   //floats between two frames of c_fvectors
 } t_cybuf;
 
 void cybuf_bug(char *fmt, ...);
@@ -61,5 +74,8 @@ void cybuf_free(t_cybuf *c);
 //void cybuf_setup(t_class *c, void *dspfn, void *floatfn);
 void cybuf_checkdsp(t_cybuf *c);
 void cybuf_getchannel(t_cybuf *c, int chan_num, int complain);
+//look for a sample pool named like the buffer before the arrays
+//only for owners that read both c_vectors and c_fvectors
+void cybuf_usepool(t_cybuf *c);
 
 #endif
@@ -135,6 +135,11 @@ struct _instanceinter
     pd_panel_callback panel_callback;
     pd_synchronise_callback synchronise_callback;
     void* callback_target;
+
+    pd_free_callback free_callback;
+    void* free_target;
+
+    int i_headless;     /* nothing shows this instance's GUI */
     
     
 };
@@ -153,8 +158,102 @@ void register_gui_triggers(t_pdinstance* instance, void* target, pd_gui_callback
 
 }
 
+void register_free_trigger(t_pdinstance* instance, void* target, pd_free_callback free_callback) {
+
+#if !PDINSTANCE
+    instance = &pd_maininstance;
+#endif
+
+    instance->pd_inter->free_callback = free_callback;
+    instance->pd_inter->free_target = target;
+}
+
+/* the free methods we replaced, classes are never freed so neither are these */
+#define MAX_WATCHED_CLASSES 64
+
+/* entries are only ever appended: an entry is complete before the count that
+   includes it is stored, and the count is read before the entries, so lookups
+   need no lock. only watch_free() takes the mutex, to append */
+#ifdef _MSC_VER
+#define watched_load(p)     _InterlockedOr((p), 0)
+#define watched_store(p, v) _InterlockedExchange((p), (v))
+#else
+#define watched_load(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define watched_store(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+static t_class* watched_classes[MAX_WATCHED_CLASSES];
+static t_method watched_freemethods[MAX_WATCHED_CLASSES];
+static volatile long watched_nclasses = 0;
+#if PDTHREADS
+static pthread_mutex_t watched_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static int watched_find(t_class* cls)
+{
+    int i, n = (int)watched_load(&watched_nclasses);
+    for(i = 0; i < n; i++) {
+        if(watched_classes[i] == cls) return i;
+    }
+    return -1;
+}
+
+static void watched_free(t_pd* x)
+{
+    int i;
+
+    if(INTER->free_callback) {
+        INTER->free_callback(INTER->free_target, x);
+    }
+
+    /* called for every freed object of a watched class, often on the audio thread */
+    if((i = watched_find(*x)) >= 0) {
+        (*(t_gotfn)watched_freemethods[i])(x);
+    }
+}
+
+void watch_free(t_class* cls) {
+    int n;
+
+    if(watched_find(cls) >= 0) return;
+
+#if PDTHREADS
+    pthread_mutex_lock(&watched_mutex);
+#endif
+    n = (int)watched_nclasses;
+    if(watched_find(cls) < 0) {
+        if(n == MAX_WATCHED_CLASSES) {
+            bug("watch_free");
+        }
+        else {
+            watched_classes[n] = cls;
+            watched_freemethods[n] = cls->c_freemethod;
+            watched_store(&watched_nclasses, n + 1);
+            /* only redirect the free method once watched_free() can find the old one */
+            cls->c_freemethod = (t_method)watched_free;
+        }
+    }
+#if PDTHREADS
+    pthread_mutex_unlock(&watched_mutex);
+#endif
+}
+
+void set_gui_headless(t_pdinstance* instance, int headless) {
+
+#if !PDINSTANCE
+    instance = &pd_maininstance;
+#endif
+
+    instance->pd_inter->i_headless = headless;
+}
+
+int sys_headless(void)
+{
+    return (INTER->i_headless);
+}
+
 void update_gui(void* obj_target) {
-    if(pd_this->pd_inter->gui_callback) {
+    if(pd_this->pd_inter->gui_callback && !pd_this->pd_inter->i_headless) {
         pd_this->pd_inter->gui_callback(pd_this->pd_inter->callback_target, obj_target);
     }
 }
@@ -807,59 +906,73 @@ int sys_havegui(void)
     return (INTER->i_havegui);
 }
 
+    /* commands that plugdata handles itself, found by prefix.
+    returns nonzero if the command should be dropped without a GUI update */
+typedef int (*t_vguihook)(va_list args);
+
+static int sys_vgui_ignore(va_list args)
+{
+    return (1);
+}
+
+static int sys_vgui_savepanel(va_list args)
+{
+    const char* symbol = va_arg(args, const char*);
+    const char* path = va_arg(args, const char*);
+    create_panel(0, path, symbol);
+    return (0);
+}
+
+static int sys_vgui_openpanel(va_list args)
+{
+    const char* symbol = va_arg(args, const char*);
+    const char* path = va_arg(args, const char*);
+    create_panel(1, path, symbol);
+    return (0);
+}
+
+#define VGUI_HOOK(prefix, fn) { prefix, sizeof(prefix) - 1, fn }
+
+static const struct _vguihook
+{
+    const char *h_prefix;
+    size_t h_length;
+    t_vguihook h_fn;
+} sys_vguihooks[] =
+{
+        /* this call causes a circular loop, so ignore it */
+    VGUI_HOOK("pdtk_canvas_raise", sys_vgui_ignore),
+    VGUI_HOOK("pdtk_savepanel", sys_vgui_savepanel),
+    VGUI_HOOK("pdtk_openpanel", sys_vgui_openpanel),
+        /* pdtk_canvas_reflecttitle and pdtk_text_new could call
+        synchronise_canvas() for dynamic patching, disabled for now */
+};
+
+#define VGUI_NHOOKS (sizeof(sys_vguihooks) / sizeof(*sys_vguihooks))
+
 void sys_vgui(const char *fmt, ...)
 {
-    // This call causes a circular loop, so ignore it
-    if(strncmp(fmt, "pdtk_canvas_raise", strlen("pdtk_canvas_raise")) == 0) {
-        return;
-    }
-    
-    if(strncmp(fmt, "pdtk_savepanel", strlen("pdtk_savepanel")) == 0) {
-        
-        
-        va_list args;
-        va_start(args, fmt);
-        
-        const char* symbol = va_arg(args, const char*);
-        const char* path = va_arg(args, const char*);
-        
-        create_panel(0, path, symbol);
-        
-    }
-    if(strncmp(fmt, "pdtk_openpanel", strlen("pdtk_openpanel")) == 0) {
-        va_list args;
-        va_start(args, fmt);
-        
-        const char* symbol = va_arg(args, const char*);
-        const char* path = va_arg(args, const char*);
-        
-        create_panel(1, path, symbol);
-        
-    }
-    /* disabled for now, could be used for dynamic patching
-    if(strncmp(fmt, "pdtk_canvas_reflecttitle", strlen("pdtk_canvas_reflecttitle")) == 0) {
-        
-        va_list args;
-        va_start(args, fmt);
-        
-        t_canvas* cnv = va_arg(args, t_canvas*);
-        
-        synchronise_canvas(cnv);
+        /* all hooks are pdtk_ procedures, most calls are canvas commands */
+    if (fmt[0] == 'p' && !strncmp(fmt, "pdtk_", 5))
+    {
+        size_t i;
+        for (i = 0; i < VGUI_NHOOKS; i++)
+        {
+            if (!strncmp(fmt, sys_vguihooks[i].h_prefix, sys_vguihooks[i].h_length))
+            {
+                va_list args;
+                int drop;
+                va_start(args, fmt);
+                drop = sys_vguihooks[i].h_fn(args);
+                va_end(args);
+                if (drop)
+                    return;
+                break;
+            }
+        }
     }
-    if(strncmp(fmt, "pdtk_text_new", strlen("pdtk_text_new")) == 0) {
-        
-        va_list args;
-        va_start(args, fmt);
-        
-        t_canvas* cnv = va_arg(args, t_canvas*);
-        
-        synchronise_canvas(cnv);
-    } */
-
 
-    
-    
-    
+        /* the arguments are never formatted: there's no Tk to send them to */
     update_gui(NULL);
 }
 
@@ -1643,6 +1756,7 @@ void s_inter_newpdinstance(void)
     INTER->i_freq = 0;
 #endif
     INTER->i_havegui = 0;
+    INTER->i_headless = 0;
 }
 
 void s_inter_free(t_instanceinter *inter)
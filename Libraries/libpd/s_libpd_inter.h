@@ -5,5 +5,18 @@
 typedef void(*pd_gui_callback)(void*, void*);
 typedef void(*pd_panel_callback)(void*, int, const char*, const char*);
 typedef void(*pd_synchronise_callback)(void*, void*);
+typedef void(*pd_free_callback)(void*, void*);
 
 void register_gui_triggers(t_pdinstance* instance, void* target, pd_gui_callback gui_callback, pd_panel_callback panel_callback, pd_synchronise_callback synchronise_callback);
+
+/* Calls free_callback with the target and the object right before pd frees an object
+   of a class passed to watch_free(), however it gets freed. Classes are shared by all
+   instances, the callback of the instance that frees the object is called. */
+void register_free_trigger(t_pdinstance* instance, void* target, pd_free_callback free_callback);
+void watch_free(t_class* cls);
+
+/* Headless means no GUI shows this instance, not even plugdata's own.
+   GUI objects can check sys_headless() to skip their redraw work,
+   sys_vgui() and sys_gui() stop sending GUI updates. */
+void set_gui_headless(t_pdinstance* instance, int headless);
+int sys_headless(void);
@@ -11,8 +11,17 @@
 #include <m_imp.h>
 #include <g_canvas.h>
 #include <g_all_guis.h>
+#include <s_stuff.h>
 #include "x_libpd_multi.h"
 
+int sys_pollgui(void);
+
+// The start of pd's private clock struct in m_sched.c
+typedef struct _fake_clock
+{
+    double c_settime;
+} t_fake_clock;
+
 // False GARRAY
 typedef struct _fake_garray
 {
@@ -207,3 +216,47 @@ float libpd_get_canvas_font_height(t_canvas* cnv)
     }
     return glist_fontheight(cnv);
 }
+
+int libpd_process_channels(const t_sample* const* inputs, t_sample* const* outputs)
+{
+    int ch;
+    sys_lock();
+    sys_pollgui();
+    for (ch = 0; ch < STUFF->st_inchannels; ch++)
+    {
+        t_sample* in = STUFF->st_soundin + ch * DEFDACBLKSIZE;
+        if (inputs && inputs[ch])
+            memcpy(in, inputs[ch], DEFDACBLKSIZE * sizeof(t_sample));
+        else
+            memset(in, 0, DEFDACBLKSIZE * sizeof(t_sample));
+    }
+    memset(STUFF->st_soundout, 0, STUFF->st_outchannels * DEFDACBLKSIZE * sizeof(t_sample));
+    sched_tick();
+    for (ch = 0; ch < STUFF->st_outchannels; ch++)
+    {
+        if (outputs[ch])
+            memcpy(outputs[ch], STUFF->st_soundout + ch * DEFDACBLKSIZE, DEFDACBLKSIZE * sizeof(t_sample));
+    }
+    sys_unlock();
+    return 0;
+}
+
+int libpd_process_idle(void)
+{
+    double next_sys_time;
+    sys_lock();
+    next_sys_time = pd_this->pd_systime + STUFF->st_time_per_dsp_tick;
+
+    // A clock inside this tick could start something, leave it to a real tick
+    if (pd_this->pd_clock_setlist && ((t_fake_clock*)pd_this->pd_clock_setlist)->c_settime < next_sys_time)
+    {
+        sys_unlock();
+        return -1;
+    }
+
+    sys_pollgui();
+    memset(STUFF->st_soundout, 0, STUFF->st_outchannels * DEFDACBLKSIZE * sizeof(t_sample));
+    pd_this->pd_systime = next_sys_time;
+    sys_unlock();
+    return 0;
+}
@@ -38,6 +38,15 @@ void libpd_iemgui_set_label_color(void* ptr, const char* hex);
 
 float libpd_get_canvas_font_height(t_canvas* cnv);
 
+// Processes one tick with a pointer per adc~ and dac~ channel, so the samples don't have to be interleaved or staged first
+// A null input channel is silent, a null output channel is discarded, inputs may be null to make every input silent
+// Inputs may alias outputs, they are all read before the tick is processed
+int libpd_process_channels(const t_sample* const* inputs, t_sample* const* outputs);
+
+// Advances pd's logical time by one tick without running the dsp chain
+// Returns -1 without doing anything if a clock is due during the tick, that tick has to be processed normally
+int libpd_process_idle(void);
+
 
 #ifdef __cplusplus
 }
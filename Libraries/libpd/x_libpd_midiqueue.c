@@ -0,0 +1,127 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include <m_pd.h>
+#include <s_stuff.h>
+
+#include "x_libpd_midiqueue.h"
+
+#define LIBPD_MIDIQUEUE_SIZE 1024
+
+typedef struct _libpd_midievent
+{
+    double          e_time;
+    int             e_port;
+    int             e_size;
+    unsigned char   e_data[3];
+} t_libpd_midievent;
+
+typedef struct _libpd_midiqueue
+{
+    t_clock*            q_clock;
+    t_symbol*           q_midiin;   /* only send raw bytes when [midiin] exists */
+    int                 q_head;
+    int                 q_count;
+    t_libpd_midievent   q_events[LIBPD_MIDIQUEUE_SIZE];
+} t_libpd_midiqueue;
+
+static void libpd_midiqueue_deliver(t_libpd_midiqueue* x, int port, const unsigned char* data, int size)
+{
+    int status = data[0], channel = status & 0x0f;
+    int d1 = size > 1 ? data[1] & 0x7f : 0, d2 = size > 2 ? data[2] & 0x7f : 0, i;
+
+    if (status >= 0xf8)
+        inmidi_realtimein(port, status);
+    else switch (status & 0xf0)
+    {
+        case 0x80: inmidi_noteon(port, channel, d1, 0); break;
+        case 0x90: inmidi_noteon(port, channel, d1, d2); break;
+        case 0xa0: inmidi_polyaftertouch(port, channel, d1, d2); break;
+        case 0xb0: inmidi_controlchange(port, channel, d1, d2); break;
+        case 0xc0: inmidi_programchange(port, channel, d1); break;
+        case 0xd0: inmidi_aftertouch(port, channel, d1); break;
+        case 0xe0: inmidi_pitchbend(port, channel, (d2 << 7) | d1); break;
+        default: break;
+    }
+
+    if (x->q_midiin->s_thing)
+    {
+        for (i = 0; i < size; i++)
+            inmidi_byte(port, data[i]);
+    }
+}
+
+static void libpd_midiqueue_tick(t_libpd_midiqueue* x)
+{
+    double now = clock_getlogicaltime();
+    while (x->q_count && x->q_events[x->q_head].e_time <= now)
+    {
+        t_libpd_midievent* e = &x->q_events[x->q_head];
+        x->q_head = (x->q_head + 1) % LIBPD_MIDIQUEUE_SIZE;
+        x->q_count--;
+        libpd_midiqueue_deliver(x, e->e_port, e->e_data, e->e_size);
+    }
+    if (x->q_count)
+        clock_set(x->q_clock, x->q_events[x->q_head].e_time);
+}
+
+void* libpd_midiqueue_new(void)
+{
+    t_libpd_midiqueue* x = (t_libpd_midiqueue*)getbytes(sizeof(t_libpd_midiqueue));
+    x->q_clock = clock_new(x, (t_method)libpd_midiqueue_tick);
+    x->q_midiin = gensym("#midiin");
+    x->q_head = x->q_count = 0;
+    return x;
+}
+
+void libpd_midiqueue_free(void* queue)
+{
+    t_libpd_midiqueue* x = (t_libpd_midiqueue*)queue;
+    clock_free(x->q_clock);
+    freebytes(x, sizeof(t_libpd_midiqueue));
+}
+
+void libpd_midiqueue_add(void* queue, int offset, int port, const unsigned char* data, int size)
+{
+    t_libpd_midiqueue* x = (t_libpd_midiqueue*)queue;
+    t_libpd_midievent* e;
+    int i;
+    if (size < 1 || size > 3) return;
+
+    sys_lock();
+        /* events at the start of the tick don't need the clock, and if the
+           queue is full we'd rather be early than drop them */
+    if ((offset <= 0 && !x->q_count) || x->q_count == LIBPD_MIDIQUEUE_SIZE)
+    {
+        libpd_midiqueue_deliver(x, port, data, size);
+        sys_unlock();
+        return;
+    }
+    e = &x->q_events[(x->q_head + x->q_count) % LIBPD_MIDIQUEUE_SIZE];
+    e->e_time = clock_getsystimeafter(offset * 1000. / sys_getsr());
+    e->e_port = port;
+    e->e_size = size;
+    for (i = 0; i < size; i++)
+        e->e_data[i] = data[i];
+    if (!x->q_count++)
+        clock_set(x->q_clock, e->e_time);
+    sys_unlock();
+}
+
+void libpd_midiqueue_sysex(void* queue, int port, const unsigned char* data, int size)
+{
+    t_libpd_midiqueue* x = (t_libpd_midiqueue*)queue;
+    int i;
+    sys_lock();
+    for (i = 0; i < size; i++)
+        inmidi_sysex(port, data[i]);
+    if (x->q_midiin->s_thing)
+    {
+        for (i = 0; i < size; i++)
+            inmidi_byte(port, data[i]);
+    }
+    sys_unlock();
+}
@@ -0,0 +1,30 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Delivers incoming midi at its position inside the next pd tick.
+   Events are timestamped with a sample offset from the start of the tick and
+   scheduled on a clock, so [notein], [ctlin] and friends fire at the logical
+   time of the event, the same way vline~ gets sample accuracy.
+   Create and free with the pd instance set, the other calls lock the instance. */
+void* libpd_midiqueue_new(void);
+void libpd_midiqueue_free(void* queue);
+
+/* a channel or realtime message of 1 to 3 bytes, offset is in samples */
+void libpd_midiqueue_add(void* queue, int offset, int port, const unsigned char* data, int size);
+
+/* sysex is delivered immediately */
+void libpd_midiqueue_sysex(void* queue, int port, const unsigned char* data, int size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -666,12 +666,14 @@ void rotate_tilde_setup();
 void routeall_setup();
 void router_setup();
 void routetype_setup();
+void samplepool_setup();
 void saw_tilde_setup();
 void saw2_tilde_setup();
 void schmitt_tilde_setup();
 void selector_setup();
 void separate_setup();
 void sequencer_tilde_setup();
+void sfplayer_tilde_setup();
 void sh_tilde_setup();
 void shaper_tilde_setup();
 void sig2float_tilde_setup();
@@ -1131,12 +1133,14 @@ void libpd_multi_init(void)
         routeall_setup();
         router_setup();
         routetype_setup();
+        samplepool_setup();
         saw_tilde_setup();
         saw2_tilde_setup();
         schmitt_tilde_setup();
         selector_setup();
         separate_setup();
         sequencer_tilde_setup();
+        sfplayer_tilde_setup();
         sh_tilde_setup();
         shaper_tilde_setup();
         sig2float_tilde_setup();
@@ -0,0 +1,44 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include <m_pd.h>
+
+#include "x_libpd_scope.h"
+
+#define LIBPD_MAXSCOPECLASSES 8
+
+static t_class* libpd_scope_classes[LIBPD_MAXSCOPECLASSES];
+static size_t libpd_scope_offsets[LIBPD_MAXSCOPECLASSES];
+static int libpd_scope_nclasses = 0;
+
+void libpd_scope_register(t_class* cls, size_t offset)
+{
+    int i;
+    for (i = 0; i < libpd_scope_nclasses; i++)
+    {
+        if (libpd_scope_classes[i] == cls) return;
+    }
+    if (libpd_scope_nclasses == LIBPD_MAXSCOPECLASSES)
+    {
+        bug("libpd_scope_register");
+        return;
+    }
+    libpd_scope_classes[libpd_scope_nclasses] = cls;
+    libpd_scope_offsets[libpd_scope_nclasses] = offset;
+    libpd_scope_nclasses++;
+}
+
+t_libpd_scope* libpd_scope_get(void* ptr)
+{
+    int i;
+    if (!ptr) return 0;
+    for (i = 0; i < libpd_scope_nclasses; i++)
+    {
+        if (*(t_pd*)ptr == libpd_scope_classes[i])
+            return (t_libpd_scope*)((char*)ptr + libpd_scope_offsets[i]);
+    }
+    return 0;
+}
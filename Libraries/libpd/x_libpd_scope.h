@@ -0,0 +1,43 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <m_pd.h>
+
+/* Lets plugdata draw a scope natively instead of through Tk.
+   A scope object embeds a t_libpd_scope that points at its own last complete
+   frame and settings, and registers the offset of that field with its class.
+   Only pd's thread touches these, plugdata copies them after every tick. */
+typedef struct _libpd_scope
+{
+    unsigned int           s_frame;    /* incremented for every complete frame */
+    int                    s_watched;  /* set while plugdata draws this scope */
+    const float           *s_x;        /* last frame, first signal */
+    const float           *s_y;        /* last frame, second signal */
+    const int             *s_npoints;
+    const int             *s_xymode;   /* 0 = no signal, 1 = x only, 2 = y only, 3 = both */
+    const float           *s_min;
+    const float           *s_max;
+    const unsigned char   *s_bg;       /* rgb colours */
+    const unsigned char   *s_fg;
+    const unsigned char   *s_grid;
+} t_libpd_scope;
+
+void libpd_scope_register(t_class* cls, size_t offset);
+
+/* returns 0 if ptr isn't a registered scope */
+t_libpd_scope* libpd_scope_get(void* ptr);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,151 @@
+/* Copyright (c) 2022 Timothy Schoen and others.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* Elementwise kernels for the binary signal operators, shared by ELSE's [op~]
+   and cyclone's comparison, bitwise, [maximum~] and [minimum~] objects.
+   Every operator comes as binop_<name>() for two signals and binop_<name>_scalar()
+   for a signal and a float, the objects take the scalar one when nothing is
+   connected to the right inlet so that buffer isn't read at all.
+   The loops have no branches and no calls, so the compiler vectorizes them for
+   the instruction set the build targets.  Comparisons and logic give 0 or 1.
+   Output may be the same buffer as an input. */
+
+#ifndef __BINOP_H__
+#define __BINOP_H__
+
+#include <math.h>
+#include <stdint.h>
+
+typedef void (*t_binop)(int n, const t_sample *in1, const t_sample *in2,
+    t_sample *out);
+typedef void (*t_binop_scalar)(int n, const t_sample *in1, t_sample f,
+    t_sample *out);
+
+#define BINOP_KERNELS(name, expr)                                           \
+static inline void binop_##name(int n, const t_sample *in1,                 \
+    const t_sample *in2, t_sample *out)                                     \
+{                                                                           \
+    int i;                                                                  \
+    for (i = 0; i < n; i++)                                                 \
+    {                                                                       \
+        t_sample a = in1[i], b = in2[i];                                    \
+        out[i] = (expr);                                                    \
+    }                                                                       \
+}                                                                           \
+static inline void binop_##name##_scalar(int n, const t_sample *in1,        \
+    t_sample b, t_sample *out)                                              \
+{                                                                           \
+    int i;                                                                  \
+    for (i = 0; i < n; i++)                                                 \
+    {                                                                       \
+        t_sample a = in1[i];                                                \
+        out[i] = (expr);                                                    \
+    }                                                                       \
+}
+
+BINOP_KERNELS(lt, (t_sample)(a < b))
+BINOP_KERNELS(gt, (t_sample)(a > b))
+BINOP_KERNELS(le, (t_sample)(a <= b))
+BINOP_KERNELS(ge, (t_sample)(a >= b))
+BINOP_KERNELS(ne, (t_sample)(a != b))
+BINOP_KERNELS(eq, (t_sample)(a == b))
+BINOP_KERNELS(and, (t_sample)((a != 0) & (b != 0)))
+BINOP_KERNELS(or, (t_sample)((a != 0) | (b != 0)))
+BINOP_KERNELS(bitand, (t_sample)((int32_t)a & (int32_t)b))
+BINOP_KERNELS(bitor, (t_sample)((int32_t)a | (int32_t)b))
+BINOP_KERNELS(bitxor, (t_sample)((int32_t)a ^ (int32_t)b))
+BINOP_KERNELS(shiftleft, (t_sample)((int32_t)a << (int32_t)b))
+BINOP_KERNELS(shiftright, (t_sample)((int32_t)a >> (int32_t)b))
+BINOP_KERNELS(max, (a > b ? a : b))
+BINOP_KERNELS(min, (a < b ? a : b))
+
+    /* fmod() is a call, this one doesn't vectorize */
+BINOP_KERNELS(mod, (b == 0 ? 0. : fmod(a, b)))
+
+    /* unary, the second input is ignored */
+static inline void binop_bitnot(int n, const t_sample *in1,
+    const t_sample *in2, t_sample *out)
+{
+    int i;
+    for (i = 0; i < n; i++)
+        out[i] = (t_sample)(~(int32_t)in1[i]);
+}
+
+static inline void binop_bitnot_scalar(int n, const t_sample *in1,
+    t_sample f, t_sample *out)
+{
+    binop_bitnot(n, in1, 0, out);
+}
+
+    /* cyclone's [bitand~], [bitor~] and [bitxor~] can also take an input bit for
+       bit, as the 32 bits of a single precision float.  A result made of such bits is
+       read back as that float, and is 0 where its exponent is 0, so it is never
+       denormal.  Their modes pick the kernel: 0 takes both inputs as bits, 1 converts
+       both to ints, 2 takes the left as bits and 3 the right.  Without a signal on
+       the right inlet they apply an int mask, to the left converted or as bits. */
+typedef void (*t_binop_mask)(int n, const t_sample *in1, int32_t mask,
+    t_sample *out);
+
+typedef union _binop_bits
+{
+    int32_t b_int;
+    float b_float;
+} t_binop_bits;
+
+static inline int32_t binop_tobits(t_sample f)
+{
+    t_binop_bits u;
+    u.b_float = (float)f;
+    return (u.b_int);
+}
+
+static inline t_sample binop_frombits(int32_t i)
+{
+    t_binop_bits u;
+    u.b_int = i;
+    return ((i & 0x7f800000) ? (t_sample)u.b_float : 0);
+}
+
+#define BINOP_BITS_KERNELS(name, op)                                        \
+static inline void binop_##name##_bits(int n, const t_sample *in1,          \
+    const t_sample *in2, t_sample *out)                                     \
+{                                                                           \
+    int i;                                                                  \
+    for (i = 0; i < n; i++)                                                 \
+        out[i] = binop_frombits(binop_tobits(in1[i]) op binop_tobits(in2[i])); \
+}                                                                           \
+static inline void binop_##name##_bitsint(int n, const t_sample *in1,       \
+    const t_sample *in2, t_sample *out)                                     \
+{                                                                           \
+    int i;                                                                  \
+    for (i = 0; i < n; i++)                                                 \
+        out[i] = binop_frombits(binop_tobits(in1[i]) op (int32_t)in2[i]);   \
+}                                                                           \
+static inline void binop_##name##_intbits(int n, const t_sample *in1,       \
+    const t_sample *in2, t_sample *out)                                     \
+{                                                                           \
+    int i;                                                                  \
+    for (i = 0; i < n; i++)                                                 \
+        out[i] = (t_sample)((int32_t)in1[i] op binop_tobits(in2[i]));       \
+}                                                                           \
+static inline void binop_##name##_mask(int n, const t_sample *in1,          \
+    int32_t mask, t_sample *out)                                            \
+{                                                                           \
+    int i;                                                                  \
+    for (i = 0; i < n; i++)                                                 \
+        out[i] = (t_sample)((int32_t)in1[i] op mask);                       \
+}                                                                           \
+static inline void binop_##name##_bits_mask(int n, const t_sample *in1,     \
+    int32_t mask, t_sample *out)                                            \
+{                                                                           \
+    int i;                                                                  \
+    for (i = 0; i < n; i++)                                                 \
+        out[i] = binop_frombits(binop_tobits(in1[i]) op mask);              \
+}
+
+BINOP_BITS_KERNELS(bitand, &)
+BINOP_BITS_KERNELS(bitor, |)
+BINOP_BITS_KERNELS(bitxor, ^)
+
+#endif
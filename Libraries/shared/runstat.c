@@ -0,0 +1,249 @@
+/* Copyright (c) 2022 Timothy Schoen and others.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+#include <string.h>
+#include <math.h>
+#include "m_pd.h"
+#include "runstat.h"
+
+#define RUNSTAT_LOGTEN 2.302585092994
+
+static inline double runstat_value(int mode, t_sample f)
+{
+    return (mode == RUNSTAT_SQUARE ? (double)f * f :
+        mode == RUNSTAT_ABSOLUTE ? fabs(f) : f);
+}
+
+    /* the input k steps back, 0 is the last one */
+static inline t_sample runstat_back(t_runstat *r, int k)
+{
+    int i = r->r_wr - 1 - k;
+    return (r->r_ring[i < 0 ? i + r->r_size : i]);
+}
+
+static double runstat_sum(t_runstat *r, int from, int to)
+{
+    double sum = 0;
+    int k;
+    for (k = from; k < to; k++)
+        sum += runstat_value(r->r_mode, runstat_back(r, k));
+    return (sum);
+}
+
+static void runstat_restart(t_runstat *r)
+{
+    r->r_rd = r->r_wr - r->r_n;
+    if (r->r_rd < 0)
+        r->r_rd += r->r_size;
+    r->r_calib = 0;
+    r->r_since = 0;
+}
+
+void runstat_init(t_runstat *r, int mode)
+{
+    memset(r, 0, sizeof(*r));
+    r->r_mode = mode;
+    r->r_n = 1;
+    r->r_scale = 1.;
+    r->r_hold = 1;
+}
+
+void runstat_free(t_runstat *r)
+{
+    if (r->r_ring)
+        freebytes(r->r_ring, r->r_size * sizeof(t_sample));
+    r->r_ring = 0;
+    r->r_size = 0;
+}
+
+int runstat_resize(t_runstat *r, int size)
+{
+    runstat_free(r);
+    if (size < 1 || !(r->r_ring = (t_sample *)getbytes(size * sizeof(t_sample))))
+        return (0);
+    r->r_size = size;
+    if (r->r_n > size)
+    {
+        r->r_n = size;
+        r->r_scale = 1. / size;
+    }
+    runstat_clear(r);
+    return (1);
+}
+
+void runstat_clear(t_runstat *r)
+{
+    if (r->r_ring)
+        memset(r->r_ring, 0, r->r_size * sizeof(t_sample));
+    r->r_wr = 0;
+    r->r_sum = 0;
+    r->r_holdphase = 0;
+    r->r_held = 0;
+    runstat_restart(r);
+}
+
+void runstat_mode(t_runstat *r, int mode)
+{
+    r->r_mode = mode;
+    if (r->r_ring)
+    {
+        r->r_sum = runstat_sum(r, 0, r->r_n);
+        runstat_restart(r);
+    }
+}
+
+void runstat_window(t_runstat *r, int n)
+{
+    int n0 = r->r_n;
+    if (n > r->r_size)
+        n = r->r_size;
+    if (n < 1)
+        n = 1;
+    if (n == n0 || !r->r_ring)
+        return;
+        /* add or take what changed, or start over if that's shorter */
+    if (n > n0 && n - n0 < n)
+        r->r_sum += runstat_sum(r, n0, n);
+    else if (n < n0 && n0 - n < n)
+        r->r_sum -= runstat_sum(r, n, n0);
+    else r->r_sum = runstat_sum(r, 0, n);
+    r->r_n = n;
+    r->r_scale = 1. / n;
+    runstat_restart(r);
+}
+
+void runstat_hold(t_runstat *r, int hold)
+{
+    r->r_hold = (hold < 1 ? 1 : hold);
+    r->r_holdphase = 0;
+}
+
+static inline int runstat_clip(t_sample f, int size)
+{
+    if (!(f >= 1))
+        return (1);
+    return (f >= size ? size : (int)f);
+}
+
+    /* the running sum is one add per input, so this loop can't be split across
+       samples, it is written once per mode to keep the branch out of it */
+static inline void runstat_scan(t_runstat *r, int nblock, const t_sample *in,
+    const t_sample *nvec, t_sample *out, int mode)
+{
+    t_sample *ring = r->r_ring;
+    int size = r->r_size, wr = r->r_wr, rd = r->r_rd;
+    int n = r->r_n, since = r->r_since, i;
+    double sum = r->r_sum, calib = r->r_calib, scale = r->r_scale;
+    for (i = 0; i < nblock; i++)
+    {
+        t_sample f = in[i];
+        double v;
+        if (nvec)
+        {
+            int m = runstat_clip(nvec[i], size);
+            if (m != n)
+            {
+                r->r_wr = wr;
+                r->r_sum = sum;
+                runstat_window(r, m);
+                n = r->r_n, rd = r->r_rd, since = r->r_since;
+                sum = r->r_sum, calib = r->r_calib, scale = r->r_scale;
+            }
+        }
+        v = runstat_value(mode, f);
+        sum += v - runstat_value(mode, ring[rd]);
+        calib += v;
+        ring[wr] = f;
+        if (++since >= n)
+        {
+                /* calib now covers the window, and has no rounding history */
+            sum = calib;
+            calib = 0;
+            since = 0;
+        }
+        out[i] = sum * scale;
+        if (++wr == size)
+            wr = 0;
+        if (++rd == size)
+            rd = 0;
+    }
+    r->r_wr = wr;
+    r->r_rd = rd;
+    r->r_since = since;
+    r->r_sum = sum;
+    r->r_calib = calib;
+}
+
+void runstat_perform(t_runstat *r, int nblock, const t_sample *in,
+    const t_sample *nvec, t_sample *out)
+{
+    if (nvec && r->r_ring)
+    {
+            /* a window that doesn't move is set once for the block */
+        int i, moves = 0;
+        for (i = 1; i < nblock; i++)
+            moves |= (nvec[i] != nvec[0]);
+        if (!moves)
+        {
+            runstat_window(r, runstat_clip(nvec[0], r->r_size));
+            nvec = 0;
+        }
+    }
+    if (!r->r_ring)
+        memset(out, 0, nblock * sizeof(t_sample));
+    else if (r->r_mode == RUNSTAT_SQUARE)
+        runstat_scan(r, nblock, in, nvec, out, RUNSTAT_SQUARE);
+    else if (r->r_mode == RUNSTAT_ABSOLUTE)
+        runstat_scan(r, nblock, in, nvec, out, RUNSTAT_ABSOLUTE);
+    else runstat_scan(r, nblock, in, nvec, out, RUNSTAT_BIPOLAR);
+}
+
+static inline t_sample runstat_root(t_sample mean)
+{
+    return (mean > 0 ? sqrt(mean) : 0);
+}
+
+    /* the root isn't rounded to a sample first, like [mov.rms~] always did */
+static inline t_sample runstat_db(t_sample mean)
+{
+    double db = 20. * log(mean > 0 ? sqrt(mean) : 0) / RUNSTAT_LOGTEN;
+    return (db < -999 ? -999 : db);
+}
+
+static t_sample runstat_apply(t_sample mean, int what)
+{
+    if (what == RUNSTAT_ROOT)
+        return (runstat_root(mean));
+    else if (what == RUNSTAT_DB)
+        return (runstat_db(mean));
+    else return (mean);
+}
+
+void runstat_output(t_runstat *r, int nblock, int what, t_sample *out)
+{
+    int i;
+    if (r->r_hold > 1)
+    {
+            /* the mean is only turned into output once per hold */
+        int phase = r->r_holdphase;
+        t_sample held = r->r_held;
+        for (i = 0; i < nblock; i++)
+        {
+            if (!phase)
+                held = runstat_apply(out[i], what);
+            out[i] = held;
+            if (++phase >= r->r_hold)
+                phase = 0;
+        }
+        r->r_holdphase = phase;
+        r->r_held = held;
+    }
+        /* separate loops so the root can be vectorized */
+    else if (what == RUNSTAT_ROOT)
+        for (i = 0; i < nblock; i++)
+            out[i] = runstat_root(out[i]);
+    else if (what == RUNSTAT_DB)
+        for (i = 0; i < nblock; i++)
+            out[i] = runstat_db(out[i]);
+}
@@ -0,0 +1,64 @@
+/* Copyright (c) 2022 Timothy Schoen and others.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* Moving window statistics, shared by [average~], [mov.avg~] and [mov.rms~].
+   The ring keeps the last r_size inputs and the sum of the last r_n of them is
+   kept while they come in.  Next to the running sum a second one restarts every
+   r_n inputs, when it covers the whole window it replaces the running sum, so
+   rounding errors never pile up for longer than one window.  A new window length
+   adds or takes the inputs it gains or loses from the ring, the history is kept.
+   Nothing is allocated after runstat_resize(), the perform routine never does.
+
+   Usage:
+   - runstat_resize() for the longest window, from the new method or a message
+   - runstat_perform() writes the mean of the window after every input
+   - runstat_output() turns the means into the output, optionally held for
+     r_hold samples so the root and the log are only taken once per hold
+*/
+
+#ifndef __RUNSTAT_H__
+#define __RUNSTAT_H__
+
+#define RUNSTAT_BIPOLAR   0  /* mean of x */
+#define RUNSTAT_ABSOLUTE  1  /* mean of |x| */
+#define RUNSTAT_SQUARE    2  /* mean of x * x */
+
+#define RUNSTAT_MEAN      0
+#define RUNSTAT_ROOT      1  /* root of the mean, 0 if rounding made it negative */
+#define RUNSTAT_DB        2  /* root in dB, -999 for silence */
+
+typedef struct _runstat
+{
+    t_sample  *r_ring;       /* the last r_size inputs */
+    int        r_size;
+    int        r_wr;         /* where the next input goes */
+    int        r_rd;         /* input that leaves the window next */
+    int        r_n;          /* window length */
+    double     r_scale;      /* 1 / r_n */
+    int        r_mode;
+    double     r_sum;        /* of the window */
+    double     r_calib;      /* of the r_since last inputs */
+    int        r_since;
+    int        r_hold;       /* output a new value every r_hold samples */
+    int        r_holdphase;
+    t_sample   r_held;
+} t_runstat;
+
+void runstat_init(t_runstat *r, int mode);
+void runstat_free(t_runstat *r);
+
+/* clears, returns 0 if allocation failed */
+int runstat_resize(t_runstat *r, int size);
+void runstat_clear(t_runstat *r);
+void runstat_mode(t_runstat *r, int mode);
+void runstat_window(t_runstat *r, int n);  /* clipped to 1 and r_size */
+void runstat_hold(t_runstat *r, int hold);
+
+/* nvec is the window length for every input, 0 to keep r_n */
+void runstat_perform(t_runstat *r, int nblock, const t_sample *in,
+    const t_sample *nvec, t_sample *out);
+/* in place, what for one of RUNSTAT_MEAN, RUNSTAT_ROOT and RUNSTAT_DB */
+void runstat_output(t_runstat *r, int nblock, int what, t_sample *out);
+
+#endif
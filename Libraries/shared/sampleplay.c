@@ -0,0 +1,212 @@
+/* Copyright (c) 2022 Timothy Schoen and others.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+#include <string.h>
+#include "m_pd.h"
+#include "sampleplay.h"
+
+static void sampleplay_freebuffers(t_sampleplay *p)
+{
+    int n = p->s_maxn;
+    if (p->s_runstart) freebytes(p->s_runstart, (n + 1) * sizeof(int));
+    if (p->s_runkind) freebytes(p->s_runkind, n * sizeof(int));
+    if (p->s_phase) freebytes(p->s_phase, n * sizeof(double));
+    if (p->s_gain) freebytes(p->s_gain, n * sizeof(double));
+    if (p->s_xphase) freebytes(p->s_xphase, n * sizeof(double));
+    if (p->s_xgain) freebytes(p->s_xgain, n * sizeof(double));
+    if (p->s_ndx) freebytes(p->s_ndx, n * sizeof(int));
+    if (p->s_frac) freebytes(p->s_frac, n * sizeof(float));
+    if (p->s_xndx) freebytes(p->s_xndx, n * sizeof(int));
+    if (p->s_xfrac) freebytes(p->s_xfrac, n * sizeof(float));
+}
+
+void sampleplay_init(t_sampleplay *p, float sixth, int floatsteps)
+{
+    memset(p, 0, sizeof(*p));
+    p->s_sixth = sixth;
+    p->s_floatsteps = floatsteps;
+}
+
+void sampleplay_free(t_sampleplay *p)
+{
+    sampleplay_freebuffers(p);
+    sampleplay_init(p, p->s_sixth, p->s_floatsteps);
+}
+
+int sampleplay_setup(t_sampleplay *p, int maxn)
+{
+    if (maxn == p->s_maxn && p->s_phase)
+        return (1);
+    sampleplay_free(p);
+    if (maxn < 1)
+        return (0);
+    p->s_maxn = maxn;
+    p->s_runstart = (int *)getbytes((maxn + 1) * sizeof(int));
+    p->s_runkind = (int *)getbytes(maxn * sizeof(int));
+    p->s_phase = (double *)getbytes(maxn * sizeof(double));
+    p->s_gain = (double *)getbytes(maxn * sizeof(double));
+    p->s_xphase = (double *)getbytes(maxn * sizeof(double));
+    p->s_xgain = (double *)getbytes(maxn * sizeof(double));
+    p->s_ndx = (int *)getbytes(maxn * sizeof(int));
+    p->s_frac = (float *)getbytes(maxn * sizeof(float));
+    p->s_xndx = (int *)getbytes(maxn * sizeof(int));
+    p->s_xfrac = (float *)getbytes(maxn * sizeof(float));
+    if (!p->s_runstart || !p->s_runkind || !p->s_phase || !p->s_gain
+        || !p->s_xphase || !p->s_xgain || !p->s_ndx || !p->s_frac
+        || !p->s_xndx || !p->s_xfrac)
+    {
+        sampleplay_free(p);
+        return (0);
+    }
+    return (1);
+}
+
+    /* positions outside the table read index 0, CHECKED in [play~] */
+static void sampleplay_index(const double *phase, int *ndxp, float *fracp,
+    int start, int end, int maxindex)
+{
+    int i;
+    for (i = start; i < end; i++)
+    {
+        double ph = phase[i];
+        int ndx;
+        float frac;
+        if (ph < 0 || ph > maxindex)
+            ph = 0;
+        ndx = (int)ph;
+        if (ndx < 1)
+            ndx = 1, frac = 0;
+        else if (ndx > maxindex)
+            ndx = maxindex, frac = 1;
+        else frac = ph - ndx;
+        ndxp[i] = ndx;
+        fracp[i] = frac;
+    }
+}
+
+    /* the objects did their arithmetic in this order and precision,
+       keep it so the output stays the same */
+static inline double sampleplay_cubic(float a, float b, float c, float d, float f, float sixth)
+{
+    float cmb = c - b;
+    return (b + f * (cmb - sixth * (1. - f) * ((d - a - 3.0f * cmb) * f + (d + 2.0f * a - 3.0f * b))));
+}
+
+static inline double sampleplay_read(const t_word *vp, int ndx, float f, float sixth)
+{
+    float a, b, c, d;
+    if (!vp)
+        return (0.);
+    vp += ndx;
+    a = vp[-1].w_float;
+    b = vp[0].w_float;
+    c = vp[1].w_float;
+    d = vp[2].w_float;
+    return (sampleplay_cubic(a, b, c, d, f, sixth));
+}
+
+    /* same from a sample pool channel, frames are stride floats apart */
+static inline double sampleplay_readpool(const float *fp, int stride, int ndx, float f, float sixth)
+{
+    float a, b, c, d;
+    fp += (size_t)ndx * stride;
+    a = fp[-stride];
+    b = fp[0];
+    c = fp[stride];
+    d = fp[2 * stride];
+    return (sampleplay_cubic(a, b, c, d, f, sixth));
+}
+
+    /* fills one channel from the plan, READ(ndx, frac) reads the channel */
+#define SAMPLEPLAY_RUNS(READ) \
+    for (r = 0; r < p->s_nruns; r++) \
+    { \
+        int start = p->s_runstart[r], end = p->s_runstart[r + 1]; \
+        switch (p->s_runkind[r]) \
+        { \
+        case SAMPLEPLAY_SILENT: \
+            for (i = start; i < end; i++) \
+                out[i] = 0; \
+            break; \
+        case SAMPLEPLAY_READ: \
+            for (i = start; i < end; i++) \
+                out[i] = READ(ndx[i], frac[i]); \
+            break; \
+        case SAMPLEPLAY_FADE: \
+            if (p->s_floatsteps) \
+            { \
+                for (i = start; i < end; i++) \
+                { \
+                    t_float f = READ(ndx[i], frac[i]); \
+                    out[i] = f * gain[i]; \
+                } \
+            } \
+            else \
+            { \
+                for (i = start; i < end; i++) \
+                    out[i] = READ(ndx[i], frac[i]) * gain[i]; \
+            } \
+            break; \
+        case SAMPLEPLAY_XFADE: \
+            if (p->s_floatsteps) \
+            { \
+                for (i = start; i < end; i++) \
+                { \
+                    t_float f = READ(ndx[i], frac[i]); \
+                    f *= gain[i]; \
+                    f += READ(xndx[i], xfrac[i]) * xgain[i]; \
+                    out[i] = f; \
+                } \
+            } \
+            else \
+            { \
+                for (i = start; i < end; i++) \
+                { \
+                    double f = READ(ndx[i], frac[i]); \
+                    f *= gain[i]; \
+                    f += READ(xndx[i], xfrac[i]) * xgain[i]; \
+                    out[i] = f; \
+                } \
+            } \
+            break; \
+        } \
+    }
+
+void sampleplay_perform(t_sampleplay *p, t_word **vectors, float **fvectors,
+    int stride, int npts, t_float **outs, int nchans)
+{
+    int maxindex = npts - 3, r, ch, i;
+    float sixth = p->s_sixth;
+    p->s_runstart[p->s_nruns] = p->s_n;
+        /* read positions are the same for every channel */
+    for (r = 0; r < p->s_nruns; r++)
+    {
+        int start = p->s_runstart[r], end = p->s_runstart[r + 1];
+        if (p->s_runkind[r] != SAMPLEPLAY_SILENT)
+            sampleplay_index(p->s_phase, p->s_ndx, p->s_frac, start, end, maxindex);
+        if (p->s_runkind[r] == SAMPLEPLAY_XFADE)
+            sampleplay_index(p->s_xphase, p->s_xndx, p->s_xfrac, start, end, maxindex);
+    }
+    for (ch = 0; ch < nchans; ch++)
+    {
+        const t_word *vp = vectors[ch];
+        const float *fp = fvectors ? fvectors[ch] : 0;
+        t_float *out = outs[ch];
+        const int *ndx = p->s_ndx, *xndx = p->s_xndx;
+        const float *frac = p->s_frac, *xfrac = p->s_xfrac;
+        const double *gain = p->s_gain, *xgain = p->s_xgain;
+#define SAMPLEPLAY_READWORD(n, f) sampleplay_read(vp, n, f, sixth)
+#define SAMPLEPLAY_READPOOL(n, f) sampleplay_readpool(fp, stride, n, f, sixth)
+        if (fp)
+        {
+            SAMPLEPLAY_RUNS(SAMPLEPLAY_READPOOL)
+        }
+        else
+        {
+            SAMPLEPLAY_RUNS(SAMPLEPLAY_READWORD)
+        }
+#undef SAMPLEPLAY_READWORD
+#undef SAMPLEPLAY_READPOOL
+    }
+}
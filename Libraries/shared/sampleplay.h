@@ -0,0 +1,77 @@
+/* Copyright (c) 2022 Timothy Schoen and others.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* Multichannel sample playback, shared by [play~] and [tabplayer~].
+   The object resolves its transport (triggers, bounds, loops and fades) once per
+   sample and adds a step to the plan, consecutive steps of the same kind form a run.
+   sampleplay_perform() then reads every channel with one tight loop per run,
+   the read positions are only computed once for all channels.
+
+   Usage:
+   - sampleplay_setup() from the dsp method, it allocates for the block size
+   - sampleplay_begin() at the start of the perform routine
+   - sampleplay_add() for every sample of the block
+   - sampleplay_perform() to write the outputs
+*/
+
+#ifndef __SAMPLEPLAY_H__
+#define __SAMPLEPLAY_H__
+
+#define SAMPLEPLAY_SILENT 0  /* zero */
+#define SAMPLEPLAY_READ   1  /* read(phase) */
+#define SAMPLEPLAY_FADE   2  /* read(phase) * gain */
+#define SAMPLEPLAY_XFADE  3  /* read(phase) * gain + read(xphase) * xgain */
+
+typedef struct _sampleplay
+{
+    int        s_maxn;       /* allocated steps */
+    int        s_n;          /* steps in the current plan */
+    int        s_nruns;
+    int       *s_runstart;   /* first step of every run, s_nruns + 1 entries */
+    int       *s_runkind;
+    double    *s_phase;
+    double    *s_gain;
+    double    *s_xphase;
+    double    *s_xgain;
+    int       *s_ndx;        /* read index and fraction of every step, for phase and xphase */
+    float     *s_frac;
+    int       *s_xndx;
+    float     *s_xfrac;
+    float      s_sixth;      /* coefficient of the cubic, the objects don't use the same one */
+    int        s_floatsteps; /* round to a float after every step, like [tabplayer~] always did */
+} t_sampleplay;
+
+void sampleplay_init(t_sampleplay *p, float sixth, int floatsteps);
+void sampleplay_free(t_sampleplay *p);
+
+/* returns 0 if allocation failed */
+int sampleplay_setup(t_sampleplay *p, int maxn);
+
+static inline void sampleplay_begin(t_sampleplay *p)
+{
+    p->s_n = p->s_nruns = 0;
+}
+
+static inline void sampleplay_add(t_sampleplay *p, int kind,
+    double phase, double gain, double xphase, double xgain)
+{
+    int i = p->s_n++;
+    if (!p->s_nruns || p->s_runkind[p->s_nruns - 1] != kind)
+    {
+        p->s_runstart[p->s_nruns] = i;
+        p->s_runkind[p->s_nruns++] = kind;
+    }
+    p->s_phase[i] = phase;
+    p->s_gain[i] = gain;
+    p->s_xphase[i] = xphase;
+    p->s_xgain[i] = xgain;
+}
+
+/* 4-point interpolated reads of npts long vectors, null vectors read as zero.
+   A channel with a non-null fvectors entry is read from there instead, frames are
+   stride floats apart, fvectors may be null when all channels are arrays */
+void sampleplay_perform(t_sampleplay *p, t_word **vectors, float **fvectors,
+    int stride, int npts, t_float **outs, int nchans);
+
+#endif
@@ -0,0 +1,125 @@
+/* Copyright (c) 2022 Timothy Schoen and others.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+#include <string.h>
+#include "m_pd.h"
+#include "samplepool.h"
+
+static t_class *samplepool_class;
+
+void samplepool_initclass(void)
+{
+    if (!samplepool_class)
+        samplepool_class = class_new(gensym("samplepool pool"), 0, 0,
+            sizeof(t_samplepool), CLASS_PD, 0);
+}
+
+static size_t samplepool_nbytes(int nchans, int nframes)
+{
+    return ((size_t)nchans * (size_t)nframes * sizeof(float));
+}
+
+static void samplepool_destroy(t_samplepool *p)
+{
+    if (p->p_data)
+        freebytes(p->p_data, samplepool_nbytes(p->p_nchans, p->p_nframes));
+    freebytes(p, sizeof(*p));
+}
+
+t_samplepool *samplepool_find(t_symbol *name)
+{
+    if (!samplepool_class || !name || name == &s_)
+        return (0);
+    return ((t_samplepool *)pd_findbyclass(name, samplepool_class));
+}
+
+t_samplepool *samplepool_get(t_symbol *name)
+{
+    t_samplepool *p = samplepool_find(name);
+    if (!p)
+    {
+        if (!samplepool_class || !name || name == &s_)
+            return (0);
+        p = (t_samplepool *)getbytes(sizeof(*p));
+        p->p_pd = samplepool_class;
+        p->p_name = name;
+        pd_bind(&p->p_pd, name);
+    }
+    p->p_owners++;
+    p->p_refcount++;
+    return (p);
+}
+
+void samplepool_unget(t_samplepool *p)
+{
+    p->p_refcount--;
+    if (--p->p_owners)
+        return;
+    pd_unbind(&p->p_pd, p->p_name);
+    if (!p->p_refcount)
+        samplepool_destroy(p);
+        /* let the readers drop their reference, so the samples go now */
+    else canvas_update_dsp();
+}
+
+void samplepool_acquire(t_samplepool *p)
+{
+    p->p_refcount++;
+}
+
+void samplepool_release(t_samplepool *p)
+{
+    if (!--p->p_refcount)
+        samplepool_destroy(p);
+}
+
+float *samplepool_channel(t_samplepool *p, int ch, int *stride)
+{
+    if (!p->p_data || ch < 0 || ch >= p->p_nchans)
+        return (0);
+    if (p->p_interleaved)
+    {
+        *stride = p->p_nchans;
+        return (p->p_data + ch);
+    }
+    *stride = 1;
+    return (p->p_data + (size_t)ch * p->p_nframes);
+}
+
+int samplepool_resize(t_samplepool *p, int nchans, int nframes, int interleaved)
+{
+    float *data = 0;
+    int ch, i;
+    if (nchans < 1) nchans = 1;
+    if (nchans > SAMPLEPOOL_MAXCHANS) nchans = SAMPLEPOOL_MAXCHANS;
+    if (nframes < 0) nframes = 0;
+    interleaved = (interleaved != 0);
+    if (nchans == p->p_nchans && nframes == p->p_nframes
+        && interleaved == p->p_interleaved)
+            return (1);
+    if (nframes && !(data = (float *)getbytes(samplepool_nbytes(nchans, nframes))))
+        return (0);
+    if (data && p->p_data)
+    {
+        int ncopy = nframes < p->p_nframes ? nframes : p->p_nframes;
+        int stride = interleaved ? nchans : 1;
+        for (ch = 0; ch < nchans && ch < p->p_nchans; ch++)
+        {
+            int from;
+            const float *src = samplepool_channel(p, ch, &from);
+            float *dst = data + (interleaved ? (size_t)ch : (size_t)ch * nframes);
+            for (i = 0; i < ncopy; i++)
+                dst[(size_t)i * stride] = src[(size_t)i * from];
+        }
+    }
+    if (p->p_data)
+        freebytes(p->p_data, samplepool_nbytes(p->p_nchans, p->p_nframes));
+    p->p_data = data;
+    p->p_nchans = nchans;
+    p->p_nframes = nframes;
+    p->p_interleaved = interleaved;
+        /* readers still point at the old block */
+    canvas_update_dsp();
+    return (1);
+}
@@ -0,0 +1,56 @@
+/* Copyright (c) 2022 Timothy Schoen and others.
+ * For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ * WARRANTIES, see the file, "LICENSE.txt," in this distribution.  */
+
+/* Named multichannel sample storage, an alternative to one garray per channel.
+   Samples are kept as 32-bit floats in one block, either planar (one channel after
+   the other) or interleaved, so they take half the memory of a t_word array on
+   64-bit builds, and a reader finds every channel with a single lookup.
+
+   A pool is bound to its name for as long as an owner (a [samplepool] object) holds it.
+   Readers take a reference while they use the samples, so the block outlives the owner
+   until they look it up again. Every change of layout restarts dsp, which makes the
+   readers pick up the new pointers before the next tick, like a resized garray does.
+
+   cybuf and ELSE's buffer bind to a pool of the same name in the objects that support it,
+   and fall back to arrays otherwise. */
+
+#ifndef __SAMPLEPOOL_H__
+#define __SAMPLEPOOL_H__
+
+#include <stddef.h>
+
+#define SAMPLEPOOL_MAXCHANS 64
+
+typedef struct _samplepool
+{
+    t_pd        p_pd;
+    t_symbol   *p_name;
+    int         p_owners;       /* bound while nonzero */
+    int         p_refcount;     /* owners and readers */
+    int         p_nchans;
+    int         p_nframes;
+    int         p_interleaved;
+    float      *p_data;         /* p_nchans * p_nframes samples */
+} t_samplepool;
+
+/* creates the class, from the setup of the owning object */
+void samplepool_initclass(void);
+
+/* owners: finds or creates the pool of this name, and lets go of it */
+t_samplepool *samplepool_get(t_symbol *name);
+void samplepool_unget(t_samplepool *p);
+
+/* readers: returns the pool bound to name, or 0, without taking a reference */
+t_samplepool *samplepool_find(t_symbol *name);
+void samplepool_acquire(t_samplepool *p);
+void samplepool_release(t_samplepool *p);
+
+/* keeps the samples that fit in the new layout and zeroes the rest,
+   returns 0 if allocation failed, the pool is unchanged then */
+int samplepool_resize(t_samplepool *p, int nchans, int nframes, int interleaved);
+
+/* first sample of a channel, the next frame is *stride floats further, 0 if ch doesn't exist */
+float *samplepool_channel(t_samplepool *p, int ch, int *stride);
+
+#endif
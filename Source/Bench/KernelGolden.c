@@ -0,0 +1,674 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+// Golden test for the signal kernels that ELSE and cyclone objects share
+// Every kernel runs on fixed, seeded input and a hash of its output is compared against a golden file,
+// Resources/Bench/Golden/kernels.txt for the float build and kernels-double.txt for the double one.
+// Where a kernel replaced code in the objects, its golden hashes were generated from that older code,
+// so a match means the objects still produce the same output sample for sample.
+// The sample pools are newer than that code, reading from them must give what reading the array gives.
+// Behaviour the objects didn't have before, like band-limited oscillators or the whole noise burst of [pluck~],
+// is hashed from the kernel itself.
+//
+// The kernels are built into this test without fast math, with it the rounding is up to the compiler
+//
+// The inputs stay away from values whose result depends on the platform,
+// like NaN, infinity, signed zeros and integer conversions out of range.
+//
+// Usage: PlugDataKernelGolden --golden <kernels.txt> [--update-golden]
+// Without --update-golden, a kernel that has no golden hash fails like one that doesn't match
+
+#include <m_pd.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "binop.h"
+#include "blosc.h"
+#include "kstring.h"
+#include "random.h"
+#include "runstat.h"
+#include "sampleplay.h"
+
+#define KERNEL_NSAMPLES 4096
+#define KERNEL_MAXRESULTS 256
+
+typedef struct _result
+{
+    char name[64];
+    uint64_t hash;
+} t_result;
+
+static t_result results[KERNEL_MAXRESULTS];
+static int numResults = 0;
+
+static uint32_t seed = 0;
+
+// xorshift, so the input is the same with every C library
+static uint32_t nextRandom(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+// FNV-1a over the bytes of the samples
+static uint64_t hashSamples(uint64_t hash, const t_sample* samples, int n)
+{
+    const unsigned char* bytes = (const unsigned char*)samples;
+    size_t i;
+    for (i = 0; i < n * sizeof(t_sample); i++)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static const uint64_t hashStart = 14695981039346656037ull;
+
+static void addResult(const char* name, uint64_t hash)
+{
+    if (numResults == KERNEL_MAXRESULTS)
+    {
+        fprintf(stderr, "error: too many kernels\n");
+        exit(1);
+    }
+    snprintf(results[numResults].name, sizeof(results[numResults].name), "%s", name);
+    results[numResults++].hash = hash;
+}
+
+// Binary operators
+//------------------------------------------------------------------------------
+
+typedef struct _binopcase
+{
+    const char* name;
+    t_binop sig;
+    t_binop_scalar scalar;
+    int shift; // the second input is a shift amount
+} t_binopcase;
+
+static const t_binopcase binopCases[] = {
+    {"lt", binop_lt, binop_lt_scalar, 0},
+    {"gt", binop_gt, binop_gt_scalar, 0},
+    {"le", binop_le, binop_le_scalar, 0},
+    {"ge", binop_ge, binop_ge_scalar, 0},
+    {"ne", binop_ne, binop_ne_scalar, 0},
+    {"eq", binop_eq, binop_eq_scalar, 0},
+    {"and", binop_and, binop_and_scalar, 0},
+    {"or", binop_or, binop_or_scalar, 0},
+    {"bitand", binop_bitand, binop_bitand_scalar, 0},
+    {"bitor", binop_bitor, binop_bitor_scalar, 0},
+    {"bitxor", binop_bitxor, binop_bitxor_scalar, 0},
+    {"shiftleft", binop_shiftleft, binop_shiftleft_scalar, 1},
+    {"shiftright", binop_shiftright, binop_shiftright_scalar, 1},
+    {"max", binop_max, binop_max_scalar, 0},
+    {"min", binop_min, binop_min_scalar, 0},
+    {"mod", binop_mod, binop_mod_scalar, 0},
+    {"bitnot", binop_bitnot, binop_bitnot_scalar, 0},
+};
+
+// Quarter steps from -64 to 64, with plenty of zeros and whole numbers, and pairs that are equal
+// Shifts get positive values and shift amounts below 16, anything else is undefined
+static void makeBinopInput(t_sample* a, t_sample* b, int shift)
+{
+    int i;
+    for (i = 0; i < KERNEL_NSAMPLES; i++)
+    {
+        // Counted in quarters as integers, converting to int and back could give -0 with fast math
+        uint32_t const r = nextRandom();
+        int quarters = shift ? (int)(r % 257) : (int)(r % 513) - 256;
+        if (r % 7 == 0) quarters = quarters / 4 * 4;
+        if (r % 11 == 0) quarters = 0;
+        a[i] = (t_sample)quarters * 0.25f;
+
+        if (shift)
+            b[i] = (t_sample)(nextRandom() % 16);
+        else if (r % 5 == 0)
+            b[i] = a[i];
+        else
+            b[i] = (t_sample)((int)(nextRandom() % 513) - 256) * 0.25f;
+    }
+}
+
+static void runBinops(void)
+{
+    static t_sample a[KERNEL_NSAMPLES], b[KERNEL_NSAMPLES], out[KERNEL_NSAMPLES];
+    static const t_sample scalars[] = {-2.5f, 0.0f, 0.25f, 3.0f};
+    static const t_sample shiftScalars[] = {0.0f, 1.0f, 7.0f, 15.0f};
+    char name[64];
+    size_t c, s;
+
+    for (c = 0; c < sizeof(binopCases) / sizeof(*binopCases); c++)
+    {
+        const t_binopcase* op = binopCases + c;
+        uint64_t hash;
+
+        seed = 0x2545F491u + (uint32_t)c;
+        makeBinopInput(a, b, op->shift);
+
+        op->sig(KERNEL_NSAMPLES, a, b, out);
+        snprintf(name, sizeof(name), "binop-%s", op->name);
+        addResult(name, hashSamples(hashStart, out, KERNEL_NSAMPLES));
+
+        hash = hashStart;
+        for (s = 0; s < 4; s++)
+        {
+            op->scalar(KERNEL_NSAMPLES, a, op->shift ? shiftScalars[s] : scalars[s], out);
+            hash = hashSamples(hash, out, KERNEL_NSAMPLES);
+        }
+        snprintf(name, sizeof(name), "binop-%s-scalar", op->name);
+        addResult(name, hash);
+
+        // In place, like the objects run when pd reuses a buffer
+        memcpy(out, a, sizeof(a));
+        op->sig(KERNEL_NSAMPLES, out, b, out);
+        snprintf(name, sizeof(name), "binop-%s-inplace", op->name);
+        addResult(name, hashSamples(hashStart, out, KERNEL_NSAMPLES));
+    }
+}
+
+// The modes of cyclone's bitwise objects, on the same input, with a signal and with a mask
+typedef struct _bitwisecase
+{
+    const char* name;
+    t_binop bits, bitsInt, intBits;
+    t_binop_mask mask, bitsMask;
+} t_bitwisecase;
+
+static const t_bitwisecase bitwiseCases[] = {
+    {"bitand", binop_bitand_bits, binop_bitand_bitsint, binop_bitand_intbits, binop_bitand_mask, binop_bitand_bits_mask},
+    {"bitor", binop_bitor_bits, binop_bitor_bitsint, binop_bitor_intbits, binop_bitor_mask, binop_bitor_bits_mask},
+    {"bitxor", binop_bitxor_bits, binop_bitxor_bitsint, binop_bitxor_intbits, binop_bitxor_mask, binop_bitxor_bits_mask},
+};
+
+static void runBitwise(void)
+{
+    static t_sample a[KERNEL_NSAMPLES], b[KERNEL_NSAMPLES], out[KERNEL_NSAMPLES];
+    // None, the exponent, the low mantissa, all bits and a few in between
+    static const int32_t masks[] = {0, 0x7F800000, 0x0000FFFF, -1, 0x3FF00000};
+    char name[64];
+    size_t c, m;
+
+    for (c = 0; c < sizeof(bitwiseCases) / sizeof(*bitwiseCases); c++)
+    {
+        const t_bitwisecase* op = bitwiseCases + c;
+        const t_binop sig[] = {op->bits, op->bitsInt, op->intBits};
+        static const char* sigNames[] = {"bits", "bitsint", "intbits"};
+        uint64_t hash, bitsHash;
+
+        seed = 0x61C88647u + (uint32_t)c;
+        makeBinopInput(a, b, 0);
+
+        for (m = 0; m < 3; m++)
+        {
+            sig[m](KERNEL_NSAMPLES, a, b, out);
+            snprintf(name, sizeof(name), "binop-%s-%s", op->name, sigNames[m]);
+            addResult(name, hashSamples(hashStart, out, KERNEL_NSAMPLES));
+        }
+
+        hash = bitsHash = hashStart;
+        for (m = 0; m < sizeof(masks) / sizeof(*masks); m++)
+        {
+            op->mask(KERNEL_NSAMPLES, a, masks[m], out);
+            hash = hashSamples(hash, out, KERNEL_NSAMPLES);
+            op->bitsMask(KERNEL_NSAMPLES, a, masks[m], out);
+            bitsHash = hashSamples(bitsHash, out, KERNEL_NSAMPLES);
+        }
+        snprintf(name, sizeof(name), "binop-%s-mask", op->name);
+        addResult(name, hash);
+        snprintf(name, sizeof(name), "binop-%s-bits-mask", op->name);
+        addResult(name, bitsHash);
+    }
+}
+
+// Sample playback
+//------------------------------------------------------------------------------
+
+#define PLAY_NPTS 1000
+#define PLAY_NCHANS 3
+#define PLAY_BLOCKSIZE 64
+
+static double randomUnit(void)
+{
+    return (double)nextRandom() / 4294967296.0;
+}
+
+// Runs the same random plans with [tabplayer~]'s and [play~]'s settings,
+// reading from arrays and from planar and interleaved sample pools, the second channel is missing
+static void runSamplePlayback(void)
+{
+    static t_word words[PLAY_NCHANS][PLAY_NPTS];
+    static float planar[PLAY_NCHANS * PLAY_NPTS], interleaved[PLAY_NCHANS * PLAY_NPTS];
+    static t_sample outputs[PLAY_NCHANS][PLAY_BLOCKSIZE];
+    static const char* sources[] = {"array", "planar", "interleaved"};
+    t_word* vectors[PLAY_NCHANS];
+    float* pool[PLAY_NCHANS];
+    t_sample* outs[PLAY_NCHANS];
+    char name[64];
+    int object, source, ch, i, block;
+
+    seed = 0x9E3779B9u;
+    for (ch = 0; ch < PLAY_NCHANS; ch++)
+    {
+        for (i = 0; i < PLAY_NPTS; i++)
+        {
+            float const value = (float)(randomUnit() * 2.0 - 1.0);
+            words[ch][i].w_float = value;
+            planar[ch * PLAY_NPTS + i] = value;
+            interleaved[i * PLAY_NCHANS + ch] = value;
+        }
+        outs[ch] = outputs[ch];
+    }
+
+    for (object = 0; object < 2; object++)
+    {
+        for (source = 0; source < 3; source++)
+        {
+            t_sampleplay play;
+            uint64_t hash = hashStart;
+
+            // tabplayer~ rounds to a float after every step, play~ doesn't
+            if (object == 0)
+                sampleplay_init(&play, 0.16666666666666666666667f, 1);
+            else
+                sampleplay_init(&play, 0.1666667f, 0);
+            sampleplay_setup(&play, PLAY_BLOCKSIZE);
+
+            for (ch = 0; ch < PLAY_NCHANS; ch++)
+            {
+                vectors[ch] = ch == 1 ? 0 : words[ch];
+                pool[ch] = source == 1 ? planar + ch * PLAY_NPTS : interleaved + ch;
+            }
+
+            seed = 0x85EBCA6Bu;
+            for (block = 0; block < 256; block++)
+            {
+                sampleplay_begin(&play);
+                for (i = 0; i < PLAY_BLOCKSIZE;)
+                {
+                    // Runs of a few samples, positions a little outside the table on both ends
+                    int const kind = (int)(nextRandom() % 4);
+                    int const length = 1 + (int)(nextRandom() % 8);
+                    int j;
+                    for (j = 0; j < length && i < PLAY_BLOCKSIZE; j++, i++)
+                    {
+                        double const phase = randomUnit() * PLAY_NPTS * 1.1 - 5.0;
+                        double const gain = randomUnit();
+                        double const xphase = randomUnit() * PLAY_NPTS;
+                        sampleplay_add(&play, kind, phase, gain, xphase, 1.0 - gain);
+                    }
+                }
+
+                if (source == 0)
+                    sampleplay_perform(&play, vectors, 0, 1, PLAY_NPTS, outs, PLAY_NCHANS);
+                else
+                {
+                    // The pool has no missing channels, the array of the second one still decides
+                    float* fvectors[PLAY_NCHANS] = {pool[0], 0, pool[2]};
+                    sampleplay_perform(&play, vectors, fvectors, source == 1 ? 1 : PLAY_NCHANS, PLAY_NPTS, outs, PLAY_NCHANS);
+                }
+
+                for (ch = 0; ch < PLAY_NCHANS; ch++)
+                {
+                    hash = hashSamples(hash, outputs[ch], PLAY_BLOCKSIZE);
+                }
+            }
+
+            sampleplay_free(&play);
+
+            snprintf(name, sizeof(name), "sampleplay-%s-%s", object == 0 ? "tabplayer" : "play", sources[source]);
+            addResult(name, hash);
+        }
+    }
+}
+
+// Oscillators
+//------------------------------------------------------------------------------
+
+#define OSC_BLOCKSIZE 64
+
+typedef struct _osccase
+{
+    const char* name;
+    int shape;
+    int width; // takes a width input
+} t_osccase;
+
+static const t_osccase oscCases[] = {
+    {"saw", BLOSC_SAW, 0},
+    {"square", BLOSC_SQUARE, 1},
+    {"tri", BLOSC_TRI, 0},
+    {"vsaw", BLOSC_VSAW, 1},
+};
+
+// Blocks that keep frequency, width and phase offset, which take the fast path, mixed with blocks that change them
+static void makeOscillatorBlock(t_sample* freq, t_sample* width, t_sample* sync, t_sample* offset, t_sample* state)
+{
+    int const kind = (int)(nextRandom() % 4);
+    int i;
+
+    if (nextRandom() % 4 == 0) state[0] = nextRandom() % 5 ? (t_sample)((randomUnit() - 0.3) * 3000.0) : 0;
+    if (nextRandom() % 6 == 0) state[1] = nextRandom() % 3 ? (t_sample)(randomUnit() * 1.2 - 0.1) : (t_sample)(nextRandom() % 2);
+    if (nextRandom() % 6 == 0) state[2] = (t_sample)((int)(nextRandom() % 13) - 6) * 0.25f;
+
+    for (i = 0; i < OSC_BLOCKSIZE; i++)
+    {
+        double const r = randomUnit();
+        freq[i] = kind == 1 ? (t_sample)((randomUnit() - 0.3) * 5000.0) : state[0];
+        width[i] = kind == 2 ? (t_sample)(randomUnit() * 1.2 - 0.1) : state[1];
+        offset[i] = kind == 3 && i > 20 ? state[2] + 0.25f : state[2];
+        sync[i] = r < 0.05 ? (t_sample)randomUnit() : r < 0.07 ? 1 : 0;
+    }
+}
+
+// The plain shapes, with and without a sync signal, then the band-limited ones and a unison
+static void runOscillators(void)
+{
+    static t_sample freq[OSC_BLOCKSIZE], width[OSC_BLOCKSIZE], sync[OSC_BLOCKSIZE], offset[OSC_BLOCKSIZE], out[OSC_BLOCKSIZE];
+    static const char* modes[] = {"", "-sync", "-bl", "-unison"};
+    char name[64];
+    size_t c;
+    int mode, block;
+
+    for (c = 0; c < sizeof(oscCases) / sizeof(*oscCases); c++)
+    {
+        for (mode = 0; mode < 4; mode++)
+        {
+            const t_osccase* osc = oscCases + c;
+            t_sample state[3] = {220, 0.5f, 0};
+            uint64_t hash = hashStart;
+            t_blosc o;
+
+            // Without detuning, the detune doesn't depend on pow() of the C library
+            blosc_init(&o, osc->shape, mode == 3 ? 3 : 1, 0);
+            o.o_bl = mode == 2;
+            o.o_sr = 48000;
+
+            seed = 0x27D4EB2Fu + (uint32_t)c;
+            for (block = 0; block < 256; block++)
+            {
+                makeOscillatorBlock(freq, width, sync, offset, state);
+                blosc_perform(&o, OSC_BLOCKSIZE, freq, osc->width ? width : 0, mode == 1 ? sync : 0, offset, out);
+                hash = hashSamples(hash, out, OSC_BLOCKSIZE);
+            }
+
+            snprintf(name, sizeof(name), "blosc-%s%s", osc->name, modes[mode]);
+            addResult(name, hash);
+        }
+    }
+}
+
+// Plucked strings
+//------------------------------------------------------------------------------
+
+#define STRING_BLOCKSIZE 64
+
+// The loop filter and the feedback come from sin(), cos() and exp() of the C library, which may be off by
+// an ulp from one to another, so these are hashed at 16 bits after the point, far above that difference
+static uint64_t hashQuantized(uint64_t hash, const t_sample* samples, int n)
+{
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        int32_t const q = (int32_t)floor(samples[i] * 65536.0 + 0.5);
+        const unsigned char* bytes = (const unsigned char*)&q;
+        size_t b;
+        for (b = 0; b < sizeof(q); b++)
+        {
+            hash = (hash ^ bytes[b]) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+// Control rate inputs that change now and then, plucks that last over the end of a block,
+// and a mode with the frequency and the cutoff changing every sample
+static void makeStringBlock(t_sample* hz, t_sample* trig, t_sample* decay, t_sample* cutoff, t_sample* noise, t_sample* state, int audioRate)
+{
+    int i;
+
+    if (nextRandom() % 8 == 0) state[0] = nextRandom() % 10 ? (t_sample)(60.0 + randomUnit() * 1000.0) : (t_sample)0.5;
+    if (nextRandom() % 8 == 0) state[1] = (t_sample)((randomUnit() - 0.2) * 4000.0);
+    if (nextRandom() % 8 == 0) state[2] = (t_sample)(500.0 + randomUnit() * 8000.0);
+
+    for (i = 0; i < STRING_BLOCKSIZE; i++)
+    {
+        if (state[3] > 0)
+            state[3]--;
+        else if (nextRandom() % 200 == 0)
+            state[3] = (t_sample)(1 + nextRandom() % 100);
+        trig[i] = state[3] > 0 ? (t_sample)(0.25 + randomUnit() * 0.75) : 0;
+
+        hz[i] = audioRate ? (t_sample)(state[0] * (1.0 + 0.05 * randomUnit())) : state[0];
+        cutoff[i] = audioRate ? (t_sample)(state[2] * (0.5 + randomUnit())) : state[2];
+        decay[i] = state[1];
+        noise[i] = (t_sample)(randomUnit() * 2.0 - 1.0);
+    }
+}
+
+// [pluck~] with its own noise and with a noise input, then tuned, and with several strings
+static void runStrings(void)
+{
+    static t_sample hz[STRING_BLOCKSIZE], trig[STRING_BLOCKSIZE], decay[STRING_BLOCKSIZE], cutoff[STRING_BLOCKSIZE];
+    static t_sample noise[STRING_BLOCKSIZE], out[STRING_BLOCKSIZE];
+    static const char* modes[] = {"", "-audio", "-tune", "-strings"};
+    char name[64];
+    int mode, block;
+
+    for (mode = 0; mode < 4; mode++)
+    {
+        t_sample state[4] = {220, 2000, 6000, 0};
+        uint64_t hash = hashStart;
+        t_random_state rstate = {1243598713u, 3093459404u, 1821928721u};
+        t_kstring string;
+
+        kstring_init(&string, mode == 3 ? 4 : 1, mode == 2);
+        if (!kstring_resize(&string, 48000, 1000))
+        {
+            fprintf(stderr, "error: can't allocate the strings\n");
+            exit(1);
+        }
+
+        seed = 0x165667B1u + (uint32_t)mode;
+        for (block = 0; block < 1024; block++)
+        {
+            makeStringBlock(hz, trig, decay, cutoff, noise, state, mode == 1);
+            kstring_perform(&string, &rstate, STRING_BLOCKSIZE, hz, trig, decay, cutoff, mode == 1 ? noise : 0, out);
+            hash = hashQuantized(hash, out, STRING_BLOCKSIZE);
+        }
+
+        kstring_free(&string);
+
+        snprintf(name, sizeof(name), "kstring%s", modes[mode]);
+        addResult(name, hash);
+    }
+}
+
+// Moving window statistics
+//------------------------------------------------------------------------------
+
+#define STAT_BLOCKSIZE 64
+#define STAT_SIZE 300
+#define STAT_WINDOW 128
+
+typedef struct _statcase
+{
+    const char* name;
+    int mode;
+    int what;
+} t_statcase;
+
+// [mov.avg~] and [average~ bipolar], [mov.avg~ -abs] and [average~ absolute], [mov.rms~] and [average~ rms], [mov.rms~] in dB
+static const t_statcase statCases[] = {
+    {"mean", RUNSTAT_BIPOLAR, RUNSTAT_MEAN},
+    {"absolute", RUNSTAT_ABSOLUTE, RUNSTAT_MEAN},
+    {"rms", RUNSTAT_SQUARE, RUNSTAT_ROOT},
+    {"db", RUNSTAT_SQUARE, RUNSTAT_DB},
+};
+
+// Multiples of 1/256 and their squares add up without rounding, with a window that is a power of two the mean is exact too,
+// so the order the kernel adds in doesn't matter and the old objects' output can be compared sample for sample
+// Every 16 blocks, 3 silent ones empty the window
+static void makeStatBlock(t_sample* in, int block)
+{
+    int i;
+    for (i = 0; i < STAT_BLOCKSIZE; i++)
+    {
+        in[i] = block % 16 < 3 ? 0 : (t_sample)((int)(nextRandom() % 513) - 256) / 256;
+    }
+}
+
+// Windows that stay put for a block, and windows that move every sample, out of range and between whole numbers too
+static void makeStatWindow(t_sample* n)
+{
+    int const kind = (int)(nextRandom() % 3);
+    t_sample const start = (t_sample)(nextRandom() % (STAT_SIZE + 40)) - 20;
+    int i;
+    for (i = 0; i < STAT_BLOCKSIZE; i++)
+    {
+        n[i] = kind == 0 ? start : kind == 1 ? start + i * 3 : (t_sample)(randomUnit() * (STAT_SIZE + 40) - 20);
+    }
+}
+
+// A fixed window, whose hashes come from the old perform loops, then a moving window and an output held for 48 samples
+static void runStats(void)
+{
+    static t_sample in[STAT_BLOCKSIZE], n[STAT_BLOCKSIZE], out[STAT_BLOCKSIZE];
+    static const char* modes[] = {"", "-moving", "-hold"};
+    char name[64];
+    size_t c;
+    int mode, block, i;
+
+    for (c = 0; c < sizeof(statCases) / sizeof(*statCases); c++)
+    {
+        for (mode = 0; mode < 3; mode++)
+        {
+            const t_statcase* stat = statCases + c;
+            uint64_t hash = hashStart;
+            t_runstat r;
+
+            runstat_init(&r, stat->mode);
+            if (!runstat_resize(&r, STAT_SIZE))
+            {
+                fprintf(stderr, "error: can't allocate the window\n");
+                exit(1);
+            }
+            if (mode == 2) runstat_hold(&r, 48);
+
+            for (i = 0; i < STAT_BLOCKSIZE; i++)
+            {
+                n[i] = STAT_WINDOW;
+            }
+
+            seed = 0x61C88647u + (uint32_t)c;
+            for (block = 0; block < 256; block++)
+            {
+                makeStatBlock(in, block);
+                if (mode == 1) makeStatWindow(n);
+                runstat_perform(&r, STAT_BLOCKSIZE, in, n, out);
+                runstat_output(&r, STAT_BLOCKSIZE, stat->what, out);
+                // log() may be off by an ulp from one C library to another, like for the strings
+                hash = stat->what == RUNSTAT_DB ? hashQuantized(hash, out, STAT_BLOCKSIZE) : hashSamples(hash, out, STAT_BLOCKSIZE);
+            }
+
+            runstat_free(&r);
+
+            snprintf(name, sizeof(name), "runstat-%s%s", stat->name, modes[mode]);
+            addResult(name, hash);
+        }
+    }
+}
+
+// Golden file
+//------------------------------------------------------------------------------
+
+static int writeGolden(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    int i;
+    if (!file)
+    {
+        fprintf(stderr, "error: can't write %s\n", path);
+        return 1;
+    }
+    for (i = 0; i < numResults; i++)
+    {
+        fprintf(file, "%s %016llx\n", results[i].name, (unsigned long long)results[i].hash);
+    }
+    fclose(file);
+    printf("updated %d kernels in %s\n", numResults, path);
+    return 0;
+}
+
+static int checkGolden(const char* path)
+{
+    static t_result golden[KERNEL_MAXRESULTS];
+    int numGolden = 0, failed = 0, i, j;
+    unsigned long long hash;
+    FILE* file = fopen(path, "r");
+
+    if (file)
+    {
+        while (numGolden < KERNEL_MAXRESULTS && fscanf(file, "%63s %llx", golden[numGolden].name, &hash) == 2)
+        {
+            golden[numGolden++].hash = hash;
+        }
+        fclose(file);
+    }
+    else
+    {
+        fprintf(stderr, "error: can't read %s, run with --update-golden to create it\n", path);
+    }
+
+    for (i = 0; i < numResults; i++)
+    {
+        const char* status = "missing";
+        for (j = 0; j < numGolden; j++)
+        {
+            if (strcmp(golden[j].name, results[i].name)) continue;
+            status = golden[j].hash == results[i].hash ? "match" : "mismatch";
+            break;
+        }
+        if (strcmp(status, "match")) failed = 1;
+        printf("%s: %s\n", results[i].name, status);
+    }
+
+    return failed;
+}
+
+int main(int argc, char** argv)
+{
+    const char* golden = 0;
+    int updateGolden = 0, i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--golden") && i + 1 < argc)
+            golden = argv[++i];
+        else if (!strcmp(argv[i], "--update-golden"))
+            updateGolden = 1;
+    }
+
+    if (!golden)
+    {
+        fprintf(stderr, "usage: PlugDataKernelGolden --golden <kernels.txt> [--update-golden]\n");
+        return 1;
+    }
+
+    runBinops();
+    runBitwise();
+    runSamplePlayback();
+    runOscillators();
+    runStrings();
+    runStats();
+
+    return updateGolden ? writeGolden(golden) : checkGolden(golden);
+}
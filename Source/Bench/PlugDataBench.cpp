@@ -0,0 +1,620 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include <JuceHeader.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+#if JUCE_LINUX || JUCE_BSD || JUCE_MAC
+#include <sys/resource.h>
+#endif
+
+#include "../PluginProcessor.h"
+#include "../Pd/PdGui.h"
+
+extern "C"
+{
+#include <m_pd.h>
+#include <g_canvas.h>
+}
+
+// Deterministic rendering and performance benchmark
+// Renders every patch in a corpus at several block sizes, compares the output against golden hashes
+// (a missing golden hash is reported but doesn't fail the run, --update-golden records them from the current build)
+// and reports the time per pd tick, the allocations per block and the peak memory use as JSON
+//
+// The GUI objects of every patch are published through the GUI mirror like an open editor would,
+// after closing a patch none of them may still be published, whatever freed them
+//
+// Finally all channels of the widest allowed layout are passed through pd with oversampling on,
+// every one of them has to come out where it went in, and pd's message queue is stress tested
+// while another thread processes blocks (--contention runs only that test)
+//
+// PlugDataBenchDouble is the same benchmark built against the double precision pd,
+// pass it the results of PlugDataBench with --compare to get the throughput of double relative to float
+//
+// Usage: PlugDataBench [--corpus <dir>] [--golden <dir>] [--update-golden] [--output <results.json>]
+//                      [--seconds <seconds>] [--samplerate <hz>] [--blocksizes <64,256,...>]
+//                      [--compare <results.json>] [--contention]
+
+static std::atomic<bool> countAllocations = false;
+static std::atomic<int64> numAllocations = 0;
+
+#if JUCE_LINUX && !PLUGDATA_REALTIME_CHECK
+// Count every allocation in the process, including the ones made by pd's C code
+// The realtime checker already interposes these, so fall back to counting operator new when it's enabled
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+
+    void* malloc(size_t size) noexcept
+    {
+        if (countAllocations.load(std::memory_order_relaxed)) numAllocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t num, size_t size) noexcept
+    {
+        if (countAllocations.load(std::memory_order_relaxed)) numAllocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_calloc(num, size);
+    }
+
+    void* realloc(void* ptr, size_t size) noexcept
+    {
+        if (countAllocations.load(std::memory_order_relaxed)) numAllocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_realloc(ptr, size);
+    }
+}
+#else
+// Only count C++ allocations
+void* operator new(size_t size)
+{
+    if (countAllocations.load(std::memory_order_relaxed)) numAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (auto* ptr = std::malloc(size)) return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
+class PlugDataBench : public JUCEApplication
+{
+   public:
+    struct Result
+    {
+        String patch;
+        int blockSize;
+        double microsecondsPerTick;
+        double realtimeFactor;
+        double allocationsPerBlock;
+        String hash;
+        String golden;
+        double relativeThroughput;
+        int danglingSlots;
+    };
+
+    static inline const String precision = std::is_same<pd::Sample, double>::value ? "double" : "float";
+
+    PlugDataBench()
+    {
+        PluginHostType::jucePlugInClientCurrentWrapperType = AudioProcessor::wrapperType_Standalone;
+    }
+
+    const String getApplicationName() override
+    {
+        return "PlugDataBench";
+    }
+
+    const String getApplicationVersion() override
+    {
+        return JucePlugin_VersionString;
+    }
+
+    bool moreThanOneInstanceAllowed() override
+    {
+        return true;
+    }
+
+    void initialise(const String&) override
+    {
+        setApplicationReturnValue(run(getCommandLineParameterArray()));
+        quit();
+    }
+
+    void shutdown() override
+    {
+    }
+
+   private:
+    int run(const StringArray& args)
+    {
+        auto getValue = [&args](const String& flag, const String& defaultValue) -> String
+        {
+            int const idx = args.indexOf(flag);
+            return idx >= 0 && idx + 1 < args.size() ? args[idx + 1].unquoted() : defaultValue;
+        };
+
+        auto const cwd = File::getCurrentWorkingDirectory();
+
+        sampleRate = getValue("--samplerate", "44100").getDoubleValue();
+
+        if (args.contains("--contention"))
+        {
+            std::unique_ptr<PlugDataAudioProcessor> processor(dynamic_cast<PlugDataAudioProcessor*>(createPluginFilterOfType(AudioProcessor::wrapperType_Standalone)));
+            return checkLockContention(*processor) ? 0 : 1;
+        }
+
+        corpus = cwd.getChildFile(getValue("--corpus", "Resources/Bench"));
+        golden = cwd.getChildFile(getValue("--golden", corpus.getChildFile("Golden").getFullPathName()));
+        updateGolden = args.contains("--update-golden");
+        seconds = getValue("--seconds", "10").getDoubleValue();
+
+        for (auto& size : StringArray::fromTokens(getValue("--blocksizes", "64,256,1024"), ",", ""))
+        {
+            if (size.getIntValue() > 0) blockSizes.add(size.getIntValue());
+        }
+
+        auto patches = corpus.findChildFiles(File::findFiles, false, "*.pd");
+        patches.sort();
+
+        if (patches.isEmpty() || blockSizes.isEmpty() || seconds <= 0.0 || sampleRate <= 0.0)
+        {
+            std::cerr << "error: no patches found in " << corpus.getFullPathName() << " or invalid settings" << std::endl;
+            return 1;
+        }
+
+        std::unique_ptr<PlugDataAudioProcessor> processor(dynamic_cast<PlugDataAudioProcessor*>(createPluginFilterOfType(AudioProcessor::wrapperType_Standalone)));
+
+        // Handle pd's message queue on this thread
+        processor->setNonRealtime(true);
+
+        Array<Result> results;
+        bool failed = false;
+        int numMissing = 0;
+
+        for (auto& patch : patches)
+        {
+            for (auto blockSize : blockSizes)
+            {
+                auto result = render(*processor, patch, blockSize);
+                // Goldens have to be recorded on the reference build, until then there is nothing to compare against
+                failed |= result.golden == "mismatch" || result.golden == "error" || result.danglingSlots > 0;
+                numMissing += result.golden == "missing";
+
+                std::cerr << result.patch << " @ " << blockSize << ": " << result.microsecondsPerTick << " us/tick, " << result.allocationsPerBlock << " allocations/block, " << result.golden << std::endl;
+                results.add(result);
+            }
+        }
+
+        if (numMissing > 0)
+        {
+            std::cerr << numMissing << " renders have no golden hash in " << golden.getFullPathName() << ", record them with --update-golden" << std::endl;
+        }
+
+        wideLayout = checkWideLayout(*processor);
+        failed |= !wideLayout;
+
+        lockContention = checkLockContention(*processor);
+        failed |= !lockContention;
+
+        processor.reset();
+
+        if (args.contains("--compare"))
+        {
+            compare(results, JSON::parse(cwd.getChildFile(getValue("--compare", ""))));
+        }
+
+        auto json = toJSON(results);
+
+        if (args.contains("--output"))
+        {
+            cwd.getChildFile(getValue("--output", "")).replaceWithText(json);
+        }
+        else
+        {
+            std::cout << json << std::endl;
+        }
+
+        return failed ? 1 : 0;
+    }
+
+    Result render(PlugDataAudioProcessor& processor, const File& patchFile, int blockSize)
+    {
+        Result result = {patchFile.getFileNameWithoutExtension(), blockSize, 0.0, 0.0, 0.0, {}, {}, 0.0, 0};
+
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        auto* patch = processor.loadPatch(patchFile);
+
+        if (!patch->getPointer())
+        {
+            processor.patches.removeObject(patch);
+            processor.releaseResources();
+            result.golden = "error";
+            return result;
+        }
+
+        std::vector<int> mirrorSlots;
+        addToMirror(processor, patch->getPointer(), mirrorSlots);
+
+        int const numChannels = std::max(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+
+        // Uses the host sample type that matches pd, so the double build is measured without conversions
+        AudioBuffer<pd::Sample> buffer(numChannels, blockSize);
+        MidiBuffer midiBuffer;
+
+        // Seeded noise as input, so every run gets the same signal
+        Random random(1234);
+        MemoryBlock output;
+
+        auto const numBlocks = static_cast<int>(std::ceil(seconds * sampleRate / blockSize));
+        double elapsed = 0.0;
+        int64 allocations = 0;
+
+        for (int i = 0; i < numBlocks; i++)
+        {
+            for (int ch = 0; ch < processor.getTotalNumInputChannels(); ch++)
+            {
+                auto* data = buffer.getWritePointer(ch);
+                for (int n = 0; n < blockSize; n++) data[n] = static_cast<pd::Sample>(random.nextFloat() * 2.0f - 1.0f);
+            }
+            for (int ch = processor.getTotalNumInputChannels(); ch < numChannels; ch++)
+            {
+                buffer.clear(ch, 0, blockSize);
+            }
+
+            midiBuffer.clear();
+
+            numAllocations = 0;
+            countAllocations = true;
+
+            auto const start = Time::getHighResolutionTicks();
+            {
+                const ScopedLock lock(*processor.getCallbackLock());
+                processor.processBlock(buffer, midiBuffer);
+            }
+            auto const end = Time::getHighResolutionTicks();
+
+            countAllocations = false;
+
+            allocations += numAllocations.load();
+            elapsed += Time::highResolutionTicksToSeconds(end - start);
+
+            for (int ch = 0; ch < processor.getTotalNumOutputChannels(); ch++)
+            {
+                output.append(buffer.getReadPointer(ch), blockSize * sizeof(pd::Sample));
+            }
+        }
+
+        patch->close();
+
+        // The editor only removes its objects after the patch is closed
+        for (auto slot : mirrorSlots)
+        {
+            if (processor.guiMirror.isActive(slot)) result.danglingSlots++;
+            processor.guiMirror.removeObject(slot);
+        }
+
+        if (result.danglingSlots > 0)
+        {
+            std::cerr << result.patch << ": " << result.danglingSlots << " freed objects are still published by the GUI mirror" << std::endl;
+        }
+
+        processor.patches.removeObject(patch);
+        processor.releaseResources();
+
+        auto const numTicks = static_cast<double>(numBlocks) * blockSize / processor.pd::Instance::getBlockSize();
+
+        result.microsecondsPerTick = elapsed * 1e6 / numTicks;
+        result.realtimeFactor = elapsed > 0.0 ? (numBlocks * blockSize / sampleRate) / elapsed : 0.0;
+        result.allocationsPerBlock = static_cast<double>(allocations) / numBlocks;
+        result.hash = SHA256(output).toHexString();
+        result.golden = checkGolden(result);
+
+        return result;
+    }
+
+    // Passes every channel of the widest layout through pd, with oversampling on
+    // Each input carries its own DC level, which the oversampling filters keep,
+    // so a channel that doesn't reach pd or comes out on another dac~ channel shows up as a wrong level
+    bool checkWideLayout(PlugDataAudioProcessor& processor)
+    {
+        int const numChannels = PlugDataAudioProcessor::maxNumChannels;
+        int const blockSize = 256;
+
+        auto const previousLayout = processor.getBusesLayout();
+        auto layout = previousLayout;
+        for (auto& bus : layout.inputBuses) bus = AudioChannelSet::disabled();
+        for (auto& bus : layout.outputBuses) bus = AudioChannelSet::disabled();
+        layout.inputBuses.getReference(0) = AudioChannelSet::discreteChannels(numChannels);
+        layout.outputBuses.getReference(0) = AudioChannelSet::discreteChannels(numChannels);
+
+        if (!processor.setBusesLayout(layout))
+        {
+            std::cerr << "wide layout: " << numChannels << " channels were rejected" << std::endl;
+            return false;
+        }
+
+        String adc = "#X obj 10 10 adc~";
+        String dac = "#X obj 10 60 dac~";
+        String connections;
+        for (int ch = 0; ch < numChannels; ch++)
+        {
+            adc << " " << ch + 1;
+            dac << " " << ch + 1;
+            connections << "#X connect 0 " << ch << " 1 " << ch << ";\n";
+        }
+
+        auto getLevel = [numChannels](int ch) { return static_cast<pd::Sample>(ch + 1) / static_cast<pd::Sample>(2 * numChannels); };
+
+        processor.setOversampling(2);
+        processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        auto* patch = processor.loadPatch("#N canvas 0 50 450 300 12;\n" + adc + ";\n" + dac + ";\n" + connections);
+
+        AudioBuffer<pd::Sample> buffer(numChannels, blockSize);
+        MidiBuffer midiBuffer;
+        int wrongChannels = numChannels;
+
+        if (patch->getPointer())
+        {
+            // Long enough for the oversampling filters to settle
+            for (int i = 0; i < 64; i++)
+            {
+                for (int ch = 0; ch < numChannels; ch++)
+                {
+                    auto* data = buffer.getWritePointer(ch);
+                    std::fill(data, data + blockSize, getLevel(ch));
+                }
+
+                const ScopedLock lock(*processor.getCallbackLock());
+                processor.processBlock(buffer, midiBuffer);
+            }
+
+            wrongChannels = 0;
+            for (int ch = 0; ch < numChannels; ch++)
+            {
+                if (std::abs(buffer.getSample(ch, blockSize - 1) - getLevel(ch)) > 1e-3) wrongChannels++;
+            }
+
+            patch->close();
+        }
+
+        processor.patches.removeObject(patch);
+        processor.releaseResources();
+        processor.setOversampling(0);
+        processor.setBusesLayout(previousLayout);
+
+        std::cerr << "wide layout: " << numChannels << " channels at 4x oversampling, " << wrongChannels << " wrong" << std::endl;
+
+        return wrongChannels == 0;
+    }
+
+    // Queues functions from two threads at once while another thread processes blocks like a host's audio thread
+    // Every queued function has to have run when its wait returns, and no block may skip pd because another thread held it
+    // Runs once in realtime and once like an offline render, where the queueing threads may process pd themselves
+    bool checkLockContention(PlugDataAudioProcessor& processor)
+    {
+        int const blockSize = 64;
+        int const numCalls = 2000;
+        auto const level = static_cast<pd::Sample>(0.25);
+
+        int wrongResults = 0;
+        int silentBlocks = 0;
+
+        for (auto const nonRealtime : {false, true})
+        {
+            processor.setNonRealtime(nonRealtime);
+            processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            std::atomic<bool> running = true;
+            std::atomic<bool> loaded = false;
+            std::atomic<int> numSilent = 0;
+
+            std::thread audioThread([&]()
+                {
+                    int const numChannels = std::max(processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+                    AudioBuffer<pd::Sample> buffer(numChannels, blockSize);
+                    MidiBuffer midiBuffer;
+
+                    while (running)
+                    {
+                        // Only check blocks that started after the patch was loaded
+                        bool const check = loaded;
+
+                        buffer.clear();
+                        {
+                            const ScopedLock lock(*processor.getCallbackLock());
+                            processor.processBlock(buffer, midiBuffer);
+                        }
+
+                        if (check && std::abs(buffer.getSample(0, blockSize - 1) - level) > 1e-6) numSilent++;
+
+                        std::this_thread::yield();
+                    }
+                });
+
+            auto* patch = processor.loadPatch("#N canvas 0 50 450 300 12;\n#X obj 10 10 sig~ 0.25;\n#X obj 10 60 dac~ 1 2;\n#X connect 0 0 1 0;\n#X connect 0 0 1 1;\n");
+            loaded = patch->getPointer() != nullptr;
+
+            std::atomic<int> numWrong = patch->getPointer() ? 0 : 1;
+
+            // Every function writes into a local of the thread that waits for it
+            auto queueFunctions = [&processor, &numWrong, numCalls](int offset)
+            {
+                for (int i = 0; i < numCalls; i++)
+                {
+                    int value = -1;
+                    processor.enqueueFunctionAndWait([&value, offset, i]() { value = offset + i; });
+                    if (value != offset + i) numWrong++;
+
+                    processor.enqueueMessages("contention", "float", {pd::Atom(static_cast<float>(i))});
+                }
+            };
+
+            std::thread otherThread(queueFunctions, numCalls);
+            queueFunctions(0);
+            otherThread.join();
+
+            running = false;
+            audioThread.join();
+
+            // Once the host stopped processing, the waiting thread runs the queue itself
+            processor.releaseResources();
+
+            int value = -1;
+            processor.enqueueFunctionAndWait([&value]() { value = 1; });
+            if (value != 1) numWrong++;
+
+            if (patch->getPointer()) patch->close();
+            processor.patches.removeObject(patch);
+
+            std::cerr << "lock contention" << (nonRealtime ? " (offline)" : "") << ": " << numWrong.load() << " wrong results, " << numSilent.load() << " blocks without pd" << std::endl;
+
+            wrongResults += numWrong;
+            silentBlocks += numSilent;
+        }
+
+        processor.setNonRealtime(true);
+
+        return wrongResults == 0 && silentBlocks == 0;
+    }
+
+    // Registers the GUI objects of a canvas and its subpatches with the mirror
+    static void addToMirror(PlugDataAudioProcessor& processor, void* canvas, std::vector<int>& slots)
+    {
+        for (t_gobj* y = static_cast<t_canvas*>(canvas)->gl_list; y; y = y->g_next)
+        {
+            if (pd_class(&y->g_pd) == canvas_class)
+            {
+                addToMirror(processor, y, slots);
+                continue;
+            }
+
+            auto const slot = processor.guiMirror.addObject(y, canvas, pd::Gui::getType(y));
+            if (slot >= 0) slots.push_back(slot);
+        }
+    }
+
+    String checkGolden(const Result& result)
+    {
+        auto const suffix = precision == "double" ? "-double" : "";
+        auto file = golden.getChildFile(result.patch + "-" + String(result.blockSize) + suffix + ".sha256");
+
+        if (updateGolden)
+        {
+            golden.createDirectory();
+            file.replaceWithText(result.hash);
+            return "updated";
+        }
+
+        if (!file.existsAsFile()) return "missing";
+
+        return file.loadFileAsString().trim() == result.hash ? "match" : "mismatch";
+    }
+
+    // Adds the throughput relative to an earlier run, for every patch and block size found in both
+    void compare(Array<Result>& results, const var& other)
+    {
+        for (auto& result : results)
+        {
+            if (auto* list = other["results"].getArray())
+            {
+                for (auto& entry : *list)
+                {
+                    if (entry["patch"].toString() != result.patch || static_cast<int>(entry["blocksize"]) != result.blockSize) continue;
+
+                    auto const otherTime = static_cast<double>(entry["usPerTick"]);
+                    if (otherTime > 0.0 && result.microsecondsPerTick > 0.0)
+                    {
+                        result.relativeThroughput = otherTime / result.microsecondsPerTick;
+                        std::cerr << result.patch << " @ " << result.blockSize << ": " << precision << " runs at " << result.relativeThroughput << "x the speed of " << other["precision"].toString() << std::endl;
+                    }
+                }
+            }
+        }
+    }
+
+    String toJSON(const Array<Result>& results)
+    {
+        auto* root = new DynamicObject();
+        root->setProperty("version", JucePlugin_VersionString);
+        root->setProperty("precision", precision);
+        root->setProperty("platform", SystemStats::getOperatingSystemName());
+        root->setProperty("cpu", SystemStats::getCpuModel());
+        root->setProperty("seconds", seconds);
+        root->setProperty("samplerate", sampleRate);
+        root->setProperty("peakRSS", getPeakMemoryUsage());
+        root->setProperty("wideLayout", wideLayout);
+        root->setProperty("lockContention", lockContention);
+
+        Array<var> list;
+        for (auto& result : results)
+        {
+            auto* entry = new DynamicObject();
+            entry->setProperty("patch", result.patch);
+            entry->setProperty("blocksize", result.blockSize);
+            entry->setProperty("usPerTick", result.microsecondsPerTick);
+            entry->setProperty("realtimeFactor", result.realtimeFactor);
+            entry->setProperty("allocationsPerBlock", result.allocationsPerBlock);
+            entry->setProperty("hash", result.hash);
+            entry->setProperty("golden", result.golden);
+            entry->setProperty("danglingSlots", result.danglingSlots);
+            if (result.relativeThroughput > 0.0) entry->setProperty("relativeThroughput", result.relativeThroughput);
+            list.add(var(entry));
+        }
+
+        root->setProperty("results", list);
+
+        return JSON::toString(var(root));
+    }
+
+    // Peak resident memory in bytes, or -1 if we can't tell
+    static int64 getPeakMemoryUsage()
+    {
+#if JUCE_LINUX || JUCE_BSD || JUCE_MAC
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+
+#if JUCE_MAC
+        return static_cast<int64>(usage.ru_maxrss);
+#else
+        return static_cast<int64>(usage.ru_maxrss) * 1024;
+#endif
+#else
+        return -1;
+#endif
+    }
+
+    File corpus;
+    File golden;
+    bool updateGolden = false;
+    bool wideLayout = false;
+    bool lockContention = false;
+    double seconds = 10.0;
+    double sampleRate = 44100.0;
+    Array<int> blockSizes;
+};
+
+JUCE_CREATE_APPLICATION_DEFINE(PlugDataBench);
@@ -545,11 +545,12 @@ void Canvas::focusGained(FocusChangeType cause)
 // Used for loading and for complicated actions like undo/redo
 void Canvas::synchronise(bool updatePosition)
 {
+    // setCurrent is applied from pd's queue, so queue it before waiting
+    patch.setCurrent(true);
+    
     pd->waitForStateUpdate();
     deselectAll();
 
-    patch.setCurrent(true);
-
     auto objects = patch.getObjects();
     auto isObjectDeprecated = [&](pd::Object* obj)
     {
@@ -715,10 +716,7 @@ void Canvas::synchronise(bool updatePosition)
     // Resize canvas to fit objects
     checkBounds();
 
-    for (auto& tmpl : templates)
-    {
-        tmpl->updateIfMoved();
-    }
+    updateTemplates(true);
 
     main.updateCommandStatus();
     repaint();
@@ -1054,7 +1052,32 @@ void Canvas::updateDrawables()
     {
         addAndMakeVisible(tmpl);
         tmpl->setAlwaysOnTop(true);
-        tmpl->update();
+    }
+
+    updateTemplates();
+}
+
+// Reads the points of all templates from pd's thread in a single job, so we only wait for pd once
+void Canvas::updateTemplates(bool onlyIfMoved)
+{
+    Array<DrawableTemplate*> toUpdate;
+    for (auto* tmpl : templates)
+    {
+        if (tmpl->prepare(onlyIfMoved)) toUpdate.add(tmpl);
+    }
+
+    if (toUpdate.isEmpty()) return;
+
+    pd->enqueueFunctionAndWait([toUpdate]() {
+        for (auto* tmpl : toUpdate)
+        {
+            tmpl->readPoints();
+        }
+    });
+
+    for (auto* tmpl : toUpdate)
+    {
+        tmpl->drawPoints();
     }
 }
 
@@ -1327,10 +1350,7 @@ void Canvas::checkBounds()
         graphArea->updateBounds();
     }
 
-    for (auto& tmpl : templates)
-    {
-        tmpl->updateIfMoved();
-    }
+    updateTemplates(true);
     
     updatingBounds = false;
 }
@@ -1607,10 +1627,7 @@ void Canvas::handleMouseDrag(const MouseEvent& e)
         }
     }
 
-    for (auto& tmpl : templates)
-    {
-        tmpl->updateIfMoved();
-    }
+    updateTemplates(true);
 }
 
 SelectedItemSet<Component*>& Canvas::getLassoSelection()
@@ -93,6 +93,7 @@ class Canvas : public Component, public Value::Listener, public LassoSource<Comp
 
     void updateSidebarSelection();
     void updateDrawables();
+    void updateTemplates(bool onlyIfMoved = false);
     Array<DrawableTemplate*> findDrawables();
 
     void showSuggestions(Box* box, TextEditor* editor);
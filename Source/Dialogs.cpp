@@ -251,15 +251,33 @@ struct DAWAudioSettings : public Component
         latencyLabel.setText("Latency", dontSendNotification);
         latencyLabel.attachToComponent(&latencySlider, true);
         
+        addAndMakeVisible(oversampleSelector);
+        oversampleSelector.addItemList({"None", "2x", "4x", "8x"}, 1);
+        
+        addAndMakeVisible(oversampleLabel);
+        oversampleLabel.setText("Oversampling", dontSendNotification);
+        oversampleLabel.attachToComponent(&oversampleSelector, true);
+        
+        addAndMakeVisible(idleSkipToggle);
+        idleSkipToggle.setButtonText("Stop DSP when silent for the tail length");
+        
+        addAndMakeVisible(idleSkipLabel);
+        idleSkipLabel.setText("Idle", dontSendNotification);
+        idleSkipLabel.attachToComponent(&idleSkipToggle, true);
+        
         auto* proc = dynamic_cast<PlugDataAudioProcessor*>(&processor);
-        latencySlider.onValueChange = [this, proc]() { proc->setLatencySamples(latencySlider.getValue()); };
+        latencySlider.onValueChange = [this, proc]() { proc->setPatchLatency(static_cast<int>(latencySlider.getValue())); };
         tailLengthSlider.onValueChange = [this, proc]() { proc->tailLength.setValue(tailLengthSlider.getValue());};
+        oversampleSelector.onChange = [this, proc]() { proc->setOversampling(oversampleSelector.getSelectedId() - 1); };
+        idleSkipToggle.onClick = [this, proc]() { proc->setIdleSkipping(idleSkipToggle.getToggleState()); };
     }
 
     void resized() override
     {
         latencySlider.setBounds(90, 5, getWidth() - 130, 20);
         tailLengthSlider.setBounds(90, 30, getWidth() - 130, 20);
+        oversampleSelector.setBounds(90, 55, getWidth() - 130, 20);
+        idleSkipToggle.setBounds(90, 80, getWidth() - 130, 20);
     }
 
     void visibilityChanged() override
@@ -267,8 +285,10 @@ struct DAWAudioSettings : public Component
         if(!isVisible()) return;
         
         auto* proc = dynamic_cast<PlugDataAudioProcessor*>(&processor);
-        latencySlider.setValue(processor.getLatencySamples());
+        latencySlider.setValue(proc->getPatchLatency());
         tailLengthSlider.setValue(static_cast<float>(proc->tailLength.getValue()));
+        oversampleSelector.setSelectedId(proc->getOversampling() + 1, dontSendNotification);
+        idleSkipToggle.setToggleState(proc->getIdleSkipping(), dontSendNotification);
     }
 
     AudioProcessor& processor;
@@ -277,6 +297,12 @@ struct DAWAudioSettings : public Component
     
     Slider latencySlider;
     Slider tailLengthSlider;
+    
+    Label oversampleLabel;
+    ComboBox oversampleSelector;
+    
+    Label idleSkipLabel;
+    ToggleButton idleSkipToggle;
 };
 
 class SearchPathComponent : public Component, public TableListBoxModel
@@ -47,13 +47,10 @@ typedef struct _fake_gatom
 GUIComponent::GUIComponent(pd::Gui pdGui, Box* parent, bool newObject) : box(parent), processor(*parent->cnv->pd), gui(std::move(pdGui)), edited(false)
 {
     // if(!box->pdObject) return;
-    const CriticalSection* cs = box->cnv->pd->getCallbackLock();
     
-    cs->enter();
-    value = gui.getValue();
-    min = gui.getMinimum();
-    max = gui.getMaximum();
-    cs->exit();
+    // Read values from the GUI mirror, so we don't need to touch pd's memory from the message thread
+    // The slot only holds our values once the audio thread activated it, updateValue() fills them in after that
+    gui.setMirrorSlot(processor.guiMirror.addObject(gui.getPointer(), box->cnv->patch.getPointer(), gui.getType()));
     
     if (gui.isIEM())
     {
@@ -87,6 +84,8 @@ GUIComponent::GUIComponent(pd::Gui pdGui, Box* parent, bool newObject) : box(par
 
 GUIComponent::~GUIComponent()
 {
+    processor.guiMirror.removeObject(gui.getMirrorSlot());
+    
     box->removeComponentListener(this);
     auto* lnf = &getLookAndFeel();
     setLookAndFeel(nullptr);
@@ -362,24 +361,36 @@ void GUIComponent::stopEdition() noexcept
 
 void GUIComponent::updateValue()
 {
+    // The audio thread stops publishing when objects might get deleted
+    processor.guiMirror.reactivate(gui.getMirrorSlot());
+    
+    // Until the audio thread activated the slot, it holds defaults or the values of its previous object
+    if (gui.getMirrorSlot() >= 0 && !processor.guiMirror.isActive(gui.getMirrorSlot())) return;
+    
+    // Only follow the range when pd changed it, so we don't undo an edit that pd hasn't seen yet
+    float const minimum = gui.getMinimum();
+    float const maximum = gui.getMaximum();
+    
+    if (minimum != lastMinimum || maximum != lastMaximum)
+    {
+        lastMinimum = minimum;
+        lastMaximum = maximum;
+        
+        min = minimum;
+        max = maximum;
+        
+        rangeChanged();
+    }
+    
     if (!edited)
     {
-        auto thisPtr = SafePointer<GUIComponent>(this);
-        box->cnv->pd->enqueueFunction(
-                                      [thisPtr]()
-                                      {
-                                          float const v = thisPtr->gui.getValue();
-                                          
-                                          MessageManager::callAsync(
-                                                                    [thisPtr, v]() mutable
-                                                                    {
-                                                                        if (thisPtr && v != thisPtr->value)
-                                                                        {
-                                                                            thisPtr->value = v;
-                                                                            thisPtr->update();
-                                                                        }
-                                                                    });
-                                      });
+        float const v = gui.getValue();
+        
+        if (v != value)
+        {
+            value = v;
+            update();
+        }
     }
 }
 
@@ -547,122 +558,98 @@ DrawableTemplate::DrawableTemplate(t_scalar* s, t_gobj* obj, Canvas* cnv, int x,
     setBufferedToImage(true);
 }
 
-void DrawableTemplate::updateIfMoved()
+bool DrawableTemplate::prepare(bool onlyIfMoved)
 {
-    auto pos = canvas->getLocalPoint(canvas->main.getCurrentCanvas(), canvas->getPosition()) * -1;
-    auto bounds = canvas->getParentComponent()->getLocalBounds() + pos;
-    
-    if (lastBounds != bounds)
-    {
-        update();
-    }
+    // Reduce clip region
+    position = canvas->getLocalPoint(canvas->main.getCurrentCanvas(), canvas->getPosition()) * -1;
+    bounds = canvas->getParentComponent()->getLocalBounds();
+
+    if (onlyIfMoved && lastBounds == bounds + position) return false;
+
+    lastBounds = bounds + position;
+    return true;
 }
 
-void DrawableTemplate::update()
+void DrawableTemplate::readPoints()
 {
     auto* glist = canvas->patch.getPointer();
     auto* templ = template_findbyname(scalar->sc_template);
-    
-    bool vis = true;
-    
-    int i, n = object->x_npoints;
-    t_fielddesc* f = object->x_vec;
-    
+
     auto* data = scalar->sc_vec;
-    
+
+    numPoints = object->x_npoints;
+    flags = object->x_flags;
+
     /* see comment in plot_vis() */
-    if (vis && !fielddesc_getfloat(&object->x_vis, templ, data, 0))
+    if (!fielddesc_getfloat(&object->x_vis, templ, data, 0))
     {
         // return;
     }
-    
-    // Reduce clip region
-    auto pos = canvas->getLocalPoint(canvas->main.getCurrentCanvas(), canvas->getPosition()) * -1;
-    auto bounds = canvas->getParentComponent()->getLocalBounds();
-    
-    lastBounds = bounds + pos;
-    
-    if (vis)
+
+    if (numPoints <= 1)
     {
-        if (n > 1)
-        {
-            int flags = object->x_flags, closed = (flags & CLOSED);
-            t_float width = fielddesc_getfloat(&object->x_width, templ, data, 1);
-            
-            char outline[20], fill[20];
-            int pix[200];
-            if (n > 100) n = 100;
-            
-            canvas->pd->getCallbackLock()->enter();
-            
-            for (i = 0, f = object->x_vec; i < n; i++, f += 2)
-            {
-                // glist->gl_havewindow = canvas->isGraphChild;
-                // glist->gl_isgraph = canvas->isGraph;
-                
-                float xCoord = (baseX + fielddesc_getcoord(f, templ, data, 1)) / glist->gl_pixwidth;
-                float yCoord = (baseY + fielddesc_getcoord(f + 1, templ, data, 1)) / glist->gl_pixheight;
-                
-                pix[2 * i] = xCoord * bounds.getWidth() + pos.x;
-                pix[2 * i + 1] = yCoord * bounds.getHeight() + pos.y;
-            }
-            
-            canvas->pd->getCallbackLock()->exit();
-            
-            if (width < 1) width = 1;
-            if (glist->gl_isgraph) width *= glist_getzoom(glist);
-            
-            numbertocolor(fielddesc_getfloat(&object->x_outlinecolor, templ, data, 1), outline);
-            if (flags & CLOSED)
-            {
-                numbertocolor(fielddesc_getfloat(&object->x_fillcolor, templ, data, 1), fill);
-                
-                // sys_vgui(".x%lx.c create polygon\\\n",
-                //     glist_getcanvas(glist));
-            }
-            // else sys_vgui(".x%lx.c create line\\\n", glist_getcanvas(glist));
-            
-            // sys_vgui("%d %d\\\n", pix[2*i], pix[2*i+1]);
-            
-            Path toDraw;
-            
-            if (flags & CLOSED)
-            {
-                toDraw.startNewSubPath(pix[0], pix[1]);
-                for (i = 1; i < n; i++)
-                {
-                    toDraw.lineTo(pix[2 * i], pix[2 * i + 1]);
-                }
-                toDraw.lineTo(pix[0], pix[1]);
-            }
-            else
-            {
-                toDraw.startNewSubPath(pix[0], pix[1]);
-                for (i = 1; i < n; i++)
-                {
-                    toDraw.lineTo(pix[2 * i], pix[2 * i + 1]);
-                }
-            }
-            
-            String objName = String::fromUTF8(object->x_obj.te_g.g_pd->c_name->s_name);
-            if (objName.contains("fill"))
-            {
-                setFill(Colour::fromString("FF" + String::fromUTF8(fill + 1)));
-                setStrokeThickness(0.0f);
-            }
-            else
-            {
-                setFill(Colours::transparentBlack);
-                setStrokeFill(Colour::fromString("FF" + String::fromUTF8(outline + 1)));
-                setStrokeThickness(width);
-            }
-            
-            setPath(toDraw);
-            repaint();
-        }
-        else
-            post("warning: curves need at least two points to be graphed");
+        post("warning: curves need at least two points to be graphed");
+        return;
+    }
+
+    if (numPoints > 100) numPoints = 100;
+
+    width = fielddesc_getfloat(&object->x_width, templ, data, 1);
+    if (width < 1) width = 1;
+    if (glist->gl_isgraph) width *= glist_getzoom(glist);
+
+    numbertocolor(fielddesc_getfloat(&object->x_outlinecolor, templ, data, 1), outline);
+    if (flags & CLOSED)
+    {
+        numbertocolor(fielddesc_getfloat(&object->x_fillcolor, templ, data, 1), fill);
     }
+
+    t_fielddesc* f = object->x_vec;
+    for (int i = 0; i < numPoints; i++, f += 2)
+    {
+        // glist->gl_havewindow = canvas->isGraphChild;
+        // glist->gl_isgraph = canvas->isGraph;
+
+        float xCoord = (baseX + fielddesc_getcoord(f, templ, data, 1)) / glist->gl_pixwidth;
+        float yCoord = (baseY + fielddesc_getcoord(f + 1, templ, data, 1)) / glist->gl_pixheight;
+
+        pix[2 * i] = xCoord * bounds.getWidth() + position.x;
+        pix[2 * i + 1] = yCoord * bounds.getHeight() + position.y;
+    }
+}
+
+void DrawableTemplate::drawPoints()
+{
+    if (numPoints <= 1) return;
+
+    Path toDraw;
+
+    toDraw.startNewSubPath(pix[0], pix[1]);
+    for (int i = 1; i < numPoints; i++)
+    {
+        toDraw.lineTo(pix[2 * i], pix[2 * i + 1]);
+    }
+
+    if (flags & CLOSED)
+    {
+        toDraw.lineTo(pix[0], pix[1]);
+    }
+
+    String objName = String::fromUTF8(object->x_obj.te_g.g_pd->c_name->s_name);
+    if (objName.contains("fill"))
+    {
+        setFill(Colour::fromString("FF" + String::fromUTF8(fill + 1)));
+        setStrokeThickness(0.0f);
+    }
+    else
+    {
+        setFill(Colours::transparentBlack);
+        setStrokeFill(Colour::fromString("FF" + String::fromUTF8(outline + 1)));
+        setStrokeThickness(width);
+    }
+
+    setPath(toDraw);
+    repaint();
 }
 
 struct BangComponent : public GUIComponent
@@ -1526,9 +1513,8 @@ struct SliderComponent : public GUIComponent
         }
         else if (value.refersToSameSourceAs(isLogarithmic))
         {
+            // pd may change the range to fit the log scale, updateValue() picks that up from the mirror
             gui.setLogScale(isLogarithmic == var(true));
-            min = gui.getMinimum();
-            max = gui.getMaximum();
         }
         else
         {
@@ -1549,8 +1535,6 @@ struct RadioComponent : public GUIComponent
     {
         isVertical = vertical;
         
-        numButtons = gui.getMaximum();
-        
         initialise(newObject);
         updateRange();
         
@@ -1615,10 +1599,15 @@ struct RadioComponent : public GUIComponent
         }
     }
     
+    void rangeChanged() override
+    {
+        // Rebuilds the buttons through valueChanged() if the number changed
+        numButtons = static_cast<int>(static_cast<float>(max.getValue()));
+        update();
+    }
+    
     void updateRange()
     {
-        numButtons = gui.getMaximum();
-        
         radioButtons.clear();
         
         for (int i = 0; i < numButtons; i++)
@@ -1644,7 +1633,10 @@ struct RadioComponent : public GUIComponent
         }
         
         int idx = getValueOriginal();
-        radioButtons[idx]->setToggleState(true, dontSendNotification);
+        if (idx >= 0 && idx < radioButtons.size())
+        {
+            radioButtons[idx]->setToggleState(true, dontSendNotification);
+        }
         
         resized();
         //box->updateBounds(false);
@@ -2758,6 +2750,94 @@ struct PictureComponent : public GUIComponent
     Image img;
 };
 
+// Draws [oscope~] and cyclone's [scope~] from the frames published by the audio thread
+// The objects skip their Tk redraw while we're watching them
+struct ScopeComponent : public GUIComponent, public Timer
+{
+    ScopeComponent(const pd::Gui& gui, Box* box, bool newObject) : GUIComponent(gui, box, newObject)
+    {
+        initialise(newObject);
+        startTimerHz(30);
+    }
+
+    ~ScopeComponent() override
+    {
+        stopTimer();
+    }
+
+    void paint(Graphics& g) override
+    {
+        auto toColour = [](const std::array<uint8_t, 3>& rgb) { return Colour(rgb[0], rgb[1], rgb[2]); };
+
+        auto const w = static_cast<float>(getWidth());
+        auto const h = static_cast<float>(getHeight());
+
+        g.fillAll(toColour(frame.background));
+
+        // Same 8 by 4 grid as the Tk version
+        g.setColour(toColour(frame.grid));
+        for (int i = 1; i < 8; i++) g.drawVerticalLine(roundToInt(w * i / 8.0f), 0.0f, h);
+        for (int i = 1; i < 4; i++) g.drawHorizontalLine(roundToInt(h * i / 4.0f), 0.0f, w);
+
+        auto const numPoints = frame.numPoints;
+        auto const range = frame.max - frame.min;
+
+        if (!frame.xyMode || numPoints < 2 || range == 0.0f) return;
+
+        Path path;
+        for (int i = 0; i < numPoints; i++)
+        {
+            float x, y;
+
+            // Mode 1 only has the left signal, mode 2 only the right one, mode 3 is x/y
+            if (frame.xyMode == 1)
+            {
+                x = w * i / numPoints;
+                y = (h - 1.0f) - (h - 2.0f) / range * (frame.x[i] - frame.min);
+            }
+            else if (frame.xyMode == 2)
+            {
+                x = (w - 1.0f) - (w - 2.0f) / range * (frame.y[i] - frame.min);
+                y = h * i / numPoints;
+            }
+            else
+            {
+                x = (w - 2.0f) / range * (frame.x[i] - frame.min);
+                y = h - (h - 2.0f) / range * (frame.y[i] - frame.min);
+            }
+
+            x = jlimit(0.0f, w, x);
+            y = jlimit(0.0f, h, y);
+
+            if (i == 0)
+                path.startNewSubPath(x, y);
+            else
+                path.lineTo(x, y);
+        }
+
+        g.setColour(toColour(frame.foreground));
+        g.strokePath(path, PathStrokeType(1.0f));
+    }
+
+    void timerCallback() override
+    {
+        // The audio thread stops publishing when objects might get deleted
+        processor.guiMirror.reactivate(gui.getMirrorSlot());
+
+        auto const lastFrame = frame.frame;
+        auto const lastSettings = std::make_tuple(frame.xyMode, frame.min, frame.max, frame.background, frame.foreground, frame.grid);
+
+        if (!processor.guiMirror.getScopeFrame(gui.getMirrorSlot(), frame)) return;
+
+        if (frame.frame != lastFrame || std::make_tuple(frame.xyMode, frame.min, frame.max, frame.background, frame.foreground, frame.grid) != lastSettings)
+        {
+            repaint();
+        }
+    }
+
+    pd::GuiMirror::ScopeFrame frame;
+};
+
 GUIComponent* GUIComponent::createGui(const String& name, Box* parent, bool newObject)
 {
     auto* guiPtr = dynamic_cast<pd::Gui*>(parent->pdObject.get());
@@ -2850,6 +2930,10 @@ GUIComponent* GUIComponent::createGui(const String& name, Box* parent, bool newO
     {
         return new PictureComponent(gui, parent, newObject);
     }
+    if (gui.getType() == pd::Type::Scope)
+    {
+        return new ScopeComponent(gui, parent, newObject);
+    }
     
     return nullptr;
 }
@@ -31,6 +31,12 @@ struct GUIComponent : public Component, public ComponentListener, public Value::
 
     virtual void update(){};
 
+    // Called when pd changed the minimum or maximum
+    virtual void rangeChanged()
+    {
+        update();
+    }
+
     void initialise(bool newObject);
 
     // Most objects ignore mouseclicks when locked
@@ -102,6 +108,10 @@ struct GUIComponent : public Component, public ComponentListener, public Value::
     float value = 0;
     Value min = Value(0.0f);
     Value max = Value(0.0f);
+
+    // The range last read from the mirror
+    float lastMinimum = std::numeric_limits<float>::quiet_NaN();
+    float lastMaximum = std::numeric_limits<float>::quiet_NaN();
     int width = 6;
 
     Value sendSymbol;
@@ -148,9 +158,25 @@ struct DrawableTemplate : public DrawablePath
 
     Rectangle<int> lastBounds;
 
+    // Clip region, set on the message thread before the points are read
+    Rectangle<int> bounds;
+    Point<int> position;
+
+    // Read from pd's thread, drawn on the message thread
+    int numPoints = 0;
+    int flags = 0;
+    float width = 1.0f;
+    char outline[20] = {0};
+    char fill[20] = {0};
+    int pix[200] = {0};
+
     DrawableTemplate(t_scalar* s, t_gobj* obj, Canvas* cnv, int x, int y);
 
-    void update();
+    // Returns false if only moved templates should be updated and this one didn't move
+    bool prepare(bool onlyIfMoved);
+
+    // Only call this from pd's thread, see Canvas::updateTemplates()
+    void readPoints();
 
-    void updateIfMoved();
+    void drawPoints();
 };
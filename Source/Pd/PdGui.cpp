@@ -20,6 +20,7 @@ extern "C"
 #include <z_libpd.h>
 
 #include "x_libpd_extra_utils.h"
+#include "x_libpd_scope.h"
 
 void my_numbox_calc_fontwidth(t_my_numbox* x);
 }
@@ -201,6 +202,11 @@ Type Gui::getType(void* ptr) noexcept
     {
         type = Type::Picture;
     }
+    // [oscope~], [scope~] and their aliases
+    else if (libpd_scope_get(ptr))
+    {
+        type = Type::Scope;
+    }
 
 
     else if (name == "gatom")
@@ -271,6 +277,16 @@ size_t Gui::getNumberOfSteps() const noexcept
 }
 
 float Gui::getMinimum() const noexcept
+{
+    if (mirrorSlot >= 0)
+    {
+        return instance->guiMirror.getState(mirrorSlot).minimum;
+    }
+
+    return getMinimum(ptr, type);
+}
+
+float Gui::getMinimum(void* ptr, Type type) noexcept
 {
     if (!ptr) return 0.f;
     if (type == Type::HorizontalSlider)
@@ -298,6 +314,16 @@ float Gui::getMinimum() const noexcept
 }
 
 float Gui::getMaximum() const noexcept
+{
+    if (mirrorSlot >= 0)
+    {
+        return instance->guiMirror.getState(mirrorSlot).maximum;
+    }
+
+    return getMaximum(ptr, type);
+}
+
+float Gui::getMaximum(void* ptr, Type type) noexcept
 {
     if (!ptr) return 1.f;
     if (type == Type::HorizontalSlider)
@@ -397,6 +423,26 @@ void Gui::setMaximum(float value) noexcept
 }
 
 float Gui::getValue() const noexcept
+{
+    if (mirrorSlot >= 0)
+    {
+        auto const state = instance->guiMirror.getState(mirrorSlot);
+
+        if (type == Type::Bang)
+        {
+            // Report every bang that happened since we last looked
+            bool const banged = state.numBangs != lastNumBangs;
+            lastNumBangs = state.numBangs;
+            return banged ? 1.0f : 0.0f;
+        }
+
+        return state.value;
+    }
+
+    return getValue(ptr, type);
+}
+
+float Gui::getValue(void* ptr, Type type) noexcept
 {
     if (!ptr) return 0.f;
     if (type == Type::HorizontalSlider)
@@ -447,7 +493,17 @@ float Gui::getValue() const noexcept
 
 float Gui::getPeak() const noexcept
 {
-    if (type == Type::VuMeter)
+    if (mirrorSlot >= 0)
+    {
+        return instance->guiMirror.getState(mirrorSlot).peak;
+    }
+
+    return getPeak(ptr, type);
+}
+
+float Gui::getPeak(void* ptr, Type type) noexcept
+{
+    if (ptr && type == Type::VuMeter)
     {
         return static_cast<t_vu*>(ptr)->x_fr;
     }
@@ -466,6 +522,10 @@ std::vector<Atom> Gui::getList() const noexcept
 {
     if (!ptr || type != Type::AtomList)
         return {};
+    else if (mirrorSlot >= 0)
+    {
+        return instance->guiMirror.getState(mirrorSlot).getAtoms();
+    }
     else
     {
         std::vector<Atom> array;
@@ -558,6 +618,15 @@ std::string Gui::getSymbol() const noexcept
         
         return result;
     }
+    else if (ptr && type == Type::AtomSymbol && mirrorSlot >= 0)
+    {
+        auto const state = instance->guiMirror.getState(mirrorSlot);
+        if (state.numAtoms && state.symbols[0] >= 0)
+        {
+            return state.text.data() + state.symbols[0];
+        }
+        return {};
+    }
     else if (ptr && type == Type::AtomSymbol)
     {
         instance->setThis();
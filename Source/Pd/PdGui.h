@@ -63,6 +63,23 @@ class Gui : public Object
     float getValue() const noexcept;
     float getPeak() const noexcept;
 
+    //! @brief Reads the value directly from pd, only call this from pd's thread.
+    static float getValue(void* ptr, Type type) noexcept;
+    static float getPeak(void* ptr, Type type) noexcept;
+    static float getMinimum(void* ptr, Type type) noexcept;
+    static float getMaximum(void* ptr, Type type) noexcept;
+
+    //! @brief Makes the getters read from the instance's GuiMirror instead of from pd.
+    void setMirrorSlot(int slot) noexcept
+    {
+        mirrorSlot = slot;
+    }
+
+    int getMirrorSlot() const noexcept
+    {
+        return mirrorSlot;
+    }
+
     void setValue(float value) noexcept;
 
     size_t getNumberOfSteps() const noexcept;
@@ -115,6 +132,10 @@ class Gui : public Object
 
    private:
     Type type = Type::Undefined;
+
+    int mirrorSlot = -1;
+    mutable uint32_t lastNumBangs = 0;
+
     friend class Patch;
 
     // pd expresses some object's width in characters
@@ -0,0 +1,477 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "PdGuiMirror.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "PdGui.h"
+#include "PdInstance.h"
+
+extern "C"
+{
+#include <m_pd.h>
+#include <g_canvas.h>
+
+#include "x_libpd_scope.h"
+#include "s_libpd_inter.h"
+}
+
+namespace pd
+{
+
+static bool glistContains(void* glist, void* object)
+{
+    for (t_gobj* y = static_cast<t_glist*>(glist)->gl_list; y; y = y->g_next)
+    {
+        if (y == object) return true;
+    }
+
+    return false;
+}
+
+// Copies the atoms of an atom box into a state, without allocating
+static void getAtoms(void* object, GuiMirror::State& state)
+{
+    auto* binbuf = static_cast<t_text*>(object)->te_binbuf;
+    int const ac = std::min(binbuf_getnatom(binbuf), GuiMirror::maxAtoms);
+    t_atom const* av = binbuf_getvec(binbuf);
+
+    int offset = 0;
+    state.numAtoms = 0;
+
+    for (int i = 0; i < ac; i++)
+    {
+        if (av[i].a_type == A_SYMBOL)
+        {
+            auto const* name = av[i].a_w.w_symbol->s_name;
+            auto const length = static_cast<int>(strlen(name));
+
+            // Out of space, drop the rest of the list
+            if (offset + length + 1 > GuiMirror::maxText) break;
+
+            std::memcpy(state.text.data() + offset, name, length + 1);
+            state.symbols[i] = static_cast<int16_t>(offset);
+            state.floats[i] = 0.0f;
+            offset += length + 1;
+        }
+        else
+        {
+            state.symbols[i] = -1;
+            state.floats[i] = av[i].a_type == A_FLOAT ? av[i].a_w.w_float : 0.0f;
+        }
+
+        state.numAtoms++;
+    }
+}
+
+static bool hasSameAtoms(GuiMirror::State const& first, GuiMirror::State const& second)
+{
+    if (first.numAtoms != second.numAtoms) return false;
+
+    for (int i = 0; i < first.numAtoms; i++)
+    {
+        if (first.symbols[i] != second.symbols[i]) return false;
+
+        if (first.symbols[i] < 0)
+        {
+            if (first.floats[i] != second.floats[i]) return false;
+        }
+        else if (strcmp(first.text.data() + first.symbols[i], second.text.data() + second.symbols[i]) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::vector<Atom> GuiMirror::State::getAtoms() const
+{
+    std::vector<Atom> atoms;
+    atoms.reserve(numAtoms);
+
+    for (int i = 0; i < numAtoms; i++)
+    {
+        if (symbols[i] >= 0)
+        {
+            atoms.emplace_back(text.data() + symbols[i]);
+        }
+        else
+        {
+            atoms.emplace_back(floats[i]);
+        }
+    }
+
+    return atoms;
+}
+
+GuiMirror::GuiMirror(Instance& parent) : instance(parent), slots(new Slot[maxSlots])
+{
+}
+
+bool GuiMirror::isMirrored(Type type) noexcept
+{
+    switch (type)
+    {
+        case Type::HorizontalSlider:
+        case Type::VerticalSlider:
+        case Type::Toggle:
+        case Type::Number:
+        case Type::HorizontalRadio:
+        case Type::VerticalRadio:
+        case Type::Bang:
+        case Type::VuMeter:
+        case Type::AtomNumber:
+        case Type::AtomSymbol:
+        case Type::AtomList:
+        case Type::Scope:
+            return true;
+        default:
+            return false;
+    }
+}
+
+int GuiMirror::addObject(void* object, void* glist, Type type)
+{
+    if (!object || !glist || !isMirrored(type)) return -1;
+
+    auto it = std::find(used.begin(), used.end(), false);
+    if (it == used.end()) return -1;
+
+    int const slot = static_cast<int>(it - used.begin());
+    *it = true;
+
+    if (slot >= numSlots.load())
+    {
+        numSlots.store(slot + 1, std::memory_order_release);
+    }
+
+    // Allocated before activation, so the audio thread never sees a scope without it
+    if (type == Type::Scope && !slots[slot].scope)
+    {
+        slots[slot].scope = std::make_unique<ScopeSlot>();
+    }
+
+    slots[slot].pending = true;
+    slots[slot].pendingGlist.store(glist, std::memory_order_relaxed);
+    slots[slot].pendingObject.store(object, std::memory_order_release);
+
+    instance.enqueueFunction([this, slot, object, glist, type]() {
+        auto& s = slots[slot];
+
+        // pd freed it in the meantime, or the slot was given to another object
+        if (s.pendingObject.load(std::memory_order_acquire) != object || s.pendingGlist.load(std::memory_order_relaxed) != glist)
+        {
+            s.pending = false;
+            return;
+        }
+
+        activate(slot, object, glist, type);
+    });
+
+    return slot;
+}
+
+void GuiMirror::removeObject(int slot)
+{
+    if (slot < 0 || slot >= maxSlots) return;
+
+    used[slot] = false;
+
+    // If the slot gets reused, its activation will be queued after this
+    instance.enqueueFunction([this, slot]() {
+        auto& s = slots[slot];
+        auto* object = s.object.load(std::memory_order_relaxed);
+
+        // Active objects still exist, let the scope go back to drawing through Tk
+        if (object && s.type == Type::Scope)
+        {
+            libpd_scope_get(object)->s_watched = 0;
+        }
+
+        s.object.store(nullptr, std::memory_order_relaxed);
+    });
+}
+
+void GuiMirror::reactivate(int slot)
+{
+    if (slot < 0 || slot >= maxSlots || !used[slot] || isActive(slot)) return;
+
+    // Don't flood the queue while waiting for the audio thread
+    if (slots[slot].pending.exchange(true)) return;
+
+    instance.enqueueFunction([this, slot]() {
+        auto& s = slots[slot];
+        activate(slot, s.lastObject, s.glist, s.type);
+    });
+}
+
+void GuiMirror::activate(int slot, void* object, void* glist, Type type)
+{
+    auto& s = slots[slot];
+    s.pending = false;
+
+    // The object may have been deleted before we got here
+    if (!object || !glist || !glistContains(glist, object)) return;
+
+    // Don't show the values of the previous owner of this slot
+    if (s.lastObject != object)
+    {
+        auto const sequence = s.sequence.load(std::memory_order_relaxed);
+        s.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        s.state = State();
+
+        s.sequence.store(sequence + 2, std::memory_order_release);
+
+        if (s.scope)
+        {
+            auto const scopeSequence = s.scope->sequence.load(std::memory_order_relaxed);
+            s.scope->sequence.store(scopeSequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            s.scope->frame = ScopeFrame();
+
+            s.scope->sequence.store(scopeSequence + 2, std::memory_order_release);
+        }
+    }
+
+    // Tells us when pd frees the object or its canvas, whatever frees it
+    watch_free(pd_class(static_cast<t_pd*>(object)));
+    watch_free(pd_class(static_cast<t_pd*>(glist)));
+
+    // Stops the scope from scheduling Tk redraws, we draw it ourselves
+    if (type == Type::Scope)
+    {
+        libpd_scope_get(object)->s_watched = 1;
+    }
+
+    s.glist = glist;
+    s.type = type;
+    s.lastObject = object;
+
+    // Seed the slot with the object's values, so it never reads as active with the defaults
+    if (type == Type::Scope)
+    {
+        publishScope(s, object);
+    }
+    else
+    {
+        publishSlot(s, object);
+    }
+
+    s.object.store(object, std::memory_order_release);
+
+    // Makes the editor read the values of the slot we just activated
+    instance.receiveGuiUpdate(1);
+}
+
+bool GuiMirror::isActive(int slot) const noexcept
+{
+    if (slot < 0 || slot >= maxSlots) return false;
+
+    return slots[slot].object.load(std::memory_order_acquire) != nullptr;
+}
+
+GuiMirror::State GuiMirror::getState(int slot) const noexcept
+{
+    State result;
+
+    if (slot < 0 || slot >= maxSlots) return result;
+
+    auto const& s = slots[slot];
+
+    while (true)
+    {
+        auto const before = s.sequence.load(std::memory_order_acquire);
+
+        // The audio thread is writing, this only takes a moment
+        if (before & 1) continue;
+
+        result = s.state;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (s.sequence.load(std::memory_order_relaxed) == before) return result;
+    }
+}
+
+bool GuiMirror::getScopeFrame(int slot, ScopeFrame& frame) const noexcept
+{
+    if (slot < 0 || slot >= maxSlots || !slots[slot].scope) return false;
+
+    auto const& scope = *slots[slot].scope;
+
+    while (true)
+    {
+        auto const before = scope.sequence.load(std::memory_order_acquire);
+
+        if (before & 1) continue;
+
+        frame = scope.frame;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (scope.sequence.load(std::memory_order_relaxed) == before) return true;
+    }
+}
+
+// Copies a scope's last frame when it completed a new one or its settings changed
+void GuiMirror::publishScope(Slot& s, void* object) noexcept
+{
+    auto const* display = libpd_scope_get(object);
+    if (!display || !s.scope) return;
+
+    auto& frame = s.scope->frame;
+
+    auto const numPoints = std::clamp(*display->s_npoints, 0, maxScopePoints);
+    bool const settingsChanged = *display->s_xymode != frame.xyMode || *display->s_min != frame.min || *display->s_max != frame.max || std::memcmp(display->s_bg, frame.background.data(), 3) != 0 || std::memcmp(display->s_fg, frame.foreground.data(), 3) != 0 || std::memcmp(display->s_grid, frame.grid.data(), 3) != 0;
+
+    if (display->s_frame == frame.frame && numPoints == frame.numPoints && !settingsChanged) return;
+
+    auto const sequence = s.scope->sequence.load(std::memory_order_relaxed);
+    s.scope->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    frame.frame = display->s_frame;
+    frame.numPoints = numPoints;
+    frame.xyMode = *display->s_xymode;
+    frame.min = *display->s_min;
+    frame.max = *display->s_max;
+
+    std::memcpy(frame.background.data(), display->s_bg, 3);
+    std::memcpy(frame.foreground.data(), display->s_fg, 3);
+    std::memcpy(frame.grid.data(), display->s_grid, 3);
+
+    std::copy(display->s_x, display->s_x + numPoints, frame.x.begin());
+    std::copy(display->s_y, display->s_y + numPoints, frame.y.begin());
+
+    s.scope->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+// Copies the values of an object when any of them changed
+void GuiMirror::publishSlot(Slot& s, void* object) noexcept
+{
+    float value = 0.0f;
+    float peak = 0.0f;
+    bool bang = false;
+    bool atomsChanged = false;
+
+    if (s.type == Type::AtomNumber || s.type == Type::AtomSymbol || s.type == Type::AtomList)
+    {
+        getAtoms(object, scratch);
+        atomsChanged = !hasSameAtoms(scratch, s.state);
+        value = (scratch.numAtoms && scratch.symbols[0] < 0) ? scratch.floats[0] : 0.0f;
+    }
+    else if (s.type == Type::Bang)
+    {
+        // This resets the bang's flash, which is fine since we own pd's state here
+        bang = Gui::getValue(object, s.type) != 0.0f;
+    }
+    else
+    {
+        value = Gui::getValue(object, s.type);
+        peak = Gui::getPeak(object, s.type);
+    }
+
+    float const minimum = Gui::getMinimum(object, s.type);
+    float const maximum = Gui::getMaximum(object, s.type);
+
+    if (!bang && !atomsChanged && value == s.state.value && peak == s.state.peak && minimum == s.state.minimum && maximum == s.state.maximum) return;
+
+    auto const sequence = s.sequence.load(std::memory_order_relaxed);
+    s.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    s.state.value = value;
+    s.state.peak = peak;
+    s.state.minimum = minimum;
+    s.state.maximum = maximum;
+
+    if (bang) s.state.numBangs++;
+
+    if (atomsChanged)
+    {
+        s.state.numAtoms = scratch.numAtoms;
+        s.state.floats = scratch.floats;
+        s.state.symbols = scratch.symbols;
+        s.state.text = scratch.text;
+    }
+
+    s.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void GuiMirror::publish() noexcept
+{
+    auto const n = numSlots.load(std::memory_order_acquire);
+
+    for (int i = 0; i < n; i++)
+    {
+        auto& s = slots[i];
+        auto* object = s.object.load(std::memory_order_relaxed);
+
+        if (!object) continue;
+
+        if (s.type == Type::Scope)
+        {
+            publishScope(s, object);
+        }
+        else
+        {
+            publishSlot(s, object);
+        }
+    }
+}
+
+void GuiMirror::objectFreed(void* object) noexcept
+{
+    auto const n = numSlots.load(std::memory_order_acquire);
+
+    for (int i = 0; i < n; i++)
+    {
+        auto& s = slots[i];
+
+        // Cancel activations that haven't happened yet
+        auto* pendingObject = s.pendingObject.load(std::memory_order_acquire);
+        if (pendingObject && (pendingObject == object || s.pendingGlist.load(std::memory_order_relaxed) == object))
+        {
+            s.pendingObject.compare_exchange_strong(pendingObject, nullptr, std::memory_order_acq_rel);
+        }
+
+        if (s.lastObject != object && s.glist != object) continue;
+
+        // publish() runs on this thread, so it won't see the object again
+        s.object.store(nullptr, std::memory_order_relaxed);
+
+        // reactivate() would use these
+        s.lastObject = nullptr;
+        s.glist = nullptr;
+    }
+}
+
+void GuiMirror::clear() noexcept
+{
+    auto const n = numSlots.load(std::memory_order_acquire);
+
+    for (int i = 0; i < n; i++)
+    {
+        auto& s = slots[i];
+        auto* object = s.object.load(std::memory_order_relaxed);
+
+        // Scopes redraw through Tk until they're reactivated
+        if (object && s.type == Type::Scope)
+        {
+            libpd_scope_get(object)->s_watched = 0;
+        }
+
+        s.object.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace pd
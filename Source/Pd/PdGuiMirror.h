@@ -0,0 +1,156 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+
+#include "PdAtom.h"
+#include "PdObject.h"
+
+namespace pd
+{
+
+//! @brief A lock-free copy of the values of GUI objects.
+//! @details The audio thread publishes the values of all registered objects after each tick,\n
+//! the message thread only reads from the copy, so it never has to touch pd's memory.\n
+//! Every slot is protected by a sequence lock: the writer never waits and the reader retries\n
+//! when it sees a write in progress.
+//! @see Gui, Instance
+class GuiMirror
+{
+   public:
+    static inline constexpr int maxSlots = 1024;
+    static inline constexpr int maxAtoms = 32;
+    static inline constexpr int maxText = 512;
+    static inline constexpr int maxScopePoints = 1024;
+
+    //! @brief The published state of a single GUI object.
+    struct State
+    {
+        float value = 0.0f;
+        float peak = 0.0f;
+        float minimum = 0.0f;
+        float maximum = 1.0f;
+        uint32_t numBangs = 0;
+
+        int numAtoms = 0;
+        std::array<float, maxAtoms> floats = {0};
+        // Offset into text for symbols, -1 for floats
+        std::array<int16_t, maxAtoms> symbols = {0};
+        std::array<char, maxText> text = {0};
+
+        std::vector<Atom> getAtoms() const;
+    };
+
+    //! @brief The last complete frame of a scope, with the settings needed to draw it.
+    struct ScopeFrame
+    {
+        uint32_t frame = 0;
+        int numPoints = 0;
+        int xyMode = 0;
+        float min = -1.0f;
+        float max = 1.0f;
+
+        std::array<uint8_t, 3> background = {0};
+        std::array<uint8_t, 3> foreground = {0};
+        std::array<uint8_t, 3> grid = {0};
+
+        std::array<float, maxScopePoints> x = {0};
+        std::array<float, maxScopePoints> y = {0};
+    };
+
+    explicit GuiMirror(Instance& instance);
+
+    //! @brief If objects of this type have a value that should be mirrored.
+    static bool isMirrored(Type type) noexcept;
+
+    //! @brief Reserves a slot for an object, call from the message thread.
+    //! @details Returns -1 if the type isn't mirrored or all slots are in use.\n
+    //! The slot holds the object's values once the audio thread activated it, see isActive().
+    int addObject(void* object, void* glist, Type type);
+
+    //! @brief Releases a slot, call from the message thread.
+    void removeObject(int slot);
+
+    //! @brief Asks the audio thread to start publishing this slot again after clear() was called.
+    void reactivate(int slot);
+
+    //! @brief If the audio thread is currently publishing this slot.
+    bool isActive(int slot) const noexcept;
+
+    //! @brief Reads the last published state without locking.
+    State getState(int slot) const noexcept;
+
+    //! @brief Reads the last published scope frame without locking.
+    //! @details Returns false if the slot doesn't belong to a scope.
+    bool getScopeFrame(int slot, ScopeFrame& frame) const noexcept;
+
+    //! @brief Publishes the values of all active slots, only call this from pd's thread.
+    void publish() noexcept;
+
+    //! @brief Stops publishing an object that pd is about to free, only call this from pd's thread.
+    //! @details Called for every object of a watched class and every canvas, however pd frees it.\n
+    //! Drops the slots of the object and of everything on the canvas, and cancels their pending activations.
+    void objectFreed(void* object) noexcept;
+
+    //! @brief Stops publishing all slots, only call this from pd's thread.
+    //! @details Must be called before anything that may delete objects.\n
+    //! Objects that still exist afterwards are re-registered with reactivate().
+    void clear() noexcept;
+
+   private:
+    struct ScopeSlot
+    {
+        std::atomic<uint32_t> sequence = 0;
+        ScopeFrame frame;
+    };
+
+    struct Slot
+    {
+        std::atomic<void*> object = nullptr;
+
+        // Only used by pd's thread
+        void* lastObject = nullptr;
+        void* glist = nullptr;
+        Type type = Type::Undefined;
+
+        std::atomic<bool> pending = false;
+
+        // What addObject() asked to publish, cleared when pd frees it before it got activated
+        std::atomic<void*> pendingObject = nullptr;
+        std::atomic<void*> pendingGlist = nullptr;
+
+        std::atomic<uint32_t> sequence = 0;
+
+        State state;
+
+        // Only allocated for scopes, and kept when the slot gets reused
+        std::unique_ptr<ScopeSlot> scope;
+    };
+
+    void activate(int slot, void* object, void* glist, Type type);
+
+    void publishSlot(Slot& slot, void* object) noexcept;
+    static void publishScope(Slot& slot, void* object) noexcept;
+
+    Instance& instance;
+
+    std::unique_ptr<Slot[]> slots;
+
+    // Only used by pd's thread
+    State scratch;
+
+    // Only used by the message thread
+    std::array<bool, maxSlots> used = {false};
+
+    std::atomic<int> numSlots = 0;
+};
+
+}  // namespace pd
@@ -14,6 +14,7 @@ extern "C"
 #include "x_libpd_extra_utils.h"
 #include "x_libpd_mod_utils.h"
 #include "x_libpd_multi.h"
+#include "x_libpd_midiqueue.h"
 }
 
 #include "PdInstance.h"
@@ -67,37 +68,37 @@ extern "C"
 
         static void instance_multi_noteon(pd::Instance* ptr, int channel, int pitch, int velocity)
         {
-            ptr->enqueueFunction([ptr, channel, pitch, velocity]() mutable { ptr->processMidiEvent({midievent::NOTEON, channel, pitch, velocity}); });
+            ptr->processMidiEvent({midievent::NOTEON, channel, pitch, velocity});
         }
 
         static void instance_multi_controlchange(pd::Instance* ptr, int channel, int controller, int value)
         {
-            ptr->enqueueFunction([ptr, channel, controller, value]() mutable { ptr->processMidiEvent({midievent::CONTROLCHANGE, channel, controller, value}); });
+            ptr->processMidiEvent({midievent::CONTROLCHANGE, channel, controller, value});
         }
 
         static void instance_multi_programchange(pd::Instance* ptr, int channel, int value)
         {
-            ptr->enqueueFunction([ptr, channel, value]() mutable { ptr->processMidiEvent({midievent::PROGRAMCHANGE, channel, value, 0}); });
+            ptr->processMidiEvent({midievent::PROGRAMCHANGE, channel, value, 0});
         }
 
         static void instance_multi_pitchbend(pd::Instance* ptr, int channel, int value)
         {
-            ptr->enqueueFunction([ptr, channel, value]() mutable { ptr->processMidiEvent({midievent::PROGRAMCHANGE, channel, value, 0}); });
+            ptr->processMidiEvent({midievent::PITCHBEND, channel, value, 0});
         }
 
         static void instance_multi_aftertouch(pd::Instance* ptr, int channel, int value)
         {
-            ptr->enqueueFunction([ptr, channel, value]() mutable { ptr->processMidiEvent({midievent::AFTERTOUCH, channel, value, 0}); });
+            ptr->processMidiEvent({midievent::AFTERTOUCH, channel, value, 0});
         }
 
         static void instance_multi_polyaftertouch(pd::Instance* ptr, int channel, int pitch, int value)
         {
-            ptr->enqueueFunction([ptr, channel, pitch, value]() mutable { ptr->processMidiEvent({midievent::POLYAFTERTOUCH, channel, pitch, value}); });
+            ptr->processMidiEvent({midievent::POLYAFTERTOUCH, channel, pitch, value});
         }
 
         static void instance_multi_midibyte(pd::Instance* ptr, int port, int byte)
         {
-            ptr->enqueueFunction([ptr, port, byte]() mutable { ptr->processMidiEvent({midievent::MIDIBYTE, port, byte, 0}); });
+            ptr->processMidiEvent({midievent::MIDIBYTE, port, byte, 0});
         }
 
         static void instance_multi_print(pd::Instance* ptr, char const* s)
@@ -113,7 +114,7 @@ namespace pd
 
 
 
-Instance::Instance(std::string const& symbol)
+Instance::Instance(std::string const& symbol) : guiMirror(*this)
 {
     libpd_multi_init();
 
@@ -125,6 +126,7 @@ Instance::Instance(std::string const& symbol)
                              reinterpret_cast<t_libpd_multi_pitchbendhook>(internal::instance_multi_pitchbend), reinterpret_cast<t_libpd_multi_aftertouchhook>(internal::instance_multi_aftertouch), reinterpret_cast<t_libpd_multi_polyaftertouchhook>(internal::instance_multi_polyaftertouch),
                              reinterpret_cast<t_libpd_multi_midibytehook>(internal::instance_multi_midibyte));
     m_print_receiver = libpd_multi_print_new(this, reinterpret_cast<t_libpd_multi_printhook>(internal::instance_multi_print));
+    m_midi_queue = libpd_midiqueue_new();
 
     m_message_receiver = libpd_multi_receiver_new(this, symbol.c_str(), reinterpret_cast<t_libpd_multi_banghook>(internal::instance_multi_bang), reinterpret_cast<t_libpd_multi_floathook>(internal::instance_multi_float), reinterpret_cast<t_libpd_multi_symbolhook>(internal::instance_multi_symbol),
                                                   reinterpret_cast<t_libpd_multi_listhook>(internal::instance_multi_list), reinterpret_cast<t_libpd_multi_messagehook>(internal::instance_multi_message));
@@ -156,6 +158,11 @@ Instance::Instance(std::string const& symbol)
 
     register_gui_triggers(static_cast<t_pdinstance*>(m_instance), this, gui_trigger, panel_trigger, synchronise_trigger);
 
+    // Objects can be freed without plugdata asking for it, by dynamic patching, reloading abstractions or closing patches
+    auto free_trigger = [](void* instance, void* object) { static_cast<Instance*>(instance)->guiMirror.objectFreed(object); };
+
+    register_free_trigger(static_cast<t_pdinstance*>(m_instance), this, free_trigger);
+
     libpd_set_verbose(0);
     
     setThis();
@@ -169,6 +176,7 @@ Instance::~Instance()
     pd_free(static_cast<t_pd*>(m_print_receiver));
 
     libpd_set_instance(static_cast<t_pdinstance*>(m_instance));
+    libpd_midiqueue_free(m_midi_queue);
     libpd_free_instance(static_cast<t_pdinstance*>(m_instance));
 }
 
@@ -181,6 +189,7 @@ void Instance::prepareDSP(const int nins, const int nouts, const double samplera
 {
     libpd_set_instance(static_cast<t_pdinstance*>(m_instance));
     libpd_init_audio(nins, nouts, static_cast<int>(samplerate));
+    tickStartTime = clock_getlogicaltime();
 }
 
 void Instance::startDSP()
@@ -198,10 +207,28 @@ void Instance::releaseDSP()
     libpd_message("pd", "dsp", 1, &av);
 }
 
-void Instance::performDSP(float const* inputs, float* outputs)
+void Instance::performDSP(Sample const* const* inputs, Sample* const* outputs)
+{
+    libpd_set_instance(static_cast<t_pdinstance*>(m_instance));
+    libpd_process_channels(inputs, outputs);
+
+    // The next tick starts where this one ended
+    tickStartTime = clock_getlogicaltime();
+}
+
+bool Instance::performIdle()
 {
     libpd_set_instance(static_cast<t_pdinstance*>(m_instance));
-    libpd_process_raw(inputs, outputs);
+    if (libpd_process_idle() != 0) return false;
+
+    tickStartTime = clock_getlogicaltime();
+    return true;
+}
+
+int Instance::getSampleOffset() const
+{
+    auto const offset = static_cast<int>(clock_gettimesince(tickStartTime) * sys_getsr() / 1000.0);
+    return std::clamp(offset, 0, getBlockSize() - 1);
 }
 
 void Instance::sendNoteOn(const int channel, const int pitch, const int velocity) const
@@ -258,6 +285,18 @@ void Instance::sendMidiByte(const int port, const int byte) const
     libpd_midibyte(port, byte);
 }
 
+void Instance::sendMidiMessage(const int offset, const unsigned char* data, const int size) const
+{
+    libpd_set_instance(static_cast<t_pdinstance*>(m_instance));
+    libpd_midiqueue_add(m_midi_queue, offset, 0, data, size);
+}
+
+void Instance::sendSysExMessage(const unsigned char* data, const int size) const
+{
+    libpd_set_instance(static_cast<t_pdinstance*>(m_instance));
+    libpd_midiqueue_sysex(m_midi_queue, 0, data, size);
+}
+
 void Instance::sendBang(const char* receiver) const
 {
     if (!m_instance) return;
@@ -431,41 +470,46 @@ void Instance::enqueueDirectMessages(void* object, const float msg)
 
 void Instance::waitForStateUpdate()
 {
-    // No action needed
-    if (m_function_queue.size_approx() == 0)
-    {
-        return;
-    }
+    // Wait for an empty function at the end of the queue, so any actions we performed are definitely finished
+    // An empty queue isn't enough: the audio thread may have dequeued a function that is still running
+    enqueueFunctionAndWait([]() {});
+}
 
-    //if (audioStarted) {
-        // Append signal to resume thread at the end of the queue
-        // This will make sure that any actions we performed are definitely finished now
-        // If it can aquire a lock, it will dequeue all action immediately
-        enqueueFunction([this]() { updateWait.signal(); });
+void Instance::enqueueFunctionAndWait(const std::function<void(void)>& fn)
+{
+    // Every call waits on its own event, which only the end of its own function signals
+    auto done = std::make_shared<WaitableEvent>();
+    enqueueFunction([fn, done]() {
+        fn();
+        done->signal();
+    });
 
-        updateWait.wait();
-    //}
-    // Should ensure that patches are loaded correctly when audio hasn't started yet
-    /*
-    else
+    // The audio thread dequeues it at the start of its next pd tick, however long its blocks take
+    // Once the host has stopped processing, or when messageEnqueued() couldn't take the processing flag, we dequeue it from here
+    while (!done->wait(stateUpdateTimeout))
     {
-        std::function<void(void)> callback;
-        while (m_function_queue.try_dequeue(callback))
+        if (isDequeuedByAudioThread()) continue;
+
+        if (tryLockProcessing())
         {
-            callback();
+            sendMessagesFromQueue();
+            unlockProcessing();
         }
-    } */
+    }
 }
 
-void Instance::sendMessagesFromQueue()
+bool Instance::sendMessagesFromQueue()
 {
     // libpd_set_instance(static_cast<t_pdinstance*>(m_instance));
 
+    bool sent = false;
     std::function<void(void)> callback;
     while (m_function_queue.try_dequeue(callback))
     {
         callback();
+        sent = true;
     }
+    return sent;
 }
 
 Patch Instance::openPatch(const File& toOpen)
@@ -504,6 +548,11 @@ void Instance::setThis()
     libpd_set_instance(static_cast<t_pdinstance*>(m_instance));
 }
 
+void Instance::setHeadless(bool headless)
+{
+    enqueueFunction([this, headless]() { set_gui_headless(static_cast<t_pdinstance*>(m_instance), headless); });
+}
+
 void Instance::createPanel(int type, const char* snd, const char* location)
 {
     setThis();
@@ -18,6 +18,7 @@ extern "C"
 }
 
 #include "PdAtom.h"
+#include "PdGuiMirror.h"
 #include "PdPatch.h"
 #include "concurrentqueue.h"
 
@@ -25,6 +26,13 @@ namespace pd
 {
 class Patch;
 
+// Sample type of pd's DSP, double when pd is built with PD_FLOATSIZE=64
+#if PD_FLOATSIZE == 64
+using Sample = double;
+#else
+using Sample = float;
+#endif
+
 class Instance
 {
     struct Message
@@ -67,9 +75,17 @@ class Instance
     void prepareDSP(const int nins, const int nouts, const double samplerate);
     void startDSP();
     void releaseDSP();
-    void performDSP(float const* inputs, float* outputs);
+    // Takes one pointer per adc~ and dac~ channel, see libpd_process_channels
+    void performDSP(Sample const* const* inputs, Sample* const* outputs);
+
+    // Moves pd's clock forward by one tick without running the dsp chain
+    // Returns false if a clock is due inside the tick, then performDSP has to be called instead
+    bool performIdle();
     int getBlockSize() const noexcept;
 
+    // Offset in samples of pd's current logical time inside the tick that is being processed
+    int getSampleOffset() const;
+
     void sendNoteOn(const int channel, const int pitch, const int velocity) const;
     void sendControlChange(const int channel, const int controller, const int value) const;
     void sendProgramChange(const int channel, const int value) const;
@@ -80,6 +96,10 @@ class Instance
     void sendSysRealTime(const int port, const int byte) const;
     void sendMidiByte(const int port, const int byte) const;
 
+    // Delivers a channel or realtime message at a sample offset inside the next tick
+    void sendMidiMessage(const int offset, const unsigned char* data, const int size) const;
+    void sendSysExMessage(const unsigned char* data, const int size) const;
+
     virtual void receiveNoteOn(const int channel, const int pitch, const int velocity)
     {
     }
@@ -136,6 +156,10 @@ class Instance
     virtual void titleChanged(){};
 
     void enqueueFunction(const std::function<void(void)>& fn);
+
+    // Runs fn on pd's thread and only returns once it has finished, so fn may write into the caller's locals
+    void enqueueFunctionAndWait(const std::function<void(void)>& fn);
+
     void enqueueMessages(const std::string& dest, const std::string& msg, std::vector<Atom>&& list);
 
     void enqueueDirectMessages(void* object, std::vector<Atom> const& list);
@@ -147,7 +171,14 @@ class Instance
 
     virtual void messageEnqueued(){};
 
-    void sendMessagesFromQueue();
+    // If the audio thread dequeues our messages, only when it doesn't may another thread do it
+    virtual bool isDequeuedByAudioThread()
+    {
+        return audioStarted;
+    }
+
+    // Returns true if any messages were sent
+    bool sendMessagesFromQueue();
     void processMessage(Message mess);
     void processPrint(std::string message);
     void processMidiEvent(midievent event);
@@ -162,6 +193,9 @@ class Instance
 
     void setThis();
     Array getArray(std::string const& name);
+
+    // Tells pd's GUI objects if anything shows this instance, so they can skip their redraw work when nothing does
+    void setHeadless(bool headless);
     
 
     bool checkState(String pdstate);
@@ -170,6 +204,19 @@ class Instance
 
     void waitForStateUpdate();
 
+    // Only one thread processes pd at a time: the audio thread for every block, or the thread that
+    // queued a message while the host has stopped processing or renders offline
+    bool tryLockProcessing()
+    {
+        bool expected = false;
+        return processing.compare_exchange_strong(expected, true, std::memory_order_acquire);
+    }
+
+    void unlockProcessing()
+    {
+        processing.store(false, std::memory_order_release);
+    }
+
     virtual const CriticalSection* getCallbackLock()
     {
         return nullptr;
@@ -181,11 +228,22 @@ class Instance
     void* m_message_receiver = nullptr;
     void* m_midi_receiver = nullptr;
     void* m_print_receiver = nullptr;
+    void* m_midi_queue = nullptr;
 
 
     std::atomic<bool> canUndo = false;
     std::atomic<bool> canRedo = false;
 
+    // Set while the audio thread is dequeuing our messages
+    // When set, only the audio thread is allowed to touch pd's state
+    std::atomic<bool> audioStarted = false;
+
+    // Logical time at the start of the current tick, only used on pd's thread
+    double tickStartTime = 0.0;
+
+    // Lock-free copy of GUI values, published by the audio thread
+    GuiMirror guiMirror;
+
     inline static const String defaultPatch = "#N canvas 827 239 527 327 12;";
 
     std::vector<std::pair<String, int>> consoleMessages;
@@ -197,7 +255,9 @@ class Instance
     std::unique_ptr<FileChooser> saveChooser;
     std::unique_ptr<FileChooser> openChooser;
 
-    WaitableEvent updateWait;
+    std::atomic<bool> processing = false;
+
+    static inline constexpr int stateUpdateTimeout = 100;
 
     struct internal;
 };
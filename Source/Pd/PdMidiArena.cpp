@@ -0,0 +1,216 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "PdMidiArena.h"
+
+#include <cstring>
+
+namespace pd
+{
+
+// Length of a message from its status byte, 0 for sysex
+static int getMessageSize(uint8 status)
+{
+    if (status < 0xf0)
+    {
+        auto const type = status & 0xf0;
+        return type == 0xc0 || type == 0xd0 ? 2 : 3;
+    }
+
+    switch (status)
+    {
+        case 0xf0:
+            return 0;
+        case 0xf1:
+        case 0xf3:
+            return 2;
+        case 0xf2:
+            return 3;
+        default:
+            return 1;
+    }
+}
+
+void MidiArena::setTickPosition(int position) noexcept
+{
+    tickPosition = position;
+}
+
+bool MidiArena::reserveEvent() noexcept
+{
+    if (numEvents == maxEvents)
+    {
+        numDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
+
+void MidiArena::addMessage(int offset, uint8 const* data, int size) noexcept
+{
+    if (size <= 0) return;
+
+    if (size <= 3)
+    {
+        if (!reserveEvent()) return;
+
+        auto& event = events[numEvents++];
+        event = {tickPosition + offset, size, -1, {0}};
+        std::memcpy(event.data.data(), data, size);
+    }
+    else
+    {
+        if (numBytes + size > maxBytes)
+        {
+            numDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (!reserveEvent()) return;
+
+        std::memcpy(bytes.data() + numBytes, data, size);
+        events[numEvents++] = {tickPosition + offset, size, numBytes, {0}};
+        numBytes += size;
+    }
+}
+
+void MidiArena::addByte(int offset, uint8 byte) noexcept
+{
+    // Realtime messages can appear anywhere, even inside sysex
+    if (byte >= 0xf8)
+    {
+        addMessage(offset, &byte, 1);
+        return;
+    }
+
+    if (sysexStart >= 0)
+    {
+        // A full arena drops the whole sysex, instead of sending a truncated one
+        if (numBytes == maxBytes)
+        {
+            numDropped.fetch_add(1, std::memory_order_relaxed);
+            numBytes = sysexStart;
+            sysexStart = -1;
+            return;
+        }
+
+        bytes[numBytes++] = byte;
+
+        if (byte == 0xf7)
+        {
+            auto const start = sysexStart;
+            sysexStart = -1;
+
+            if (!reserveEvent())
+            {
+                numBytes = start;
+                return;
+            }
+
+            events[numEvents++] = {tickPosition + offset, numBytes - start, start, {0}};
+        }
+        return;
+    }
+
+    if (byte & 0x80)
+    {
+        messageSize = getMessageSize(byte);
+        messageIndex = 0;
+
+        if (messageSize == 0)
+        {
+            if (numBytes < maxBytes)
+            {
+                sysexStart = numBytes;
+                bytes[numBytes++] = byte;
+            }
+            else
+            {
+                numDropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            return;
+        }
+    }
+    // Data byte without a status
+    else if (messageSize == 0)
+    {
+        return;
+    }
+    // Running status
+    else if (messageIndex == messageSize)
+    {
+        messageIndex = 1;
+    }
+
+    message[messageIndex++] = byte;
+
+    if (messageIndex == messageSize)
+    {
+        addMessage(offset, message.data(), messageSize);
+
+        // Only channel messages can use running status
+        if (message[0] >= 0xf0) messageSize = 0;
+    }
+}
+
+void MidiArena::drain(MidiBuffer& buffer, int numSamples) noexcept
+{
+    int numKept = 0;
+    int numKeptBytes = 0;
+
+    for (int i = 0; i < numEvents; i++)
+    {
+        auto event = events[i];
+        auto const* data = event.start < 0 ? event.data.data() : bytes.data() + event.start;
+
+        if (event.position < numSamples)
+        {
+            buffer.addEvent(data, event.size, std::max(event.position, 0));
+            continue;
+        }
+
+        // Keep it for the next block, slabs only move towards the front
+        if (event.start >= 0)
+        {
+            std::memmove(bytes.data() + numKeptBytes, data, event.size);
+            event.start = numKeptBytes;
+            numKeptBytes += event.size;
+        }
+
+        event.position -= numSamples;
+        events[numKept++] = event;
+    }
+
+    // Sysex that is still being received stays at the end of the arena
+    if (sysexStart >= 0)
+    {
+        auto const size = numBytes - sysexStart;
+        std::memmove(bytes.data() + numKeptBytes, bytes.data() + sysexStart, size);
+        sysexStart = numKeptBytes;
+        numKeptBytes += size;
+    }
+
+    numEvents = numKept;
+    numBytes = numKeptBytes;
+    tickPosition -= numSamples;
+}
+
+void MidiArena::clear() noexcept
+{
+    numEvents = 0;
+    numBytes = 0;
+    tickPosition = 0;
+    messageIndex = 0;
+    messageSize = 0;
+    sysexStart = -1;
+}
+
+uint32 MidiArena::getAndResetDropped() noexcept
+{
+    return numDropped.exchange(0);
+}
+
+}  // namespace pd
@@ -0,0 +1,77 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <array>
+#include <atomic>
+
+namespace pd
+{
+
+//! @brief Preallocated storage for the MIDI that pd sends out during a block.
+//! @details Written on pd's thread while it processes, drained into the host's MidiBuffer once per block.\n
+//! Short messages are stored in the event itself, sysex of any length gets a slab of the byte arena.\n
+//! Nothing is allocated after construction: events that don't fit are dropped and counted.
+class MidiArena
+{
+   public:
+    static inline constexpr int maxEvents = 4096;
+    static inline constexpr int maxBytes = 65536;
+
+    MidiArena() = default;
+
+    //! @brief Sets the position in the host block where the output of the coming tick starts.
+    void setTickPosition(int position) noexcept;
+
+    //! @brief Adds a complete message at an offset inside the current tick.
+    void addMessage(int offset, uint8 const* data, int size) noexcept;
+
+    //! @brief Adds a single byte of a raw MIDI stream, as sent by [midiout].
+    //! @details Channel messages are assembled from their status byte, realtime bytes pass through
+    //! immediately and sysex is collected in place until its closing 0xf7.
+    void addByte(int offset, uint8 byte) noexcept;
+
+    //! @brief Moves the events of the first numSamples samples into buffer.
+    //! @details Later events are kept and moved to the start of the next block.
+    void drain(MidiBuffer& buffer, int numSamples) noexcept;
+
+    void clear() noexcept;
+
+    //! @brief Returns the number of events dropped since the last call, safe to call from any thread.
+    uint32 getAndResetDropped() noexcept;
+
+   private:
+    struct Event
+    {
+        int position;
+        int size;
+        // Offset of the sysex slab, or -1 if the message is stored in data
+        int start;
+        std::array<uint8, 3> data;
+    };
+
+    bool reserveEvent() noexcept;
+
+    std::array<Event, maxEvents> events;
+    std::array<uint8, maxBytes> bytes;
+    int numEvents = 0;
+    int numBytes = 0;
+    int tickPosition = 0;
+
+    // Raw byte stream state
+    std::array<uint8, 3> message = {0};
+    int messageIndex = 0;
+    int messageSize = 0;
+    int sysexStart = -1;
+
+    std::atomic<uint32> numDropped = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(MidiArena)
+};
+
+}  // namespace pd
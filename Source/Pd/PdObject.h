@@ -46,6 +46,7 @@ enum class Type : size_t
     Mouse,
     Keyboard,
     Picture,
+    Scope,
     Invalid
 };
 
@@ -60,17 +60,39 @@ extern "C"
 namespace pd
 {
 
+// Makes the canvas current in pd, only call this from pd's thread
+static void setCurrentCanvas(Instance* instance, t_canvas* cnv)
+{
+    instance->setThis(); // important for canvas_getcurrent
+
+    if (auto* current = canvas_getcurrent())
+    {
+        canvas_unsetcurrent(current);
+    }
+
+    canvas_setcurrent(cnv);
+    canvas_vis(cnv, 1.);
+    canvas_map(cnv, 1.);
+
+    t_atom argv[1];
+    SETFLOAT(argv, 1);
+    pd_typedmess(reinterpret_cast<t_pd*>(cnv), gensym("pop"), 1, argv);
+}
+
 Patch::Patch(void* patchPtr, Instance* parentInstance, File patchFile)  : ptr(patchPtr), instance(parentInstance), currentFile(patchFile)
 {
     
     if (auto* cnv = getPointer())
     {
-        instance->getCallbackLock()->enter();
-
-        setCurrent();
-        setZoom(1);
-
-        instance->getCallbackLock()->exit();
+        // Let the audio thread apply this from the queue, so we don't need to hold the audio callback lock
+        // Only capture pointers here, since this object may be a temporary
+        instance->enqueueFunction([inst = instance, cnv]() mutable {
+            setCurrentCanvas(inst, cnv);
+            
+            t_atom arg;
+            SETFLOAT(&arg, 1);
+            pd_typedmess(reinterpret_cast<t_pd*>(cnv), gensym("zoom"), 1, &arg);
+        });
     }
 }
 
@@ -135,26 +157,15 @@ void Patch::setCurrent(bool lock)
     
     if (!ptr) return;
 
-    if (lock) instance->getCallbackLock()->enter();
-
-    auto* cnv = canvas_getcurrent();
-
-    if (cnv)
+    // When called from the message thread, push it onto the queue instead of locking the audio thread
+    // Everything that depends on the current canvas goes through the same queue, so the order is preserved
+    if (lock)
     {
-        canvas_unsetcurrent(cnv);
+        instance->enqueueFunction([inst = instance, cnv = getPointer()]() mutable { setCurrentCanvas(inst, cnv); });
+        return;
     }
 
-    canvas_setcurrent(getPointer());
-    canvas_vis(getPointer(), 1.);
-    canvas_map(getPointer(), 1.);
-
-
-
-    t_atom argv[1];
-    SETFLOAT(argv, 1);
-    pd_typedmess((t_pd*)getPointer(), gensym("pop"), 1, argv);
-
-    if (lock) instance->getCallbackLock()->exit();
+    setCurrentCanvas(instance, getPointer());
 }
 
 int Patch::getIndex(void* obj)
@@ -413,6 +424,7 @@ std::unique_ptr<Object> Patch::renameObject(Object* obj, const String& name)
             [this, obj]()
             {
                 setCurrent();
+                instance->guiMirror.clear();
                 glist_noselect(getPointer());
                 glist_select(getPointer(), &checkObject(obj)->te_g);
                 canvas_stowconnections(getPointer());
@@ -428,6 +440,7 @@ std::unique_ptr<Object> Patch::renameObject(Object* obj, const String& name)
     }
 
     instance->enqueueFunction([this, obj, name]() mutable {
+        instance->guiMirror.clear();
         libpd_renameobj(getPointer(), &checkObject(obj)->te_g, name.toRawUTF8(), name.getNumBytesAsUTF8());
         
     });
@@ -509,6 +522,7 @@ void Patch::removeObject(Object* obj)
         [this, obj]()
         {
             setCurrent();
+            instance->guiMirror.clear();
             libpd_removeobj(getPointer(), &checkObject(obj)->te_g);
         });
 }
@@ -592,6 +606,7 @@ void Patch::finishRemove()
         [this]() mutable
         {
             setCurrent();
+            instance->guiMirror.clear();
             libpd_finishremove(getPointer());
         });
 }
@@ -602,6 +617,7 @@ void Patch::removeSelection()
         [this]() mutable
         {
             setCurrent();
+            instance->guiMirror.clear();
 
             libpd_removeselection(getPointer());
         });
@@ -616,6 +632,8 @@ void Patch::undo()
             glist_noselect(getPointer());
             EDITOR->canvas_undo_already_set_move = 0;
 
+            // Undo may delete objects, so stop reading their values
+            instance->guiMirror.clear();
             libpd_undo(getPointer());
             
             setCurrent();
@@ -631,6 +649,7 @@ void Patch::redo()
             glist_noselect(getPointer());
             EDITOR->canvas_undo_already_set_move = 0;
 
+            instance->guiMirror.clear();
             libpd_redo(getPointer());
 
             setCurrent();
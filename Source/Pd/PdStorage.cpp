@@ -27,70 +27,67 @@ namespace pd
 {
 
 Storage::Storage(t_glist* patch, Instance* inst) : parentPatch(patch), instance(inst) {
-    instance->getCallbackLock()->enter();
     
-    for (t_gobj* y = patch->gl_list; y; y = y->g_next)
-    {
-        const std::string name = libpd_get_object_class_name(y);
-        
-        if(name == "graph" || name == "canvas") {
-            auto* glist = pd_checkglist(&y->g_pd);
-            auto* obj = glist->gl_list;
+    // Scanning and creating objects changes pd's state, so this is done from the audio thread's queue
+    instance->enqueueFunctionAndWait([this, patch]() {
+        for (t_gobj* y = patch->gl_list; y; y = y->g_next)
+        {
+            const std::string name = libpd_get_object_class_name(y);
             
-            if(obj != nullptr && obj->g_next == nullptr) {
-                
-                // Skip non-text object to prevent crash on libpd_get_object_text
-                if(pd_class(&glist->gl_list->g_pd) != text_class) continue;
-                
-                // Get object text to return the content of the comment
-                char* text;
-                int size;
+            if(name == "graph" || name == "canvas") {
+                auto* glist = pd_checkglist(&y->g_pd);
+                auto* obj = glist->gl_list;
                 
-                libpd_get_object_text(glist->gl_list, &text, &size);
-                
-                String name = String(CharPointer_UTF8(text), size);
-                freebytes(static_cast<void*>(text), static_cast<size_t>(size) * sizeof(char));
-                
-                // Found an existing storage object!
-                if(name.startsWith("plugdatainfo")) {
-                    infoObject = glist->gl_list;
-                    infoParent = glist;
-                    instance->getCallbackLock()->exit();
-                    loadInfoFromPatch(); // load info from existsing object
-                    return;
+                if(obj != nullptr && obj->g_next == nullptr) {
+                    
+                    // Skip non-text object to prevent crash on libpd_get_object_text
+                    if(pd_class(&glist->gl_list->g_pd) != text_class) continue;
+                    
+                    // Get object text to return the content of the comment
+                    char* text;
+                    int size;
+                    
+                    libpd_get_object_text(glist->gl_list, &text, &size);
+                    
+                    String name = String(CharPointer_UTF8(text), size);
+                    freebytes(static_cast<void*>(text), static_cast<size_t>(size) * sizeof(char));
+                    
+                    // Found an existing storage object!
+                    if(name.startsWith("plugdatainfo")) {
+                        infoObject = glist->gl_list;
+                        infoParent = glist;
+                        loadInfoFromPatch(); // load info from existsing object
+                        return;
+                    }
                 }
-            }
-        };
-    }
-    
-    // If we're here, no object was found, so we create a new one
-    
-    // Ensures no undoable action is created, so there's no way to accidentally delete this object
-    canvas_undo_get(glist_getcanvas(parentPatch))->u_doing = 1;
-    
-    infoParent = pd_checkglist(libpd_creategraphonparent(patch, 0, 0));
-    
-    canvas_undo_get(glist_getcanvas(parentPatch))->u_doing = 0;
-    
-    // Makes it nearly invisible in pd-vanilla, in PlugData it's hidden
-    infoParent->gl_pixwidth = 1;
-    infoParent->gl_pixheight = 1;
-    
-    // Create storage object
-    int argc = 3;
-    auto argv = std::vector<t_atom>(argc);
-    SETFLOAT(argv.data(), 0);
-    SETSYMBOL(argv.data() + 1, 0);
-    SETSYMBOL(argv.data() + 2, gensym("plugdatainfo"));
-    
-
-    infoObject = &pd_checkobject(libpd_createobj(infoParent, gensym("text"), argc, argv.data()))->te_g;
-
-    instance->getCallbackLock()->exit();
-    
+            };
+        }
+        
+        // If we're here, no object was found, so we create a new one
+        
+        // Ensures no undoable action is created, so there's no way to accidentally delete this object
+        canvas_undo_get(glist_getcanvas(parentPatch))->u_doing = 1;
+        
+        infoParent = pd_checkglist(libpd_creategraphonparent(patch, 0, 0));
+        
+        canvas_undo_get(glist_getcanvas(parentPatch))->u_doing = 0;
+        
+        // Makes it nearly invisible in pd-vanilla, in PlugData it's hidden
+        infoParent->gl_pixwidth = 1;
+        infoParent->gl_pixheight = 1;
+        
+        // Create storage object
+        int argc = 3;
+        auto argv = std::vector<t_atom>(argc);
+        SETFLOAT(argv.data(), 0);
+        SETSYMBOL(argv.data() + 1, 0);
+        SETSYMBOL(argv.data() + 2, gensym("plugdatainfo"));
+        
+        infoObject = &pd_checkobject(libpd_createobj(infoParent, gensym("text"), argc, argv.data()))->te_g;
+    });
 }
 
-// Function to load state tree from existing patch, only called on init
+// Function to load state tree from existing patch, only called on init from pd's thread
 void Storage::loadInfoFromPatch()
 {
     if (!infoObject) return;
@@ -222,34 +219,35 @@ void Storage::setInfo(const String& id, const String& property, const String& in
 // Checks if we're at a storage undo event, and applies undo if needed
 void Storage::undoIfNeeded()
 {
-    instance->getCallbackLock()->enter();
+    bool isStorageEvent = false;
     
-    t_undo* udo = canvas_undo_get(parentPatch);
+    // Only read pd's undo queue from the audio thread, then apply our own undo here
+    instance->enqueueFunctionAndWait([this, &isStorageEvent]() {
+        t_undo* udo = canvas_undo_get(parentPatch);
+        isStorageEvent = udo && udo->u_last && !strcmp(udo->u_last->name, "plugdata_undo");
+    });
     
-    if(udo && udo->u_last && !strcmp(udo->u_last->name, "plugdata_undo")) {
+    if(isStorageEvent) {
         undoManager.undo();
     }
     
-    instance->getCallbackLock()->exit();
-    
     storeInfo();
-    
-
 }
 
 // Checks if we're at a storage redo event, and applies redo if needed
 void Storage::redoIfNeeded()
 {
-    instance->getCallbackLock()->enter();
+    bool isStorageEvent = false;
     
-    t_undo* udo = canvas_undo_get(parentPatch);
+    instance->enqueueFunctionAndWait([this, &isStorageEvent]() {
+        t_undo* udo = canvas_undo_get(parentPatch);
+        isStorageEvent = udo && udo->u_last && udo->u_last->next && !strcmp(udo->u_last->next->name, "plugdata_undo");
+    });
     
-    if(udo && udo->u_last && !strcmp(udo->u_last->next->name, "plugdata_undo")) {
+    if(isStorageEvent) {
         undoManager.redo();
     }
     
-    instance->getCallbackLock()->exit();
-    
     storeInfo();
 }
 
@@ -261,11 +259,11 @@ void Storage::createUndoAction()
     
     undoManager.beginNewTransaction();
     
-    instance->getCallbackLock()->enter();
     // Create dummy undoable action that we can detect by name when calling undo
-    canvas_undo_add(parentPatch, UNDO_MOTION, "plugdata_undo", canvas_undo_set_move(parentPatch, 1));
-    
-    instance->getCallbackLock()->exit();
+    // No need to wait for this, anything that reads pd's undo queue goes through the same queue
+    instance->enqueueFunction([patch = parentPatch]() {
+        canvas_undo_add(patch, UNDO_MOTION, "plugdata_undo", canvas_undo_set_move(patch, 1));
+    });
 }
 
 
@@ -211,6 +211,8 @@ PlugDataPluginEditor::~PlugDataPluginEditor()
     removeKeyListener(&statusbar);
     pd.locked.removeListener(this);
     pd.zoomScale.removeListener(this);
+    
+    pd.setHeadless(true);
 }
 
 void PlugDataPluginEditor::showNewObjectMenu()
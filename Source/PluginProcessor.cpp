@@ -62,7 +62,6 @@ parameters(*this, nullptr)
     
     // Set up midi buffers
     midiBufferIn.ensureSize(2048);
-    midiBufferOut.ensureSize(2048);
     midiBufferTemp.ensureSize(2048);
     midiBufferCopy.ensureSize(2048);
 
@@ -89,6 +88,13 @@ parameters(*this, nullptr)
     }
     
     logMessage("PlugData v" + String(ProjectInfo::versionString));
+
+    // Nothing shows pd's GUI until an editor gets created
+    setHeadless(true);
+
+#if PLUGDATA_REALTIME_CHECK
+    realtimeChecker = std::make_unique<RealtimeChecker>([this](const String& message) { logError(message); }, appDir.getChildFile("RealtimeViolations.txt"));
+#endif
 }
 
 PlugDataAudioProcessor::~PlugDataAudioProcessor()
@@ -223,36 +229,70 @@ void PlugDataAudioProcessor::changeProgramName(int index, const String& newName)
 
 void PlugDataAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    prepareDSP(getTotalNumInputChannels(), getTotalNumOutputChannels(), sampleRate);
+    // pd runs at the oversampled rate
+    const int factor = 1 << oversampling;
+    
+    // Every channel of the enabled buses becomes an adc~ or dac~ channel, in bus order
+    auto buildChannelMap = [this](bool isInput, std::vector<int>& channelMap)
+    {
+        channelMap.clear();
+        for (int bus = 0; bus < getBusCount(isInput); bus++)
+        {
+            for (int ch = 0; ch < getChannelCountOfBus(isInput, bus); ch++)
+            {
+                channelMap.push_back(getChannelIndexInProcessBlockBuffer(isInput, bus, ch));
+            }
+        }
+    };
+    
+    buildChannelMap(true, inputChannelMap);
+    buildChannelMap(false, outputChannelMap);
+    inputChannels.assign(inputChannelMap.size(), nullptr);
+    outputChannels.assign(outputChannelMap.size(), nullptr);
+    
+    prepareDSP(static_cast<int>(inputChannelMap.size()), static_cast<int>(outputChannelMap.size()), sampleRate * factor);
     // sendCurrentBusesLayoutInformation();
     audioAdvancement = 0;
     const auto blksize = static_cast<size_t>(Instance::getBlockSize());
-    const auto numIn = std::max(static_cast<size_t>(getTotalNumInputChannels()), static_cast<size_t>(2));
-    const auto nouts = std::max(static_cast<size_t>(getTotalNumOutputChannels()), static_cast<size_t>(2));
-    audioBufferIn.resize(numIn * blksize);
-    audioBufferOut.resize(nouts * blksize);
-    std::fill(audioBufferOut.begin(), audioBufferOut.end(), 0.f);
-    std::fill(audioBufferIn.begin(), audioBufferIn.end(), 0.f);
+    audioBufferIn.assign(inputChannelMap.size() * blksize, 0.f);
+    audioBufferOut.assign(outputChannelMap.size() * blksize, 0.f);
+    
+    if (oversampling > 0)
+    {
+        auto const numChannels = std::max({getTotalNumInputChannels(), getTotalNumOutputChannels(), 1});
+        oversampler = std::make_unique<dsp::Oversampling<pd::Sample>>(numChannels, oversampling, dsp::Oversampling<pd::Sample>::filterHalfBandPolyphaseIIR, true);
+        oversampler->initProcessing(samplesPerBlock);
+        oversampledBuffer.setSize(numChannels, samplesPerBlock * factor);
+        midiBufferOversampled.ensureSize(2048);
+    }
+    else
+    {
+        oversampler.reset();
+        oversampledBuffer.setSize(0, 0);
+    }
+    
+    // If the host block is a multiple of pd's block, every tick can be processed in place
+    // Plugin hosts may send shorter blocks at any time, so they are always staged and the latency stays the same during playback
+    directProcessing = wrapperType == wrapperType_Standalone && samplesPerBlock > 0 && (samplesPerBlock * factor) % static_cast<int>(blksize) == 0;
+    updateLatency();
     midiBufferIn.clear();
-    midiBufferOut.clear();
     midiBufferTemp.clear();
+    midiArena.clear();
+    silentSamples = 0;
     
-    midiByteIndex = 0;
-    midiByteBuffer[0] = 0;
-    midiByteBuffer[1] = 0;
-    midiByteBuffer[2] = 0;
     startDSP();
     processingBuffer.setSize(2, samplesPerBlock);
+    conversionBuffer.setSize(std::max(getTotalNumInputChannels(), getTotalNumOutputChannels()), samplesPerBlock);
     
     statusbarSource.prepareToPlay(getTotalNumOutputChannels());
     
-    //audioStarted = true;
+    audioStarted = true;
 }
 
 void PlugDataAudioProcessor::releaseResources()
 {
+    audioStarted = false;
     releaseDSP();
-    //audioStarted = false;
 }
 
 //#ifndef JucePlugin_PreferredChannelConfigurations
@@ -263,35 +303,24 @@ bool PlugDataAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts)
     return true;
 #endif
     
+    // Any layout works, every channel of the enabled buses is mapped to adc~ and dac~
     int ninch = 0;
     int noutch = 0;
     for (int bus = 0; bus < layouts.outputBuses.size(); bus++)
     {
-        int nchb = layouts.getNumChannels(false, bus);
-        
         if(layouts.outputBuses[bus].isDisabled()) continue;
         
-        if (nchb > 2)
-            return false;
-        if (nchb == 0)
-            return false;
-        noutch += nchb;
+        noutch += layouts.getNumChannels(false, bus);
     }
     
     for (int bus = 0; bus < layouts.inputBuses.size(); bus++)
     {
-        int nchb = layouts.getNumChannels(true, bus);
-        
         if(layouts.inputBuses[bus].isDisabled()) continue;
         
-        if (nchb > 2)
-            return false;
-        if (nchb == 0)
-            return false;
-        ninch += nchb;
+        ninch += layouts.getNumChannels(true, bus);
     }
     
-    if (ninch > 32 || noutch > 32)
+    if (ninch > maxNumChannels || noutch > maxNumChannels)
         return false;
     
     return true;
@@ -310,6 +339,37 @@ void PlugDataAudioProcessor::processBlockBypassed(AudioSampleBuffer& buffer, Mid
 
 void PlugDataAudioProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
 {
+#if PD_FLOATSIZE == 64
+    conversionBuffer.makeCopyOf(buffer, true);
+    processBlockInternal(conversionBuffer, midiMessages);
+    buffer.makeCopyOf(conversionBuffer, true);
+#else
+    processBlockInternal(buffer, midiMessages);
+#endif
+}
+
+void PlugDataAudioProcessor::processBlock(AudioBuffer<double>& buffer, MidiBuffer& midiMessages)
+{
+#if PD_FLOATSIZE == 64
+    processBlockInternal(buffer, midiMessages);
+#else
+    // Hosts only use double precision when we say we support it
+    jassertfalse;
+#endif
+}
+
+bool PlugDataAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return std::is_same<pd::Sample, double>::value;
+}
+
+template <typename SampleType>
+void PlugDataAudioProcessor::processBlockInternal(AudioBuffer<SampleType>& buffer, MidiBuffer& midiMessages)
+{
+#if PLUGDATA_REALTIME_CHECK
+    RealtimeChecker::ScopedRealtimeSection realtimeSection;
+#endif
+
     ScopedNoDenormals noDenormals;
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -319,6 +379,18 @@ void PlugDataAudioProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer
         buffer.clear(i, 0, buffer.getNumSamples());
     }
     
+    // Another thread only holds this while the host is stopped or renders offline
+    // Offline, a block may take as long as it needs, so wait for it instead of skipping pd
+    while (!tryLockProcessing())
+    {
+        if (!isNonRealtime())
+        {
+            buffer.clear();
+            return;
+        }
+        
+        Thread::yield();
+    }
     
     for (int n = 0; n < numParameters; n++)
     {
@@ -330,41 +402,148 @@ void PlugDataAudioProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer
             
             String toSend = ("param" + String(n + 1));
             sendList(toSend.toRawUTF8(), parameterAtom);
+            parametersChanged = true;
         }
     }
     
     midiBufferCopy.clear();
     midiBufferCopy.addEvents(midiMessages, 0, buffer.getNumSamples(), audioAdvancement);
     
-    process(buffer, midiMessages);
-    
+    if (oversampler)
+    {
+        processOversampled(buffer, midiMessages);
+    }
+    else
+    {
+        process(buffer, midiMessages);
+    }
     
+    unlockProcessing();
     
     buffer.applyGain(getParameters()[0]->getValue());
     
     statusbarSource.processBlock(buffer, midiBufferCopy, midiMessages, totalNumOutputChannels);
 }
 
-void PlugDataAudioProcessor::process(AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
+void PlugDataAudioProcessor::processOversampled(AudioBuffer<pd::Sample>& buffer, MidiBuffer& midiMessages)
+{
+    const int factor = 1 << oversampling;
+    
+    dsp::AudioBlock<pd::Sample> block(buffer);
+    auto oversampledBlock = oversampler->processSamplesUp(block);
+    
+    // Copied into a buffer that was sized in prepareToPlay, an AudioBuffer referring to the oversampler's
+    // memory would allocate its channel list on the audio thread once there are more than 32 channels
+    oversampledBuffer.setSize(oversampledBuffer.getNumChannels(), static_cast<int>(oversampledBlock.getNumSamples()), false, false, true);
+    oversampledBlock.copyTo(oversampledBuffer);
+    
+    midiBufferOversampled.clear();
+    for (const auto event : midiMessages)
+    {
+        midiBufferOversampled.addEvent(event.data, event.numBytes, event.samplePosition * factor);
+    }
+    
+    process(oversampledBuffer, midiBufferOversampled);
+    oversampledBlock.copyFrom(oversampledBuffer);
+    
+    midiMessages.clear();
+    for (const auto event : midiBufferOversampled)
+    {
+        midiMessages.addEvent(event.data, event.numBytes, event.samplePosition / factor);
+    }
+    
+    oversampler->processSamplesDown(block);
+}
+
+void PlugDataAudioProcessor::processDirect(AudioBuffer<pd::Sample>& buffer, MidiBuffer& midiMessages, int numSamples)
 {
-    ScopedNoDenormals noDenormals;
     const int blockSize = Instance::getBlockSize();
-    const int numSamples = buffer.getNumSamples();
-    const int adv = audioAdvancement >= 64 ? 0 : audioAdvancement;
-    const int numLeft = blockSize - adv;
-    const int numIn = getTotalNumInputChannels();
-    const int numOut = getTotalNumOutputChannels();
-    const float** bufferIn = buffer.getArrayOfReadPointers();
-    float** bufferOut = buffer.getArrayOfWritePointers();
+    const pd::Sample** bufferIn = buffer.getArrayOfReadPointers();
+    pd::Sample** bufferOut = buffer.getArrayOfWritePointers();
     const bool midiConsume = acceptsMidi();
     const bool midiProduce = producesMidi();
     
-    auto const maxOuts = std::max(numOut, buffer.getNumChannels());
-    for (int i = numIn; i < maxOuts; ++i)
+    MidiBuffer const& midiin = midiProduce ? midiBufferTemp : midiMessages;
+    if (midiProduce)
+    {
+        midiBufferTemp.swapWith(midiMessages);
+        midiMessages.clear();
+    }
+    
+    for (int pos = 0; pos < numSamples; pos += blockSize)
+    {
+        // pd reads from and writes to the host's buffer
+        for (size_t j = 0; j < inputChannels.size(); ++j)
+        {
+            inputChannels[j] = bufferIn[inputChannelMap[j]] + pos;
+        }
+        for (size_t j = 0; j < outputChannels.size(); ++j)
+        {
+            outputChannels[j] = bufferOut[outputChannelMap[j]] + pos;
+        }
+        if (midiConsume)
+        {
+            midiBufferIn.addEvents(midiin, pos, blockSize, -pos);
+        }
+        
+        midiArena.setTickPosition(pos);
+        processInternal();
+    }
+    
+    if (midiProduce)
+    {
+        midiArena.drain(midiMessages, numSamples);
+    }
+    else
+    {
+        midiArena.clear();
+    }
+}
+
+void PlugDataAudioProcessor::process(AudioBuffer<pd::Sample>& buffer, MidiBuffer& midiMessages)
+{
+    ScopedNoDenormals noDenormals;
+    const int blockSize = Instance::getBlockSize();
+    const int numSamples = buffer.getNumSamples();
+    const int numIn = static_cast<int>(inputChannelMap.size());
+    const int numOut = static_cast<int>(outputChannelMap.size());
+    
+    auto const maxOuts = std::max(getTotalNumOutputChannels(), buffer.getNumChannels());
+    for (int i = getTotalNumInputChannels(); i < maxOuts; ++i)
     {
         buffer.clear(i, 0, numSamples);
     }
     
+    if (directProcessing)
+    {
+        // An audio device that sends a block that doesn't fit only gets its whole ticks, the rest stays silent
+        const int numTickSamples = numSamples - numSamples % blockSize;
+        processDirect(buffer, midiMessages, numTickSamples);
+        
+        for (int i = 0; i < numOut; ++i)
+        {
+            buffer.clear(outputChannelMap[i], numTickSamples, numSamples - numTickSamples);
+        }
+        return;
+    }
+    
+    // Ticks that straddle host blocks are staged
+    for (int j = 0; j < numIn; ++j)
+    {
+        inputChannels[j] = audioBufferIn.data() + j * blockSize;
+    }
+    for (int j = 0; j < numOut; ++j)
+    {
+        outputChannels[j] = audioBufferOut.data() + j * blockSize;
+    }
+    
+    const int adv = audioAdvancement >= blockSize ? 0 : audioAdvancement;
+    const int numLeft = blockSize - adv;
+    const pd::Sample** bufferIn = buffer.getArrayOfReadPointers();
+    pd::Sample** bufferOut = buffer.getArrayOfWritePointers();
+    const bool midiConsume = acceptsMidi();
+    const bool midiProduce = producesMidi();
+    
     // If the current number of samples in this block
     // is inferior to the number of samples required
     if (numSamples < numLeft)
@@ -374,12 +553,12 @@ void PlugDataAudioProcessor::process(AudioSampleBuffer& buffer, MidiBuffer& midi
         for (int j = 0; j < numIn; ++j)
         {
             const int index = j * blockSize + adv;
-            std::copy_n(bufferIn[j], numSamples, audioBufferIn.data() + index);
+            std::copy_n(bufferIn[inputChannelMap[j]], numSamples, audioBufferIn.data() + index);
         }
         for (int j = 0; j < numOut; ++j)
         {
             const int index = j * blockSize + adv;
-            std::copy_n(audioBufferOut.data() + index, numSamples, bufferOut[j]);
+            std::copy_n(audioBufferOut.data() + index, numSamples, bufferOut[outputChannelMap[j]]);
         }
         if (midiConsume)
         {
@@ -388,7 +567,11 @@ void PlugDataAudioProcessor::process(AudioSampleBuffer& buffer, MidiBuffer& midi
         if (midiProduce)
         {
             midiMessages.clear();
-            midiMessages.addEvents(midiBufferOut, adv, numSamples, -adv);
+            midiArena.drain(midiMessages, numSamples);
+        }
+        else
+        {
+            midiArena.clear();
         }
         audioAdvancement += numSamples;
     }
@@ -409,22 +592,20 @@ void PlugDataAudioProcessor::process(AudioSampleBuffer& buffer, MidiBuffer& midi
         for (int j = 0; j < numIn; ++j)
         {
             const int index = j * blockSize + adv;
-            std::copy_n(bufferIn[j], numLeft, audioBufferIn.data() + index);
+            std::copy_n(bufferIn[inputChannelMap[j]], numLeft, audioBufferIn.data() + index);
         }
         for (int j = 0; j < numOut; ++j)
         {
             const int index = j * blockSize + adv;
-            std::copy_n(audioBufferOut.data() + index, numLeft, bufferOut[j]);
+            std::copy_n(audioBufferOut.data() + index, numLeft, bufferOut[outputChannelMap[j]]);
         }
         if (midiConsume)
         {
             midiBufferIn.addEvents(midiin, 0, numLeft, adv);
         }
-        if (midiProduce)
-        {
-            midiMessages.addEvents(midiBufferOut, adv, numLeft, -adv);
-        }
+        // The output of a tick is sent out one tick later, midi goes with it
         audioAdvancement = 0;
+        midiArena.setTickPosition(numLeft);
         processInternal();
         
         // If there are other DSP ticks that can be
@@ -435,21 +616,18 @@ void PlugDataAudioProcessor::process(AudioSampleBuffer& buffer, MidiBuffer& midi
             for (int j = 0; j < numIn; ++j)
             {
                 const int index = j * blockSize;
-                std::copy_n(bufferIn[j] + pos, blockSize, audioBufferIn.data() + index);
+                std::copy_n(bufferIn[inputChannelMap[j]] + pos, blockSize, audioBufferIn.data() + index);
             }
             for (int j = 0; j < numOut; ++j)
             {
                 const int index = j * blockSize;
-                std::copy_n(audioBufferOut.data() + index, blockSize, bufferOut[j] + pos);
+                std::copy_n(audioBufferOut.data() + index, blockSize, bufferOut[outputChannelMap[j]] + pos);
             }
             if (midiConsume)
             {
-                midiBufferIn.addEvents(midiin, pos, blockSize, 0);
-            }
-            if (midiProduce)
-            {
-                midiMessages.addEvents(midiBufferOut, 0, blockSize, pos);
+                midiBufferIn.addEvents(midiin, pos, blockSize, -pos);
             }
+            midiArena.setTickPosition(pos + blockSize);
             processInternal();
             pos += blockSize;
         }
@@ -463,24 +641,98 @@ void PlugDataAudioProcessor::process(AudioSampleBuffer& buffer, MidiBuffer& midi
             for (int j = 0; j < numIn; ++j)
             {
                 const int index = j * blockSize;
-                std::copy_n(bufferIn[j] + pos, remaining, audioBufferIn.data() + index);
+                std::copy_n(bufferIn[inputChannelMap[j]] + pos, remaining, audioBufferIn.data() + index);
             }
             for (int j = 0; j < numOut; ++j)
             {
                 const int index = j * blockSize;
-                std::copy_n(audioBufferOut.data() + index, remaining, bufferOut[j] + pos);
+                std::copy_n(audioBufferOut.data() + index, remaining, bufferOut[outputChannelMap[j]] + pos);
             }
             if (midiConsume)
             {
-                midiBufferIn.addEvents(midiin, pos, remaining, 0);
-            }
-            if (midiProduce)
-            {
-                midiMessages.addEvents(midiBufferOut, 0, remaining, pos);
+                midiBufferIn.addEvents(midiin, pos, remaining, -pos);
             }
             audioAdvancement = remaining;
         }
+        
+        // Events past the end of this block stay in the arena
+        if (midiProduce)
+        {
+            midiArena.drain(midiMessages, numSamples);
+        }
+        else
+        {
+            midiArena.clear();
+        }
+    }
+}
+
+void PlugDataAudioProcessor::setPatchLatency(int latency)
+{
+    patchLatency = latency;
+    updateLatency();
+}
+
+int PlugDataAudioProcessor::getPatchLatency() const
+{
+    return patchLatency;
+}
+
+void PlugDataAudioProcessor::updateLatency()
+{
+    const int factor = 1 << oversampling;
+    
+    // pd's block is counted at the oversampled rate
+    int latency = patchLatency + (directProcessing ? 0 : (Instance::getBlockSize() + factor - 1) / factor);
+    
+    if (oversampler)
+    {
+        latency += roundToInt(static_cast<double>(oversampler->getLatencyInSamples()));
+    }
+    
+    setLatencySamples(latency);
+}
+
+void PlugDataAudioProcessor::setOversampling(int factor)
+{
+    factor = jlimit(0, 3, factor);
+    parameters.state.setProperty("Oversampling", factor, nullptr);
+    
+    if (factor == oversampling) return;
+    
+    // suspendProcessing waits for the block the host may be processing, and no new block starts until we resume
+    const bool wasSuspended = isSuspended();
+    suspendProcessing(true);
+    
+    oversampling = factor;
+    
+    // Prepare again for the new rate
+    if (audioStarted)
+    {
+        releaseResources();
+        prepareToPlay(getSampleRate(), AudioProcessor::getBlockSize());
     }
+    
+    suspendProcessing(wasSuspended);
+    
+    // The filters changed the latency
+    updateHostDisplay();
+}
+
+int PlugDataAudioProcessor::getOversampling() const
+{
+    return oversampling;
+}
+
+void PlugDataAudioProcessor::setIdleSkipping(bool shouldSkip)
+{
+    parameters.state.setProperty("IdleSkipping", shouldSkip, nullptr);
+    idleSkipping = shouldSkip;
+}
+
+bool PlugDataAudioProcessor::getIdleSkipping() const
+{
+    return idleSkipping;
 }
 
 void PlugDataAudioProcessor::sendPlayhead()
@@ -520,20 +772,26 @@ void PlugDataAudioProcessor::sendPlayhead()
     }
 }
 
+bool PlugDataAudioProcessor::isDequeuedByAudioThread()
+{
+    // Offline, the host may not call processBlock until this thread is done, so we can't wait for it
+    return audioStarted && !isSuspended() && !isNonRealtime();
+}
+
 void PlugDataAudioProcessor::messageEnqueued()
 {
-    if (isNonRealtime() || isSuspended())
+    // While audio is running, the audio thread is the only one that touches pd
+    // It will dequeue this message at the start of the next pd tick
+    if (isDequeuedByAudioThread())
     {
-        sendMessagesFromQueue();
+        return;
     }
-    else
+    
+    // During an offline render processBlock may be running right now, if it holds the flag it dequeues this itself
+    if (tryLockProcessing())
     {
-        const CriticalSection* cs = getCallbackLock();
-        if (cs->tryEnter())
-        {
-            sendMessagesFromQueue();
-            cs->exit();
-        }
+        sendMessagesFromQueue();
+        unlockProcessing();
     }
 }
 
@@ -541,55 +799,16 @@ void PlugDataAudioProcessor::sendMidiBuffer()
 {
     if (acceptsMidi())
     {
+        // Event positions are relative to the start of this tick
         for (const auto& event : midiBufferIn)
         {
-            auto const message = event.getMessage();
-            if (message.isNoteOn())
-            {
-                sendNoteOn(message.getChannel(), message.getNoteNumber(), message.getVelocity());
-            }
-            else if (message.isNoteOff())
-            {
-                sendNoteOn(message.getChannel(), message.getNoteNumber(), 0);
-            }
-            else if (message.isController())
-            {
-                sendControlChange(message.getChannel(), message.getControllerNumber(), message.getControllerValue());
-            }
-            else if (message.isPitchWheel())
-            {
-                sendPitchBend(message.getChannel(), message.getPitchWheelValue() - 8192);
-            }
-            else if (message.isChannelPressure())
+            if (event.data[0] == 0xf0)
             {
-                sendAfterTouch(message.getChannel(), message.getChannelPressureValue());
+                sendSysExMessage(event.data, event.numBytes);
             }
-            else if (message.isAftertouch())
+            else if (event.numBytes <= 3)
             {
-                sendPolyAfterTouch(message.getChannel(), message.getNoteNumber(), message.getAfterTouchValue());
-            }
-            else if (message.isProgramChange())
-            {
-                sendProgramChange(message.getChannel(), message.getProgramChangeNumber());
-            }
-            else if (message.isSysEx())
-            {
-                for (int i = 0; i < message.getSysExDataSize(); ++i)
-                {
-                    sendSysEx(0, static_cast<int>(message.getSysExData()[i]));
-                }
-            }
-            else if (message.isMidiClock() || message.isMidiStart() || message.isMidiStop() || message.isMidiContinue() || message.isActiveSense() || (message.getRawDataSize() == 1 && message.getRawData()[0] == 0xff))
-            {
-                for (int i = 0; i < message.getRawDataSize(); ++i)
-                {
-                    sendSysRealTime(0, static_cast<int>(message.getRawData()[i]));
-                }
-            }
-            
-            for (int i = 0; i < message.getRawDataSize(); i++)
-            {
-                sendMidiByte(0, static_cast<int>(message.getRawData()[i]));
+                sendMidiMessage(event.samplePosition, event.data, event.numBytes);
             }
         }
         midiBufferIn.clear();
@@ -601,37 +820,59 @@ void PlugDataAudioProcessor::processInternal()
     // setThis();
     
     // Dequeue messages
-    sendMessagesFromQueue();
+    bool active = sendMessagesFromQueue() || parametersChanged || !midiBufferIn.isEmpty();
+    parametersChanged = false;
+    
     sendPlayhead();
     sendMidiBuffer();
     
-    // Process audio
-    if (static_cast<bool>(enabled->load()))
+    const int blockSize = Instance::getBlockSize();
+    const bool isEnabled = static_cast<bool>(enabled->load());
+    
+    // Bypassed instances get silence as input
+    const pd::Sample* const* inputs = isEnabled ? inputChannels.data() : nullptr;
+    
+    active = active || (isEnabled && !isSilent(inputChannels.data(), static_cast<int>(inputChannels.size()), blockSize));
+    
+    if (active) silentSamples = 0;
+    
+    // When bypassed, or when the patch allows it, pd's dsp stops after the tail has rung out
+    bool idle = false;
+    if (!isEnabled || idleSkipping.load(std::memory_order_relaxed))
     {
-        std::copy_n(audioBufferOut.data() + (2 * 64), (minOut - 2) * 64, audioBufferIn.data() + (2 * 64));
+        const double sampleRate = getSampleRate() * (1 << oversampling);
+        const int tailSamples = std::max(blockSize, static_cast<int>(static_cast<float>(tailLength.getValue()) * sampleRate));
+        
+        idle = silentSamples >= tailSamples && performIdle();
         
-        performDSP(audioBufferIn.data(), audioBufferOut.data());
+        if (!idle)
+        {
+            performDSP(inputs, outputChannels.data());
+            silentSamples = isSilent(outputChannels.data(), static_cast<int>(outputChannels.size()), blockSize) ? std::min(silentSamples + blockSize, tailSamples) : 0;
+        }
     }
-    
     else
     {
-        std::fill(audioBufferIn.begin(), audioBufferIn.end(), 0.f);
-        
-        performDSP(audioBufferIn.data(), audioBufferOut.data());
-        
-        std::fill(audioBufferOut.begin(), audioBufferOut.end(), 0.f);
+        performDSP(inputs, outputChannels.data());
     }
     
-    // Midi out
+    if (idle || !isEnabled)
+    {
+        for (auto* channel : outputChannels) FloatVectorOperations::clear(channel, blockSize);
+    }
     
-    if (producesMidi())
+    // Publish GUI values for the editor
+    guiMirror.publish();
+}
+
+bool PlugDataAudioProcessor::isSilent(const pd::Sample* const* channels, int numChannels, int numSamples)
+{
+    for (int ch = 0; ch < numChannels; ch++)
     {
-        midiByteIndex = 0;
-        midiByteBuffer[0] = 0;
-        midiByteBuffer[1] = 0;
-        midiByteBuffer[2] = 0;
-        midiBufferOut.clear();
+        auto const range = FloatVectorOperations::findMinAndMax(channels[ch], numSamples);
+        if (range.getStart() <= -silenceThreshold || range.getEnd() >= silenceThreshold) return false;
     }
+    return true;
 }
 
 bool PlugDataAudioProcessor::hasEditor() const
@@ -644,6 +885,7 @@ AudioProcessorEditor* PlugDataAudioProcessor::createEditor()
     auto* editor = new PlugDataPluginEditor(*this);
     
     setThis();
+    setHeadless(false);
     
     if (patches.isEmpty())
     {
@@ -693,7 +935,7 @@ void PlugDataAudioProcessor::getStateInformation(MemoryBlock& destData)
         ostream.writeString(patch->getCurrentFile().getFullPathName());
     }
     
-    ostream.writeInt(getLatencySamples());
+    ostream.writeInt(patchLatency);
     ostream.writeFloat(static_cast<float>(tailLength.getValue()));
     ostream.writeInt(static_cast<int>(xmlBlock.getSize()));
     ostream.write(xmlBlock.getData(), xmlBlock.getSize());
@@ -767,7 +1009,9 @@ void PlugDataAudioProcessor::setStateInformation(const void* data, int sizeInByt
         if (xmlState)
             if (xmlState->hasTagName(parameters.state.getType())) parameters.replaceState(ValueTree::fromXml(*xmlState));
         
-        setLatencySamples(latency);
+        setPatchLatency(latency);
+        setOversampling(parameters.state.getProperty("Oversampling", 0));
+        setIdleSkipping(parameters.state.getProperty("IdleSkipping", false));
         
         suspendProcessing(false);
         
@@ -833,82 +1077,60 @@ Colour PlugDataAudioProcessor::getBackgroundColour() {
     return lnf->findColour(PlugDataColour::canvasColourId);
 }
 
+void PlugDataAudioProcessor::addMidiMessage(MidiMessage const& message)
+{
+    midiArena.addMessage(getSampleOffset(), message.getRawData(), message.getRawDataSize());
+}
+
 void PlugDataAudioProcessor::receiveNoteOn(const int channel, const int pitch, const int velocity)
 {
     if (velocity == 0)
     {
-        midiBufferOut.addEvent(MidiMessage::noteOff(channel, pitch, uint8(0)), audioAdvancement);
+        addMidiMessage(MidiMessage::noteOff(channel, pitch, uint8(0)));
     }
     else
     {
-        midiBufferOut.addEvent(MidiMessage::noteOn(channel, pitch, static_cast<uint8>(velocity)), audioAdvancement);
+        addMidiMessage(MidiMessage::noteOn(channel, pitch, static_cast<uint8>(velocity)));
     }
 }
 
-
-
-
 void PlugDataAudioProcessor::receiveControlChange(const int channel, const int controller, const int value)
 {
-    midiBufferOut.addEvent(MidiMessage::controllerEvent(channel, controller, value), audioAdvancement);
+    addMidiMessage(MidiMessage::controllerEvent(channel, controller, value));
 }
 
 void PlugDataAudioProcessor::receiveProgramChange(const int channel, const int value)
 {
-    midiBufferOut.addEvent(MidiMessage::programChange(channel, value), audioAdvancement);
+    addMidiMessage(MidiMessage::programChange(channel, value));
 }
 
 void PlugDataAudioProcessor::receivePitchBend(const int channel, const int value)
 {
-    midiBufferOut.addEvent(MidiMessage::pitchWheel(channel, value + 8192), audioAdvancement);
+    addMidiMessage(MidiMessage::pitchWheel(channel, value + 8192));
 }
 
 void PlugDataAudioProcessor::receiveAftertouch(const int channel, const int value)
 {
-    midiBufferOut.addEvent(MidiMessage::channelPressureChange(channel, value), audioAdvancement);
+    addMidiMessage(MidiMessage::channelPressureChange(channel, value));
 }
 
 void PlugDataAudioProcessor::receivePolyAftertouch(const int channel, const int pitch, const int value)
 {
-    midiBufferOut.addEvent(MidiMessage::aftertouchChange(channel, pitch, value), audioAdvancement);
+    addMidiMessage(MidiMessage::aftertouchChange(channel, pitch, value));
 }
 
 void PlugDataAudioProcessor::receiveMidiByte(const int port, const int byte)
 {
-    if (midiByteIsSysex)
-    {
-        if (byte == 0xf7)
-        {
-            midiBufferOut.addEvent(MidiMessage::createSysExMessage(midiByteBuffer, static_cast<int>(midiByteIndex)), audioAdvancement);
-            midiByteIndex = 0;
-            midiByteIsSysex = false;
-        }
-        else
-        {
-            midiByteBuffer[midiByteIndex++] = static_cast<uint8>(byte);
-            if (midiByteIndex == 512)
-            {
-                midiByteIndex = 511;
-            }
-        }
-    }
-    else if (midiByteIndex == 0 && byte == 0xf0)
-    {
-        midiByteIsSysex = true;
-    }
-    else
-    {
-        midiByteBuffer[midiByteIndex++] = static_cast<uint8>(byte);
-        if (midiByteIndex >= 3)
-        {
-            midiBufferOut.addEvent(MidiMessage(midiByteBuffer, 3), audioAdvancement);
-            midiByteIndex = 0;
-        }
-    }
+    midiArena.addByte(getSampleOffset(), static_cast<uint8>(byte));
 }
 
 void PlugDataAudioProcessor::timerCallback()
 {
+    if (auto const dropped = midiArena.getAndResetDropped())
+    {
+        logError("MIDI output overflow: " + String(dropped) + " events dropped");
+    }
+    
     if (auto* editor = dynamic_cast<PlugDataPluginEditor*>(getActiveEditor()))
     {
         if (!callbackType) return;
@@ -923,10 +1145,7 @@ void PlugDataAudioProcessor::timerCallback()
         }
         else
         {
-            for (auto* tmpl : editor->getCurrentCanvas()->templates)
-            {
-                static_cast<DrawableTemplate*>(tmpl)->update();
-            }
+            editor->getCurrentCanvas()->updateTemplates();
         }
         
         callbackType = 0;
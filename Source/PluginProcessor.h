@@ -10,6 +10,8 @@
 
 #include "Pd/PdInstance.h"
 #include "Pd/PdLibrary.h"
+#include "Pd/PdMidiArena.h"
+#include "RealtimeChecker.h"
 #include "Standalone/PlugDataWindow.h"
 #include "Statusbar.h"
 
@@ -24,6 +26,9 @@ class PlugDataAudioProcessor : public AudioProcessor, public pd::Instance, publi
 
     static AudioProcessor::BusesProperties buildBusesProperties();
 
+    // Most channels a layout may have in each direction, over all enabled buses
+    static inline constexpr int maxNumChannels = 128;
+
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
 
@@ -33,6 +38,8 @@ class PlugDataAudioProcessor : public AudioProcessor, public pd::Instance, publi
 
     void processBlockBypassed(AudioSampleBuffer& buffer, MidiBuffer& midiMessages) override;
     void processBlock(AudioBuffer<float>&, MidiBuffer&) override;
+    void processBlock(AudioBuffer<double>&, MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -91,7 +98,22 @@ class PlugDataAudioProcessor : public AudioProcessor, public pd::Instance, publi
         }
     };
 
-    void process(AudioSampleBuffer&, MidiBuffer&);
+    void process(AudioBuffer<pd::Sample>&, MidiBuffer&);
+    void processDirect(AudioBuffer<pd::Sample>&, MidiBuffer&, int numSamples);
+
+    // Latency added by the patch, the reported latency also includes pd's block when we need to buffer
+    void setPatchLatency(int latency);
+    int getPatchLatency() const;
+    void updateLatency();
+
+    // Runs pd at 2, 4 or 8 times the host's sample rate, the factor is a power of two from 0 (off) to 3
+    void setOversampling(int factor);
+    int getOversampling() const;
+
+    // Stops pd's dsp while the inputs are silent, nothing is sent to pd and the output has been silent for the tail length
+    // Clocks keep running, so this is only safe for patches that don't make sound on their own
+    void setIdleSkipping(bool shouldSkip);
+    bool getIdleSkipping() const;
 
     void setCallbackLock(const CriticalSection* lock)
     {
@@ -122,6 +144,7 @@ class PlugDataAudioProcessor : public AudioProcessor, public pd::Instance, publi
     void sendPlayhead();
 
     void messageEnqueued() override;
+    bool isDequeuedByAudioThread() override;
 
     pd::Patch* loadPatch(String patch);
     pd::Patch* loadPatch(File patch);
@@ -165,39 +188,72 @@ class PlugDataAudioProcessor : public AudioProcessor, public pd::Instance, publi
     Value tailLength = Value(0.0f);
 
     SharedResourcePointer<PlugDataLook> lnf;
+
+#if PLUGDATA_REALTIME_CHECK
+    std::unique_ptr<RealtimeChecker> realtimeChecker;
+#endif
     
 
     
    private:
+    template <typename SampleType>
+    void processBlockInternal(AudioBuffer<SampleType>& buffer, MidiBuffer& midiMessages);
+    void processOversampled(AudioBuffer<pd::Sample>& buffer, MidiBuffer& midiMessages);
     void processInternal();
+    static bool isSilent(const pd::Sample* const* channels, int numChannels, int numSamples);
 
     std::atomic<float>* enabled;
 
+    std::atomic<bool> idleSkipping = false;
+    bool parametersChanged = false;
+
+    // Consecutive samples of silent output at pd's rate, up to the tail length
+    int silentSamples = 0;
+
     int audioAdvancement = 0;
-    std::vector<float> audioBufferIn;
-    std::vector<float> audioBufferOut;
+    int patchLatency = 0;
+
+    // Set in prepareToPlay when our own audio device's block is a multiple of pd's block size, so we don't have to delay by a tick
+    bool directProcessing = false;
+    std::vector<pd::Sample> audioBufferIn;
+    std::vector<pd::Sample> audioBufferOut;
+
+    // Host buffer channel of every adc~ and dac~ channel, built from the enabled buses in prepareToPlay
+    std::vector<int> inputChannelMap;
+    std::vector<int> outputChannelMap;
+
+    // Channels of the next tick, in the host's buffer when processing directly and in the buffers above otherwise
+    std::vector<const pd::Sample*> inputChannels;
+    std::vector<pd::Sample*> outputChannels;
+
+    // Only used when the host's sample type doesn't match pd's
+    AudioBuffer<pd::Sample> conversionBuffer;
+
+    int oversampling = 0;
+    std::unique_ptr<dsp::Oversampling<pd::Sample>> oversampler;
+    AudioBuffer<pd::Sample> oversampledBuffer;
+    MidiBuffer midiBufferOversampled;
 
     MidiBuffer midiBufferIn;
-    MidiBuffer midiBufferOut;
     MidiBuffer midiBufferTemp;
     MidiBuffer midiBufferCopy;
 
-    bool midiByteIsSysex = false;
-    uint8 midiByteBuffer[512] = {0};
-    size_t midiByteIndex = 0;
+    // MIDI sent by pd, drained into the host's buffer once per block
+    pd::MidiArena midiArena;
+    void addMidiMessage(MidiMessage const& message);
 
     static inline constexpr int numParameters = 512;
     static inline constexpr int numInputBuses = 16;
     static inline constexpr int numOutputBuses = 16;
 
+    // -100 dB
+    static inline constexpr float silenceThreshold = 1e-5f;
+
     std::array<std::atomic<float>*, numParameters> parameterValues = {nullptr};
     std::array<float, numParameters> lastParameters = {0};
     
     std::vector<pd::Atom> atoms_playhead;
 
-    int minIn = 2;
-    int minOut = 2;
-
     const CriticalSection* audioLock;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PlugDataAudioProcessor)
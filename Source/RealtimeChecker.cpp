@@ -0,0 +1,245 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "RealtimeChecker.h"
+
+#if PLUGDATA_REALTIME_CHECK && JUCE_LINUX
+
+#include <atomic>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+
+namespace
+{
+constexpr int maxFrames = 32;
+constexpr int maxRecords = 1024;
+
+// Frames for the hook itself and the recording function
+constexpr int framesToSkip = 2;
+
+struct Record
+{
+    std::atomic<bool> ready = false;
+    int type;
+    int numFrames;
+    void* frames[maxFrames];
+};
+
+Record records[maxRecords];
+std::atomic<uint32_t> writeIndex = 0;
+std::atomic<uint32_t> numDropped = 0;
+std::atomic<bool> enabled = false;
+
+const char* const typeNames[RealtimeChecker::NumViolationTypes] = {"malloc", "calloc", "realloc", "free", "pthread_mutex_lock"};
+
+// Initial-exec so accessing these never allocates
+__attribute__((tls_model("initial-exec"))) thread_local bool insideRealtimeSection = false;
+__attribute__((tls_model("initial-exec"))) thread_local bool insideHook = false;
+
+using MutexLockFunction = int (*)(pthread_mutex_t*);
+std::atomic<MutexLockFunction> realMutexLock = nullptr;
+
+// Called from the interposed functions, must not allocate or lock
+void recordViolation(RealtimeChecker::ViolationType type)
+{
+    if (!insideRealtimeSection || insideHook || !enabled.load(std::memory_order_relaxed)) return;
+
+    insideHook = true;
+
+    auto& record = records[writeIndex.fetch_add(1, std::memory_order_relaxed) % maxRecords];
+
+    // The message thread hasn't read this one yet
+    if (record.ready.load(std::memory_order_acquire))
+    {
+        numDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        record.type = type;
+        record.numFrames = backtrace(record.frames, maxFrames);
+        record.ready.store(true, std::memory_order_release);
+    }
+
+    insideHook = false;
+}
+}  // namespace
+
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void __libc_free(void*);
+
+    void* malloc(size_t size) noexcept
+    {
+        recordViolation(RealtimeChecker::Malloc);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t num, size_t size) noexcept
+    {
+        recordViolation(RealtimeChecker::Calloc);
+        return __libc_calloc(num, size);
+    }
+
+    void* realloc(void* ptr, size_t size) noexcept
+    {
+        recordViolation(RealtimeChecker::Realloc);
+        return __libc_realloc(ptr, size);
+    }
+
+    void free(void* ptr) noexcept
+    {
+        if (ptr) recordViolation(RealtimeChecker::Free);
+        __libc_free(ptr);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+    {
+        auto lock = realMutexLock.load(std::memory_order_relaxed);
+        if (!lock)
+        {
+            lock = reinterpret_cast<MutexLockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+            realMutexLock.store(lock, std::memory_order_relaxed);
+        }
+
+        recordViolation(RealtimeChecker::MutexLock);
+        return lock(mutex);
+    }
+}
+
+RealtimeChecker::ScopedRealtimeSection::ScopedRealtimeSection() : wasInside(insideRealtimeSection)
+{
+    insideRealtimeSection = true;
+}
+
+RealtimeChecker::ScopedRealtimeSection::~ScopedRealtimeSection()
+{
+    insideRealtimeSection = wasInside;
+}
+
+RealtimeChecker::RealtimeChecker(std::function<void(const String&)> logFunction, File summary) : log(std::move(logFunction)), summaryFile(std::move(summary))
+{
+    // The first call to backtrace loads libgcc, which allocates
+    void* frames[maxFrames];
+    backtrace(frames, maxFrames);
+
+    enabled = true;
+
+    log("Realtime checker enabled, writing violations to " + summaryFile.getFullPathName());
+
+    startTimer(1000);
+}
+
+RealtimeChecker::~RealtimeChecker()
+{
+    enabled = false;
+    timerCallback();
+}
+
+bool RealtimeChecker::isSupported()
+{
+    return true;
+}
+
+void RealtimeChecker::timerCallback()
+{
+    for (auto& record : records)
+    {
+        if (!record.ready.load(std::memory_order_acquire)) continue;
+
+        auto const numFrames = std::max(0, record.numFrames - framesToSkip);
+        auto* const frames = record.frames + framesToSkip;
+
+        // Same type and same call stack counts as the same violation
+        uint64 hash = static_cast<uint64>(record.type);
+        for (int i = 0; i < numFrames; i++)
+        {
+            hash = hash * 1099511628211ull ^ reinterpret_cast<uint64>(frames[i]);
+        }
+
+        auto& violation = violations[hash];
+
+        if (violation.count == 0)
+        {
+            violation.type = static_cast<ViolationType>(record.type);
+
+            if (auto** symbols = backtrace_symbols(frames, numFrames))
+            {
+                for (int i = 0; i < numFrames; i++)
+                {
+                    violation.stackTrace << "    " << symbols[i] << "\n";
+                }
+                ::free(symbols);
+            }
+
+            log(String("Realtime violation: ") + typeNames[violation.type] + " on the audio thread\n" + violation.stackTrace);
+        }
+
+        violation.count++;
+        summaryChanged = true;
+
+        record.ready.store(false, std::memory_order_release);
+    }
+
+    if (auto const dropped = numDropped.exchange(0))
+    {
+        log("Realtime checker: " + String(dropped) + " violations dropped");
+    }
+
+    if (summaryChanged) writeSummary();
+}
+
+void RealtimeChecker::writeSummary()
+{
+    String summary;
+    summary << "PlugData realtime violations: " << String(violations.size()) << " unique call stacks\n\n";
+
+    for (auto& [hash, violation] : violations)
+    {
+        summary << typeNames[violation.type] << " (" << String(violation.count) << "x)\n";
+        summary << violation.stackTrace << "\n";
+    }
+
+    summaryFile.replaceWithText(summary);
+    summaryChanged = false;
+}
+
+#else
+
+RealtimeChecker::ScopedRealtimeSection::ScopedRealtimeSection() : wasInside(false)
+{
+}
+
+RealtimeChecker::ScopedRealtimeSection::~ScopedRealtimeSection()
+{
+}
+
+RealtimeChecker::RealtimeChecker(std::function<void(const String&)> logFunction, File summary) : log(std::move(logFunction)), summaryFile(std::move(summary))
+{
+    log("Realtime checker is only supported on Linux");
+}
+
+RealtimeChecker::~RealtimeChecker()
+{
+}
+
+bool RealtimeChecker::isSupported()
+{
+    return false;
+}
+
+void RealtimeChecker::timerCallback()
+{
+}
+
+void RealtimeChecker::writeSummary()
+{
+}
+
+#endif
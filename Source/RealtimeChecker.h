@@ -0,0 +1,66 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <functional>
+#include <map>
+
+// Debug tool that finds allocations and locks on the audio thread
+// Only active when built with PLUGDATA_REALTIME_CHECK, on Linux, and only in the standalone and the bench:
+// its hooks replace the libc functions, which only takes effect in the executable itself, not in a plugin
+// While a thread is inside a ScopedRealtimeSection, calls to malloc, calloc, realloc, free and pthread_mutex_lock
+// are recorded with a stack trace. The audio thread only writes to a preallocated buffer, the message thread
+// symbolises the traces, reports every new violation to the console and keeps a summary file up to date.
+struct RealtimeChecker : public Timer
+{
+    enum ViolationType
+    {
+        Malloc = 0,
+        Calloc,
+        Realloc,
+        Free,
+        MutexLock,
+        NumViolationTypes
+    };
+
+    struct ScopedRealtimeSection
+    {
+        ScopedRealtimeSection();
+        ~ScopedRealtimeSection();
+
+        bool wasInside;
+    };
+
+    RealtimeChecker(std::function<void(const String&)> logFunction, File summary);
+    ~RealtimeChecker() override;
+
+    // Returns true if this build can intercept allocations and locks
+    static bool isSupported();
+
+    void timerCallback() override;
+
+   private:
+    struct Violation
+    {
+        ViolationType type;
+        String stackTrace;
+        int count = 0;
+    };
+
+    void writeSummary();
+
+    std::function<void(const String&)> log;
+    File summaryFile;
+
+    // Unique violations by stack hash
+    std::map<uint64, Violation> violations;
+    bool summaryChanged = false;
+
+    JUCE_DECLARE_NON_COPYABLE(RealtimeChecker)
+};
@@ -0,0 +1,347 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include <iostream>
+
+#include "../PluginProcessor.h"
+
+// Renders a patch to an audio file as fast as possible, without opening an audio device
+// The patch gets as many adc~ channels as the input file has, and --channels dac~ channels (2 by default)
+// Usage: PlugData --render <patch.pd> --output <file.wav|file.flac> [--input <file>] [--midi <file.mid>]
+//                 [--duration <seconds>] [--samplerate <hz>] [--blocksize <samples>] [--bitdepth <16|24|32>]
+//                 [--channels <outputs>]
+class OfflineRenderer
+{
+   public:
+    struct Options
+    {
+        File patch;
+        File output;
+        File input;
+        File midi;
+
+        double duration = 0.0;
+        double sampleRate = 44100.0;
+        int blockSize = 512;
+        int bitDepth = 24;
+        int numChannels = 2;
+    };
+
+    // Audio files can't be read into more channels than this at once
+    static inline constexpr int maxInputChannels = 64;
+
+    static bool isRenderCommand(const StringArray& args)
+    {
+        return args.contains("--render");
+    }
+
+    // Returns the exit code for the application
+    static int run(const StringArray& args)
+    {
+        Options options;
+        String error;
+
+        if (!parseArguments(args, options, error))
+        {
+            std::cerr << "error: " << error << std::endl;
+            printUsage();
+            return 1;
+        }
+
+        OfflineRenderer renderer(options);
+        return renderer.render() ? 0 : 1;
+    }
+
+    explicit OfflineRenderer(Options opts) : options(std::move(opts))
+    {
+        formatManager.registerBasicFormats();
+    }
+
+    bool render()
+    {
+        std::unique_ptr<AudioFormatReader> inputReader;
+        if (options.input != File())
+        {
+            inputReader.reset(formatManager.createReaderFor(options.input));
+            if (!inputReader)
+            {
+                return fail("couldn't read input file " + options.input.getFullPathName());
+            }
+        }
+
+        MidiMessageSequence midiSequence;
+        if (options.midi != File() && !readMidiFile(midiSequence))
+        {
+            return fail("couldn't read midi file " + options.midi.getFullPathName());
+        }
+
+        // Render the length of the input file if no duration was given
+        auto duration = options.duration;
+        if (duration <= 0.0 && inputReader)
+        {
+            duration = static_cast<double>(inputReader->lengthInSamples) / inputReader->sampleRate;
+        }
+        if (duration <= 0.0)
+        {
+            return fail("no duration given");
+        }
+
+        std::unique_ptr<PlugDataAudioProcessor> processor(dynamic_cast<PlugDataAudioProcessor*>(createPluginFilterOfType(AudioProcessor::wrapperType_Standalone)));
+
+        // All channels go through the main buses, so a multichannel file isn't cut down to the default stereo layout
+        int const numInputChannels = inputReader ? static_cast<int>(inputReader->numChannels) : 2;
+        if (numInputChannels > maxInputChannels)
+        {
+            return fail("input files with more than " + String(maxInputChannels) + " channels aren't supported");
+        }
+
+        auto layout = processor->getBusesLayout();
+        for (auto& bus : layout.inputBuses) bus = AudioChannelSet::disabled();
+        for (auto& bus : layout.outputBuses) bus = AudioChannelSet::disabled();
+        layout.inputBuses.getReference(0) = getChannelSet(numInputChannels);
+        layout.outputBuses.getReference(0) = getChannelSet(options.numChannels);
+
+        if (!processor->setBusesLayout(layout))
+        {
+            return fail("couldn't render " + String(numInputChannels) + " input and " + String(options.numChannels) + " output channels");
+        }
+
+        int const numIns = processor->getTotalNumInputChannels();
+        int const numOuts = processor->getTotalNumOutputChannels();
+        int const blockSize = options.blockSize;
+
+        // This makes sure the message queue is handled directly instead of waiting for an audio device
+        processor->setNonRealtime(true);
+        processor->setRateAndBufferSizeDetails(options.sampleRate, blockSize);
+        processor->prepareToPlay(options.sampleRate, blockSize);
+
+        auto* patch = processor->loadPatch(options.patch);
+        if (!patch->getPointer())
+        {
+            return fail("couldn't open patch " + options.patch.getFullPathName());
+        }
+
+        // An input at another sample rate is resampled to ours, instead of being played at the wrong speed
+        std::unique_ptr<AudioFormatReaderSource> inputSource;
+        std::unique_ptr<ResamplingAudioSource> resampler;
+        if (inputReader && numIns > 0 && inputReader->sampleRate != options.sampleRate)
+        {
+            inputSource = std::make_unique<AudioFormatReaderSource>(inputReader.get(), false);
+            resampler = std::make_unique<ResamplingAudioSource>(inputSource.get(), false, numIns);
+            resampler->setResamplingRatio(inputReader->sampleRate / options.sampleRate);
+            resampler->prepareToPlay(blockSize, options.sampleRate);
+        }
+
+        auto writer = createWriter(numOuts);
+        if (!writer)
+        {
+            return fail("couldn't write output file " + options.output.getFullPathName());
+        }
+
+        AudioBuffer<float> buffer(std::max(numIns, numOuts), blockSize);
+        MidiBuffer midiBuffer;
+        midiBuffer.ensureSize(2048);
+
+        // Files are read into a buffer of their own width, pd's buffer may have more channels than a reader can fill
+        AudioBuffer<float> inputBuffer(numIns, blockSize);
+
+        auto const totalSamples = static_cast<int64>(duration * options.sampleRate);
+        int midiIndex = 0;
+
+        auto const startTime = Time::getMillisecondCounterHiRes();
+
+        for (int64 position = 0; position < totalSamples; position += blockSize)
+        {
+            auto const numSamples = static_cast<int>(std::min<int64>(blockSize, totalSamples - position));
+
+            // The last block is padded with silence, pd always gets the block size it was prepared for
+            buffer.clear();
+
+            if (inputReader && numIns > 0)
+            {
+                inputBuffer.setSize(numIns, numSamples, false, false, true);
+
+                if (resampler)
+                {
+                    AudioSourceChannelInfo info(&inputBuffer, 0, numSamples);
+                    resampler->getNextAudioBlock(info);
+                }
+                else
+                {
+                    inputReader->read(&inputBuffer, 0, numSamples, position, true, numIns > 1);
+                }
+
+                for (int ch = 0; ch < numIns; ch++)
+                {
+                    buffer.copyFrom(ch, 0, inputBuffer, ch, 0, numSamples);
+                }
+            }
+
+            midiBuffer.clear();
+            while (midiIndex < midiSequence.getNumEvents())
+            {
+                auto const& message = midiSequence.getEventPointer(midiIndex)->message;
+                auto const samplePosition = static_cast<int64>(message.getTimeStamp() * options.sampleRate);
+
+                if (samplePosition >= position + numSamples) break;
+
+                // Tempo, track names and end of track markers aren't meant for pd
+                if (message.isMetaEvent())
+                {
+                    midiIndex++;
+                    continue;
+                }
+
+                midiBuffer.addEvent(message, static_cast<int>(std::max<int64>(0, samplePosition - position)));
+                midiIndex++;
+            }
+
+            {
+                const ScopedLock lock(*processor->getCallbackLock());
+                processor->processBlock(buffer, midiBuffer);
+            }
+
+            writer->writeFromAudioSampleBuffer(buffer, 0, numSamples);
+        }
+
+        writer.reset();
+
+        if (resampler) resampler->releaseResources();
+
+        processor->releaseResources();
+
+        auto const elapsed = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+        std::cout << "Rendered " << duration << "s of audio to " << options.output.getFullPathName() << " in " << elapsed << "s (" << (elapsed > 0.0 ? duration / elapsed : 0.0) << "x realtime)" << std::endl;
+
+        for (auto& [message, type] : processor->consoleMessages)
+        {
+            (type ? std::cerr : std::cout) << message << std::endl;
+        }
+
+        return true;
+    }
+
+   private:
+    static bool parseArguments(const StringArray& args, Options& options, String& error)
+    {
+        auto getValue = [&args](const String& flag) -> String
+        {
+            int const idx = args.indexOf(flag);
+            return idx >= 0 ? args[idx + 1].unquoted() : String();
+        };
+
+        auto getFile = [&getValue](const String& flag)
+        {
+            auto path = getValue(flag);
+            return path.isEmpty() ? File() : File::getCurrentWorkingDirectory().getChildFile(path);
+        };
+
+        options.patch = getFile("--render");
+        options.output = getFile("--output");
+        options.input = getFile("--input");
+        options.midi = getFile("--midi");
+
+        if (args.contains("--duration")) options.duration = getValue("--duration").getDoubleValue();
+        if (args.contains("--samplerate")) options.sampleRate = getValue("--samplerate").getDoubleValue();
+        if (args.contains("--blocksize")) options.blockSize = getValue("--blocksize").getIntValue();
+        if (args.contains("--bitdepth")) options.bitDepth = getValue("--bitdepth").getIntValue();
+        if (args.contains("--channels")) options.numChannels = getValue("--channels").getIntValue();
+
+        if (!options.patch.existsAsFile())
+        {
+            error = "patch not found";
+            return false;
+        }
+        if (options.output == File())
+        {
+            error = "no output file given";
+            return false;
+        }
+        if (options.input != File() && !options.input.existsAsFile())
+        {
+            error = "input file not found";
+            return false;
+        }
+        if (options.midi != File() && !options.midi.existsAsFile())
+        {
+            error = "midi file not found";
+            return false;
+        }
+        if (options.sampleRate <= 0.0 || options.blockSize <= 0)
+        {
+            error = "invalid sample rate or block size";
+            return false;
+        }
+        if (options.numChannels < 1 || options.numChannels > PlugDataAudioProcessor::maxNumChannels)
+        {
+            error = "the number of channels has to be between 1 and " + String(PlugDataAudioProcessor::maxNumChannels);
+            return false;
+        }
+
+        return true;
+    }
+
+    static void printUsage()
+    {
+        std::cerr << "usage: PlugData --render <patch.pd> --output <file.wav|file.flac> [--input <file>] [--midi <file.mid>] [--duration <seconds>] [--samplerate <hz>] [--blocksize <samples>] [--bitdepth <16|24|32>] [--channels <outputs>]" << std::endl;
+    }
+
+    static AudioChannelSet getChannelSet(int numChannels)
+    {
+        return numChannels <= 2 ? AudioChannelSet::canonicalChannelSet(numChannels) : AudioChannelSet::discreteChannels(numChannels);
+    }
+
+    bool readMidiFile(MidiMessageSequence& sequence)
+    {
+        FileInputStream stream(options.midi);
+        MidiFile midiFile;
+
+        if (!stream.openedOk() || !midiFile.readFrom(stream)) return false;
+
+        // Merge all tracks, with timestamps in seconds
+        midiFile.convertTimestampTicksToSeconds();
+        for (int i = 0; i < midiFile.getNumTracks(); i++)
+        {
+            sequence.addSequence(*midiFile.getTrack(i), 0.0);
+        }
+        sequence.sort();
+        sequence.updateMatchedPairs();
+
+        return true;
+    }
+
+    std::unique_ptr<AudioFormatWriter> createWriter(int numChannels)
+    {
+        auto* format = formatManager.findFormatForFileExtension(options.output.getFileExtension());
+        if (!format) return nullptr;
+
+        options.output.deleteFile();
+        auto stream = std::unique_ptr<OutputStream>(options.output.createOutputStream());
+        if (!stream) return nullptr;
+
+        // FLAC can't store 32 bits
+        auto bitDepth = options.bitDepth;
+        if (!format->getPossibleBitDepths().contains(bitDepth)) bitDepth = format->getPossibleBitDepths().getLast();
+
+        auto* writer = format->createWriterFor(stream.get(), options.sampleRate, static_cast<unsigned int>(numChannels), bitDepth, {}, 0);
+        if (writer) stream.release();
+
+        return std::unique_ptr<AudioFormatWriter>(writer);
+    }
+
+    bool fail(const String& message)
+    {
+        std::cerr << "error: " << message << std::endl;
+        return false;
+    }
+
+    Options options;
+    AudioFormatManager formatManager;
+};
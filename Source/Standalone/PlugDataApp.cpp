@@ -23,6 +23,7 @@
 #include "PlugDataWindow.h"
 #include "../Canvas.h"
 #include "../PluginProcessor.h"
+#include "OfflineRenderer.h"
 
 class PlugDataApp : public JUCEApplication
 {
@@ -85,6 +86,15 @@ class PlugDataApp : public JUCEApplication
 
     void initialise(const String&) override
     {
+        // Render a patch to a file without opening a window or an audio device
+        auto args = getCommandLineParameterArray();
+        if (OfflineRenderer::isRenderCommand(args))
+        {
+            setApplicationReturnValue(OfflineRenderer::run(args));
+            quit();
+            return;
+        }
+
         LookAndFeel::getDefaultLookAndFeel().setColour(ResizableWindow::backgroundColourId, Colours::transparentBlack);
         
         mainWindow.reset(createWindow());
@@ -434,7 +434,8 @@ static bool hasRealEvents(MidiBuffer& buffer)
     return false;
 }
 
-void StatusbarSource::processBlock(const AudioBuffer<float>& buffer, MidiBuffer& midiIn, MidiBuffer& midiOut, int channels)
+template <typename SampleType>
+void StatusbarSource::processBlock(const AudioBuffer<SampleType>& buffer, MidiBuffer& midiIn, MidiBuffer& midiOut, int channels)
 {
     
     auto** channelData = buffer.getArrayOfReadPointers();
@@ -454,7 +455,7 @@ void StatusbarSource::processBlock(const AudioBuffer<float>& buffer, MidiBuffer&
 
         for (int n = 0; n < buffer.getNumSamples(); n++)
         {
-            float s = std::abs(channelData[ch][n]);
+            auto s = static_cast<float>(std::abs(channelData[ch][n]));
 
             const float decayFactor = 0.99992f;
 
@@ -495,6 +496,9 @@ void StatusbarSource::processBlock(const AudioBuffer<float>& buffer, MidiBuffer&
     }
 }
 
+template void StatusbarSource::processBlock(const AudioBuffer<float>&, MidiBuffer&, MidiBuffer&, int);
+template void StatusbarSource::processBlock(const AudioBuffer<double>&, MidiBuffer&, MidiBuffer&, int);
+
 void StatusbarSource::prepareToPlay(int nChannels)
 {
     numChannels = nChannels;
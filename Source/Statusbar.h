@@ -64,7 +64,8 @@ struct StatusbarSource
 {
     StatusbarSource();
 
-    void processBlock(const AudioBuffer<float>& buffer, MidiBuffer& midiIn, MidiBuffer& midiOut, int outChannels);
+    template <typename SampleType>
+    void processBlock(const AudioBuffer<SampleType>& buffer, MidiBuffer& midiIn, MidiBuffer& midiOut, int outChannels);
 
     void prepareToPlay(int numChannels);
 